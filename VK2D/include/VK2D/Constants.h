@@ -50,8 +50,35 @@ extern const vec4 VK2D_DEFAULT_COLOUR_MOD;
 /// At 36, you're looking at something more than good enough for most pixel art games. At 360 you're looking at something silky-smooth for most things.
 extern const float VK2D_CIRCLE_VERTICES;
 
-/// Maximum number of frames to be processed at once - You generally want this and VK2D_DEVICE_COMMAND_POOLS to be the same
-#define VK2D_MAX_FRAMES_IN_FLIGHT 2
+/// Upper limit for the startup option framesInFlight, the number of frames that may be processed at once
+#define VK2D_MAX_FRAMES_IN_FLIGHT 3
+
+/// Number of frames in flight used when the startup option framesInFlight is 0
+#define VK2D_DEFAULT_FRAMES_IN_FLIGHT 2
+
+/// Milliseconds at the end of each frame limiter wait that are spent busy-waiting instead of sleeping
+#define VK2D_FRAME_LIMITER_SPIN_MS 2
+
+/// Longest time in nanoseconds low-latency pacing waits for the previous frame to be displayed
+#define VK2D_PRESENT_WAIT_TIMEOUT 100000000
+
+/// Maximum number of GPU profiler scopes that can be recorded in a single frame, further scopes are ignored
+#define VK2D_MAX_GPU_SCOPES 64
+
+/// Maximum number of user GPU profiler scopes that may be nested inside each other
+#define VK2D_MAX_GPU_SCOPE_DEPTH 8
+
+/// Maximum number of CPU trace zones kept in memory when built with VK2D_ENABLE_TRACING, further zones are dropped
+#define VK2D_MAX_TRACE_EVENTS 1048576
+
+/// Width and height in pixels of each cell in a shadow environment's spatial grid
+#define VK2D_SHADOW_GRID_CELL_SIZE 256
+
+/// Number of buckets grid cells are hashed into, each shadow environment keeps this many lists
+#define VK2D_SHADOW_GRID_BUCKETS 1024
+
+/// Shadow objects covering more grid cells than this are kept in one list every query checks instead
+#define VK2D_SHADOW_GRID_MAX_CELLS 64
 
 /// First 33 digits of pi
 #define VK2D_PI 3.14159265358979323846264338327950
@@ -13,6 +13,9 @@ extern "C" {
 
 /// \brief Returns the internal nuklear context for nuklear calls
 /// \return Returns the internal nuklear context for nuklear calls
+///
+/// Nuklear image handles are texture IDs, so a texture is drawn in the GUI with
+/// `nk_image_id(vk2dTextureGetID(tex))`.
 struct nk_context *vk2dGuiContext();
 
 /// \brief Call this at the beginning of your SDL event loop
@@ -11,9 +11,15 @@ extern "C" {
 #endif
 
 /// \brief Initializes the global values for logging
+/// \note This starts the default logger's background writer thread. Messages
+///       logged to the default logger are queued and written by that thread,
+///       if the queue is full new messages are dropped (and the number dropped
+///       is reported) rather than blocking the logging thread. Fatal messages
+///       are always written immediately.
 void vk2dLoggerInit();
 
 /// \brief Frees allocated logging resources
+/// \note Any messages still queued for the default logger are written first.
 void vk2dLoggerDestroy();
 
 /// \brief Supply user context and callbacks for logger
@@ -75,10 +75,33 @@ VkCommandBuffer vk2dLogicalDeviceGetSingleUseBuffer(VK2DLogicalDevice dev, bool
 /// \param buffer Command buffer to submit
 /// \param mainThread Whether or not the command buffer should be in the main thread or not
 ///
-/// To be more specific, this will submit the command buffer then wait for the queue
-/// to idle. After that it will free the buffer.
+/// To be more specific, this will submit the command buffer then wait for the timeline
+/// value its submission signals rather than for the queue to idle. After that it will
+/// free the buffer.
 void vk2dLogicalDeviceSubmitSingleBuffer(VK2DLogicalDevice dev, VkCommandBuffer buffer, bool mainThread);
 
+/// \brief Reserves the next value on one of the device's timelines
+/// \param dev Device the timeline belongs to
+/// \param mainThread True for the timeline of the main queue, false for the loading queue's
+/// \return Returns the value the caller's next submit to that queue must signal
+///
+/// Values on a timeline must be signaled in the order they were handed out, so
+/// the value should be signaled by the very next submit to that queue.
+uint64_t vk2dLogicalDeviceNextTimelineValue(VK2DLogicalDevice dev, bool mainThread);
+
+/// \brief Blocks until one of the device's timelines reaches a value
+/// \param dev Device the timeline belongs to
+/// \param value Value to wait for, 0 returns immediately
+/// \param mainThread True for the timeline of the main queue, false for the loading queue's
+void vk2dLogicalDeviceWaitTimeline(VK2DLogicalDevice dev, uint64_t value, bool mainThread);
+
+/// \brief Checks if one of the device's timelines has reached a value without blocking
+/// \param dev Device the timeline belongs to
+/// \param value Value to check for
+/// \param mainThread True for the timeline of the main queue, false for the loading queue's
+/// \return Returns true if the GPU has finished all work up to and including value
+bool vk2dLogicalDeviceTimelineReached(VK2DLogicalDevice dev, uint64_t value, bool mainThread);
+
 /// \brief Grabs a fence from a logical device
 /// \param dev Logical device to get the fence from
 /// \param flags Flags to use when creating the fence (Refer to Vulkan spec)
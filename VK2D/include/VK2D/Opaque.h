@@ -21,7 +21,7 @@ struct VK2DPhysicalDevice_t {
 	VkPhysicalDevice dev; ///< Internal vulkan pointer
 	struct {
 		uint32_t graphicsFamily; ///< Queue family for graphics pipeline
-		uint32_t computeFamily;  ///< Queue family for compute pipeline
+		uint32_t computeFamily;  ///< Dedicated compute-only queue family if the device has one, otherwise the same as graphicsFamily
 	} QueueFamily;               ///< Nicely groups up queue families
 	VkPhysicalDeviceMemoryProperties mem; ///< Memory properties of this device
 	VkPhysicalDeviceFeatures feats;       ///< Features of this device
@@ -33,9 +33,20 @@ struct VK2DLogicalDevice_t {
 	VkDevice dev;               ///< Logical device
 	VkQueue queue;              ///< Queue for command buffers
 	VkQueue loadQueue;          ///< Queue for off-thread loading
+	VkQueue computeQueue;       ///< Dedicated compute queue, VK_NULL_HANDLE unless async compute is enabled
+	uint32_t queueFamilies[2];  ///< Queue families resources are shared between
+	uint32_t queueFamilyCount;  ///< Number of families in queueFamilies, 2 only if computeQueue exists
 	VK2DPhysicalDevice pd;      ///< Physical device this came from
 	VkCommandPool pool;         ///< Command pools to cycle through
 	VkCommandPool loadPool;     ///< Command pool for off-thread loading
+	VkCommandPool computePool;  ///< Command pool for computeQueue
+	PFN_vkWaitForPresentKHR waitForPresent; ///< vkWaitForPresentKHR, NULL unless low-latency pacing is supported
+	PFN_vkCmdBeginRenderingKHR beginRendering; ///< vkCmdBeginRenderingKHR, NULL unless dynamic rendering is in use
+	PFN_vkCmdEndRenderingKHR endRendering;     ///< vkCmdEndRenderingKHR, NULL unless dynamic rendering is in use
+	VkSemaphore timeline;       ///< Timeline semaphore signaled by submits to queue
+	uint64_t timelineValue;     ///< Last value handed out on timeline, main thread only
+	VkSemaphore loadTimeline;   ///< Timeline semaphore signaled by submits to loadQueue
+	uint64_t loadTimelineValue; ///< Last value handed out on loadTimeline, worker thread only
 	SDL_AtomicInt loadListSize; ///< Size of the asset load list
 	VK2DAssetLoad *loadList;    ///< Assets that need to be loaded
 	SDL_Mutex *loadListMutex;   ///< Mutex for asset load list synchronization
@@ -62,6 +73,7 @@ struct VK2DBuffer_t {
 	VK2DLogicalDevice dev; ///< Device the buffer belongs to
 	VkDeviceSize size;     ///< Size of this buffer in bytes
 	VkDeviceSize offset;   ///< Offset for this buffer in bytes
+	VkBufferUsageFlags usage; ///< Usage the buffer was created with, needed to recreate it when defragmenting
 };
 
 /// \brief To make descriptor buffers simpler internally
@@ -157,6 +169,8 @@ struct VK2DImage_t {
 	uint32_t width;        ///< Width in pixels of the image
 	uint32_t height;       ///< Height in pixels of the image
 	VkDescriptorSet set;   ///< Descriptor set for this image
+	VkFormat format;       ///< Format the image was created with
+	VkImageUsageFlags usage; ///< Usage the image was created with, needed to recreate it when defragmenting
 };
 
 /// \brief Takes the headache out of Vulkan textures
@@ -168,11 +182,15 @@ struct VK2DTexture_t {
 	VK2DImage img;                 ///< Internal image
 	VK2DImage depthBuffer;         ///< For 3D rendering when its a target
 	VK2DImage sampledImg;          ///< Image for MSAA
-	VkFramebuffer fbo;             ///< Framebuffer of this texture so it can be drawn to
+	VkFramebuffer fbo;             ///< Framebuffer of this texture so it can be drawn to, null under dynamic rendering
+	bool isTarget;                 ///< Whether or not this texture was created with vk2dTextureCreate
 	VK2DBuffer ubo;                ///< UBO that will be used when drawing to this texture
 	VkDescriptorSet uboSet;        ///< Set for the UBO
 	bool imgHandled;               ///< Whether or not to free the image with the texture (if it was loaded with vk2dTextureLoad)
 	SDL_AtomicInt descriptorIndex; ///< Index in the descriptor array of this texture
+	char *sourceFile;              ///< File this texture was loaded from so it can be reloaded after eviction, or NULL
+	void *sourceData;              ///< Copy of the encoded image this texture was loaded from if there is no file, or NULL
+	int sourceSize;                ///< Size of sourceData in bytes
 };
 
 /// \brief A 3D model
@@ -186,20 +204,136 @@ struct VK2DModel_t {
 	VK2DTexture tex;           ///< Texture for this model
 };
 
+/// \brief One of the buffers a shadow environment cycles through so updating it never has to wait on the GPU
+typedef struct VK2DShadowVBO_t {
+    VK2DBuffer buffer;      ///< Host-visible buffer, NULL until this slot is first needed
+    uint64_t lastUsedFrame; ///< Last frame this buffer was drawn with, 0 if it never was
+} VK2DShadowVBO;
+
+/// \brief A shadow object as shadows.vert reads it from the object storage buffer, laid out for std430
+typedef struct VK2DShadowObjectGPU_t {
+    mat4 model;              ///< Model for this shadow object
+    uint32_t enabled;        ///< Whether or not this object's edges cast shadows
+    uint32_t _alignment[3];  ///< Pads the struct to the mat4's alignment
+} VK2DShadowObjectGPU;
+
+/// \brief One bucket in a shadow environment's spatial grid
+typedef struct VK2DShadowGridCell_t {
+    VK2DShadowObject *objects; ///< Objects overlapping a cell that hashes to this bucket
+    int count;                 ///< Number of objects in the list
+    int size;                  ///< Size of the list in elements
+} VK2DShadowGridCell;
+
 /// \brief Information for hardware accelerated shadows
 struct VK2DShadowEnvironment_t {
-    int vboVertexSize;                 ///< Number of vertices in the VBO
-    VK2DBuffer vbo;                    ///< Vertices corresponding to the shadows that will be cast
-    vec3 *vertices;                    ///< Raw vertices before they get shipped off to the gpu
+    int flushedEdgeCount;              ///< Number of edges in flushedEdges
+    VK2DBuffer vbo;                    ///< Object-space x1, y1, x2, y2 of every flushed edge followed by the object each belongs to, owned by vboRing
+    int bakedEdgeCount;                ///< Number of edges in vbo
+    VK2DBuffer objectBuffer;           ///< A VK2DShadowObjectGPU for every object, owned by objectRing
+    vec4 *lightEdges;                  ///< Edges in range of the light being drawn, copied into the descriptor buffer per light
+    uint32_t *lightObjects;            ///< Object each edge in lightEdges belongs to
+    int lightEdgesSize;                ///< Size of lightEdges and lightObjects in elements
+    VK2DShadowVBO *vboRing;            ///< VBOs flushes rotate through, grows when every one is still in flight
+    int vboRingCount;                  ///< Number of elements in vboRing
+    int vboCurrent;                    ///< Index in vboRing of vbo
+    VK2DShadowVBO *objectRing;         ///< Object buffers object updates rotate through, grows when every one is still in flight
+    int objectRingCount;               ///< Number of elements in objectRing
+    int objectCurrent;                 ///< Index in objectRing of objectBuffer
+    bool flushed;                      ///< Whether or not vk2dShadowEnvironmentFlushVBO has been called yet
+    bool edgesDirty;                   ///< Whether the edges were flushed or reset since vbo was last uploaded
+    bool objectsDirty;                 ///< Whether an object changed since objectBuffer was last uploaded
+    vec4 *flushedEdges;                ///< Object-space edges as of the last flush
+    int flushedEdgesSize;              ///< Size of flushedEdges in elements
+    vec4 *edges;                       ///< Raw x1, y1, x2, y2 edges before they get flushed
     int objectCount;                   ///< Number of shadow objects (1 by default)
     VK2DShadowObjectInfo *objectInfos; ///< Info for each shadow object
-    int verticesSize;                  ///< Size of the vertex list in elements
-    int verticesCount;                 ///< Number of vertices in the vertices list
+    int edgesSize;                     ///< Size of the edge list in elements
+    int edgesCount;                    ///< Number of edges in the edge list
+    VK2DShadowGridCell *grid;          ///< VK2D_SHADOW_GRID_BUCKETS buckets of objects, kept up to date as objects move
+    VK2DShadowGridCell gridLarge;      ///< Objects covering more than VK2D_SHADOW_GRID_MAX_CELLS cells
+    VK2DShadowObject *queryResults;    ///< Objects found by the last grid query
+    int queryResultsSize;              ///< Size of queryResults in elements
+    uint32_t queryId;                  ///< Incremented every grid query
 };
 
+/// \brief Handles replaced by a defragmentation move, kept alive until the GPU is done with them
+typedef struct VK2DDefragMove_t {
+    VK2DImage image;     ///< Image that was moved, or NULL if this move is for a buffer
+    VK2DBuffer buffer;   ///< Buffer that was moved, or NULL if this move is for an image
+    VkImage oldImage;    ///< Image handle from before the move
+    VkImageView oldView; ///< Image view from before the move
+    VkBuffer oldBuffer;  ///< Buffer handle from before the move
+} VK2DDefragMove;
+
+/// \brief CPU and GPU time of a single frame
+typedef struct VK2DFrameTime_t {
+    uint64_t frame; ///< Value of frameCount for this frame, 0 if this entry is unused
+    double cpu;     ///< Time the CPU spent between vk2dRendererStartFrame and vk2dRendererEndFrame in ms
+    double gpu;     ///< Time between the first and last GPU timestamp of the frame in ms, negative if unknown
+} VK2DFrameTime;
+
+/// \brief A scope recorded by the GPU profiler, its timestamps are queries 2 * i and 2 * i + 1 for scope i
+typedef struct VK2DGPUScope_t {
+    const char *name; ///< Name of the scope
+    uint32_t depth;   ///< Number of scopes this one is nested inside of
+    bool ended;       ///< Whether or not the end timestamp was written
+} VK2DGPUScope;
+
+/// \brief An offscreen pass recorded by the frame graph
+typedef struct VK2DFrameGraphPass {
+    VK2DTexture target;     ///< Texture this pass draws to
+    VkCommandBuffer buffer; ///< Secondary command buffer the pass's draws are recorded into
+    VK2DTargetOps ops;      ///< How the pass starts
+} VK2DFrameGraphPass;
+
+/// \brief Everything owned by a single frame in flight, the renderer cycles through options.framesInFlight of these
+typedef struct VK2DFrameContext {
+    VkCommandBuffer commandBuffer;         ///< Main command buffer for the frame's draws
+    VkCommandBuffer dbCommandBuffer;       ///< Command buffer for descriptor buffer copies
+    VkCommandBuffer computeCommandBuffer;  ///< Command buffer for compute passes
+    VK2DDescriptorBuffer descriptorBuffer; ///< Descriptor buffer for this frame's per-draw data
+    VK2DDescCon descConCompute;            ///< Descriptor controller for sprite batch compute buffer
+    VK2DDescCon descConShaders;            ///< Descriptor controller for user shaders
+    VK2DDescCon descConSBO;                ///< Descriptor controller for sprite batch vertex shader SBO
+    VkDescriptorSet uboDescriptorSet;      ///< Descriptor set holding this frame's UBO
+    VkSemaphore imageAvailableSemaphore;   ///< Signaled when the swapchain image acquired this frame is ready
+    VkSemaphore computeFinishedSemaphore;  ///< Signaled when the copy/compute submit on the async compute queue is done
+    uint64_t timelineValue;                ///< Device timeline value signaled once the GPU is done with everything above, 0 before first use
+    uint64_t frame;                        ///< frameCount of the last frame submitted with this context, 0 before first use
+    VkQueryPool gpuQueryPool;              ///< Timestamp query pool, VK_NULL_HANDLE if the profiler is disabled
+    VK2DGPUScope *gpuScopes;               ///< VK2D_MAX_GPU_SCOPES scopes recorded this frame
+    uint32_t gpuScopeCount;                ///< Number of scopes in gpuScopes
+    VkCommandBuffer screenPassBuffer;      ///< Secondary command buffer for screen draws, only used by the frame graph
+    VK2DFrameGraphPass *graphPasses;       ///< Offscreen passes in the order they were first targeted this frame
+    uint32_t graphPassCount;               ///< Number of passes recorded this frame
+    uint32_t graphPassCapacity;            ///< Number of elements in graphPasses, each with an allocated buffer
+} VK2DFrameContext;
+
+/// \brief Where a texture reload is at, only the thread that moves it out of a state may read its results
+typedef enum {
+    VK2D_TEXTURE_RELOAD_QUEUED = 0,  ///< Waiting for the worker thread
+    VK2D_TEXTURE_RELOAD_LOADING = 1, ///< Being decoded and uploaded by the worker thread
+    VK2D_TEXTURE_RELOAD_DONE = 2,    ///< Finished or cancelled, image is the result
+} VK2DTextureReloadState;
+
+/// \brief An evicted texture being decoded and uploaded again, off the main thread if there is a worker thread
+typedef struct VK2DTextureReload_t {
+    VK2DTexture tex;     ///< Texture to restore, NULL if it was freed before the reload finished
+    char *sourceFile;    ///< Copy of the texture's source file, or NULL
+    void *sourceData;    ///< Copy of the texture's source data if there is no file, or NULL
+    int sourceSize;      ///< Size of sourceData in bytes
+    VK2DImage image;     ///< Uploaded image once done, NULL if decoding failed or the reload was cancelled
+    SDL_AtomicInt state; ///< A VK2DTextureReloadState
+} VK2DTextureReload;
+
 /// \brief Information per texture
 typedef struct VK2DTextureDescriptorInfo_t {
-    bool active;
+    bool active;               ///< Whether or not a texture occupies this slot
+    bool evicted;              ///< Whether or not the texture's image has been evicted from VRAM
+    bool reloadQueued;         ///< Whether or not an evicted texture was drawn and is waiting to be reloaded
+    VK2DTextureReload *reload; ///< Reload in progress for this slot, or NULL if it hasn't started
+    VK2DTexture tex;           ///< Texture occupying this slot
+    uint64_t lastUsedFrame;    ///< Last frame this slot was drawn with, for LRU eviction
 } VK2DTextureDescriptorInfo;
 
 struct VK2DFontHandle {
@@ -213,6 +347,8 @@ struct VK2DGui_t {
 	size_t fontsCount;
 	struct nk_context *context;
     struct nk_font_atlas *atlas;
+    VK2DImage atlasImage; // baked font atlas
+    VK2DTexture atlasTexture; // font atlas's slot in the texture array, which is what nuklear samples from
 	bool fontsLoaded; // ok if no fonts loaded, but we need to make the font atlas regardless
 };
 
@@ -244,8 +380,7 @@ struct VK2DRenderer_t {
 	VK2DRendererLimits limits;            ///< For user safety
 
 	// Cameras/ubos
-	VkDescriptorSet uboDescriptorSets[VK2D_MAX_FRAMES_IN_FLIGHT]; ///< Descriptor sets holding a UBO per frame in flight
-	VK2DUniformBufferObject workingUBO;                           ///< This frame's ubo, basically just has VK2D_MAX_CAMERAS viewproj matricies
+	VK2DUniformBufferObject workingUBO; ///< This frame's ubo, basically just has VK2D_MAX_CAMERAS viewproj matricies
 
 	// KHR Surface
 	SDL_Window *window;                           ///< Window this renderer belongs to
@@ -262,13 +397,17 @@ struct VK2DRenderer_t {
 	VkImage *swapchainImages;              ///< Images of the swapchain
 	VkImageView *swapchainImageViews;      ///< Image views for the swapchain images
 	uint32_t swapchainImageCount;          ///< Number of images in the swapchain
+	bool dynamicRendering;                 ///< If true there are no render passes or framebuffers and VK_KHR_dynamic_rendering is used instead
 	VkRenderPass renderPass;               ///< The render pass
 	VkRenderPass midFrameSwapRenderPass;   ///< Render pass for mid-frame switching back to the swapchain as a target
 	VkRenderPass externalTargetRenderPass; ///< Render pass for rendering to textures
+	VkRenderPass targetRenderPasses[2][VK2D_TARGET_OP_MAX][VK2D_TARGET_OP_MAX][2]; ///< Render passes for switching targets indexed by [screen][colour op][depth op][discard depth], made as they're needed
 	VkFramebuffer *framebuffers;           ///< Framebuffers for the swapchain images
 	VK2DImage depthBuffer;                 ///< Depth buffer for 3D rendering
 	VkFormat depthBufferFormat;            ///< Depth buffer format
 	bool procedStartFrame;                 ///< End frame things are only done if this is true and start frame things are only done if this is false
+	VkCommandBuffer drawBuffer;            ///< Command buffer draws are recorded into, the frame's command buffer or a frame graph pass
+	vec4 screenClearColour;                ///< Clear colour passed to vk2dRendererStartFrame, used when the frame graph begins the screen pass
 
 	// Pipelines
 	VK2DPipeline modelPipe;       ///< Pipeline for 3D models
@@ -293,28 +432,20 @@ struct VK2DRenderer_t {
 	VK2DDescCon descConSamplersOff;           ///< Descriptor controller for samplers off thread
 	VK2DDescCon descConVP;                    ///< Descriptor controller for view projection buffers
 	VK2DDescCon descConUser;                  ///< Descriptor controller for user buffers
-	VK2DDescCon descConCompute[VK2D_MAX_FRAMES_IN_FLIGHT]; ///< Descriptor controller for sprite batch compute buffer
-    VK2DDescCon descConShaders[VK2D_MAX_FRAMES_IN_FLIGHT]; ///< Descriptor controller for user shaders
-    VK2DDescCon descConSBO[VK2D_MAX_FRAMES_IN_FLIGHT];     ///< Descriptor controller for sprite batch vertex shader SBO
     VkDescriptorPool samplerPool;             ///< Sampler pool for 1 sampler
 	VkDescriptorPool texArrayPool;            ///< Tex array pool
 	VkDescriptorSet texArrayDescriptorSet;    ///< Tex array set
 	VkDescriptorSet samplerSet;               ///< Sampler for all textures
 	VkDescriptorSet modelSamplerSet;          ///< Sampler for all 3D models
-	VK2DDescriptorBuffer *descriptorBuffers;  ///< Descriptor buffer, one per frame in flight
     VkDescriptorPool texturePool;             ///< Pool used for the dynamic texture array
     VK2DTextureDescriptorInfo *textureArray;  ///< Array of information per texture
 
 	// Frame synchronization
-	uint32_t currentFrame;                 ///< Current frame being looped through
-	uint32_t scImageIndex;                 ///< Swapchain image index to be rendered to this frame
-	VkSemaphore *imageAvailableSemaphores; ///< Semaphores to signal when the image is ready
-	VkSemaphore *renderFinishedSemaphores; ///< Semaphores to signal when rendering is done
-	VkFence *inFlightFences;               ///< Fences for each frame
-	VkFence *imagesInFlight;               ///< Individual images in flight
-	VkCommandBuffer *commandBuffer;        ///< Command buffers, recreated each frame
-	VkCommandBuffer *dbCommandBuffer;      ///< Command buffers for descriptor buffers
-	VkCommandBuffer *computeCommandBuffer; ///< Command buffers for compute passes
+	VK2DFrameContext frames[VK2D_MAX_FRAMES_IN_FLIGHT]; ///< Frame context ring, only the first options.framesInFlight are used
+	uint32_t currentFrame;                              ///< Index of the frame context being recorded
+	uint32_t scImageIndex;                              ///< Swapchain image index to be rendered to this frame
+	VkSemaphore *renderFinishedSemaphores;              ///< Semaphores to signal when rendering is done, one per swapchain image
+	uint64_t *imagesInFlight;                           ///< Timeline value of the frame that last used each swapchain image
 
 	// Render targeting info
 	uint32_t targetSubPass;          ///< Current sub pass being rendered to
@@ -344,6 +475,47 @@ struct VK2DRenderer_t {
 	double accumulatedTime;  ///< Total time of frames for average in ms
 	double frameTimeAverage; ///< Average amount of time frames are taking over a second (in ms)
 
+	// Frame pacing
+	double frameLimit;                ///< Target frames per second for the frame limiter, 0 if disabled
+	uint64_t nextFrameDeadline;       ///< Performance counter value the next frame may start at, 0 to resynchronize
+	uint64_t presentId;               ///< Present ID of the last frame presented to the current swapchain, 0 if none
+	VK2DInputCallback inputCallback;  ///< Called at the end of vk2dRendererStartFrame
+	void *inputCallbackData;          ///< Userdata for inputCallback
+	VK2DFrameTime *frameTimes; ///< Ring buffer of the last options.frameTimeHistory frames, indexed by frame % size
+
+	// Statistics
+	VK2DFrameStats frameStats;         ///< Counters for the frame currently being recorded
+	VK2DFrameStats previousFrameStats; ///< Counters for the last completed frame
+
+	// Texture residency
+	uint64_t frameCount;                ///< Total number of frames started, used to track when textures were last drawn
+	VK2DImage evictedImage;             ///< 1x1 transparent image evicted texture slots point to until they are reloaded
+	uint32_t texturesPendingReload;     ///< Number of slots with reloadQueued set
+	VK2DTextureReload **textureReloads; ///< Reloads that haven't been swapped in yet, only changed with ld->loadListMutex held
+	uint32_t textureReloadCount;        ///< Number of reloads in textureReloads
+	uint32_t textureReloadCapacity;     ///< Number of elements allocated for textureReloads
+	SDL_AtomicInt textureReloadsQueued; ///< Number of reloads in VK2D_TEXTURE_RELOAD_QUEUED, so the worker can skip the lock
+
+	// Defragmentation
+	VmaDefragmentationContext defragContext;   ///< Defragmentation currently in progress, or NULL
+	VmaDefragmentationPassMoveInfo defragPass; ///< Moves in the pass that is waiting on the GPU
+	VK2DDefragMove *defragMoves;               ///< Old handles for each move in defragPass
+	bool defragPassPending;                    ///< Whether or not a pass has been submitted and not yet ended
+	uint64_t defragPassFrame;                  ///< frameCount when the pending pass was submitted
+	uint64_t defragPassValue;                  ///< Device timeline value signaled once the pending pass' copies are complete
+	uint64_t defragPassFrameValue;             ///< Timeline value of the last frame submitted before the pending pass
+	VkCommandBuffer defragCommandBuffer;       ///< Command buffer the pending pass' copies were recorded to
+
+	// GPU profiling
+	bool gpuProfiling;                               ///< Whether the GPU profiler was created, per-frame pieces live in frames
+	int32_t gpuScopeStack[VK2D_MAX_GPU_SCOPE_DEPTH]; ///< User scopes that have begun but not ended
+	uint32_t gpuScopeDepth;                          ///< Number of scopes in gpuScopeStack
+	int32_t gpuPassScope;                            ///< Scope around the current render pass
+	int32_t gpuComputeScope;                         ///< Scope around the sprite batch compute dispatches
+	VK2DGPUTiming *gpuTimings;                       ///< Timings from the most recent frame the GPU has finished
+	uint32_t gpuTimingCount;                         ///< Number of timings in gpuTimings
+	double gpuTimestampPeriod;                       ///< Nanoseconds per timestamp tick
+
 	// Sprite batching
 	VK2DDrawCommand *drawCommands;       ///< User-side draw commands
 	int drawCommandCount;                ///< Number of draw commands
@@ -72,7 +72,7 @@ extern "C" {
 #endif
 
 /// \brief Initializes VK2D's renderer
-/// \param window An SDL window created with the flag SDL_WINDOW_VULKAN
+/// \param window An SDL window created with the flag SDL_WINDOW_VULKAN, or NULL to render headless
 /// \param config Initial renderer configuration settings
 /// \param options Renderer options, or just NULL for defaults
 /// \return Returns a VK2DResult enum
@@ -94,6 +94,22 @@ extern "C" {
 /// `loadCustomShaders` defaults to `false`
 /// `vramPageSize` defaults to `256 * 1000`, setting this to 0 also uses `256 * 1000`
 /// `maxTextures` defaults to 10000, setting this to 0 also uses 10000.
+/// `vramEvictionThreshold` defaults to 0, which disables texture eviction
+/// `enableGPUProfiler` defaults to `false`
+/// `frameTimeHistory` defaults to 1000, setting this to 0 also uses 1000
+/// `headlessWidth` and `headlessHeight` default to 1280x720, setting either to 0 also uses the default
+/// `framesInFlight` defaults to VK2D_DEFAULT_FRAMES_IN_FLIGHT (2), setting this to 0 also uses the default and
+/// anything above VK2D_MAX_FRAMES_IN_FLIGHT is clamped to it
+/// `enableAsyncCompute` defaults to `false`
+/// `lowLatencyPacing` defaults to `false`
+/// `enableFrameGraph` defaults to `false`
+/// `enableDynamicRendering` defaults to `false`
+///
+/// If window is NULL the renderer is started headless. Instead of a window surface it uses
+/// `VK_EXT_headless_surface`, which is supported by software implementations like lavapipe and
+/// SwiftShader, so the frame loop is exactly the same but nothing is ever shown. The screen
+/// is `headlessWidth` by `headlessHeight` pixels and Nuklear is always disabled. To check the
+/// results, draw into a target texture and read it back with vk2dTextureRead.
 ///
 VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const VK2DStartupOptions *options);
 
@@ -146,6 +162,19 @@ void vk2dRendererSetConfig(VK2DRendererConfig config);
 /// this number may be including Vulkan objects that also live in VRAM like pipelines or render passes.
 void vk2dRendererGetVRAMUsage(float *inUse, float *total);
 
+/// \brief Incrementally defragments the video memory used by textures and loaded buffers
+/// \param budgetMs Roughly how long in milliseconds to spend recording moves, 0 for no limit
+/// \return Returns true once there is nothing left to defragment
+///
+/// Long-running programs that create and free many textures can fragment VRAM to the point
+/// that new allocations fail despite there being enough memory free. Call this once per frame
+/// outside of vk2dRendererStartFrame/vk2dRendererEndFrame until it returns true. Each call either
+/// records and submits a batch of copies or, once every frame that may have used the old memory
+/// is finished, releases the memory the previous batch moved out of. The GPU is never waited on,
+/// so a pass completes over the next couple of frames. Render targets and textures drawn within the
+/// last couple frames are not moved, and all VK2DTexture/VK2DImage/VK2DBuffer handles remain valid.
+bool vk2dRendererDefragment(float budgetMs);
+
 /// \brief Forces the renderer to rebuild itself (VK2D does this automatically)
 ///
 /// This is automatically done when Vulkan detects the window is no longer suitable,
@@ -173,8 +202,20 @@ VK2DLogicalDevice vk2dRendererGetDevice();
 ///
 /// Switches drawing operations so that they will be performed on the specified target.
 /// Target must be either a texture that was created for rendering or VK2D_TARGET_SCREEN.
+/// Switching directly from one texture target to another does not touch the screen, so
+/// ping-ponging between textures only costs one render pass per switch.
 void vk2dRendererSetTarget(VK2DTexture target);
 
+/// \brief Changes the render target like vk2dRendererSetTarget but controls how the target's contents start out
+/// \param target Target texture to switch to or VK2D_TARGET_SCREEN for the screen
+/// \param ops What to do with the target's colour and depth, NULL behaves like vk2dRendererSetTarget
+///
+/// Post-processing targets that get drawn over entirely can use VK2D_TARGET_OP_DONT_CARE so
+/// their old contents are never read, and VK2D_TARGET_OP_CLEAR clears as the pass starts
+/// instead of drawing over the target. If `target` is already the current target no new
+/// pass is started, any clears in `ops` are done in the current pass instead.
+void vk2dRendererSetTargetOps(VK2DTexture target, const VK2DTargetOps *ops);
+
 /// \brief Sets the rendering blend mode (does nothing if VK2D_GENERATE_BLEND_MODES is disabled)
 /// \param blendMode Blend mode to use for drawing
 void vk2dRendererSetBlendMode(VK2DBlendMode blendMode);
@@ -203,10 +244,100 @@ void vk2dRendererGetColourMod(vec4 dst);
 /// may draw your game to a texture.
 void vk2dRendererSetTextureCamera(bool useCameraOnTextures);
 
+/// \brief Gets counters for everything the renderer did during the last completed frame
+/// \return Returns the stats of the frame most recently ended with vk2dRendererEndFrame
+///
+/// The counters are plain integer increments so they are always collected. This is useful to see why a frame
+/// is slow, for example if spriteFlushes[VK2D_FLUSH_REASON_BLEND_CHANGE] is high then the sprite batch is being
+/// broken up by blend mode changes.
+VK2DFrameStats vk2dRendererGetFrameStats();
+
+/// \brief Gets the distribution of CPU and GPU frame times over recent frames
+/// \param window Number of most recent frames to consider, 0 or anything above the startup option frameTimeHistory uses the whole history
+/// \param cpu Will be filled with stats for the time between vk2dRendererStartFrame and vk2dRendererEndFrame, may be NULL
+/// \param gpu Will be filled with stats for the GPU time of each frame, may be NULL
+///
+/// GPU times are only available if the renderer was started with enableGPUProfiler, otherwise gpu->frames will
+/// be 0. GPU times lag behind by the startup option framesInFlight frames, see vk2dRendererGetGPUTimings.
+void vk2dRendererGetFrameTimeStats(uint32_t window, VK2DFrameTimeStats *cpu, VK2DFrameTimeStats *gpu);
+
+/// \brief Writes every frame time in the history to a CSV file
+/// \param filename File to write to, it will be overwritten
+/// \return Returns true if the file was written
+///
+/// The file has the columns `frame,cpu_ms,gpu_ms`, with gpu_ms left empty where the GPU time is not known.
+bool vk2dRendererDumpFrameTimes(const char *filename);
+
+/// \brief Writes every CPU trace zone recorded so far to a Chrome `trace_event` JSON file
+/// \param filename File to write to, it will be overwritten
+/// \return Returns true if the file was written
+///
+/// Zones are only recorded if Vulkan2D was built with VK2D_ENABLE_TRACING. If it was also built with
+/// VK2D_TRACY the zones go straight to Tracy and this function does nothing. The file can be opened in
+/// chrome://tracing or Perfetto alongside your own traces.
+bool vk2dRendererWriteTrace(const char *filename);
+
+/// \brief Gets how many times a Vulkan entry point has been called, only available with the null backend
+/// \param entryPoint Name of the Vulkan function, like `"vkCmdDraw"`, or NULL for the total of every entry point
+/// \return Returns the number of calls since startup or the last vk2dRendererResetVulkanCallCounts, always 0 unless
+/// Vulkan2D was built with VK2D_NULL_BACKEND
+///
+/// The null backend (CMake option VK2D_NULL_BACKEND) replaces the Vulkan loader with stubs that accept
+/// everything, signal fences immediately, and never touch a GPU, leaving only VK2D's own CPU work to measure.
+/// The renderer must be started headless (a NULL window) since no real surface can be made.
+uint64_t vk2dRendererGetVulkanCallCount(const char *entryPoint);
+
+/// \brief Resets every count returned by vk2dRendererGetVulkanCallCount to 0
+void vk2dRendererResetVulkanCallCounts();
+
+/// \brief Begins a named GPU timing scope, see vk2dRendererGetGPUTimings
+/// \param name Name of the scope, this pointer is kept until the results are read back so it should be a string literal
+///
+/// Scopes may be nested up to VK2D_MAX_GPU_SCOPE_DEPTH deep and must be ended with vk2dRendererEndGPUScope before
+/// vk2dRendererEndFrame. The sprite batch is flushed at the start and end of a scope so only draws inside of it are
+/// measured. Does nothing unless the renderer was started with enableGPUProfiler.
+void vk2dRendererBeginGPUScope(const char *name);
+
+/// \brief Ends the most recently started GPU timing scope
+void vk2dRendererEndGPUScope();
+
+/// \brief Gets the GPU time spent in each profiler scope from the most recent frame the GPU has finished
+/// \param count Will be set to the number of timings in the returned list
+/// \return Returns a list of timings in the order their scopes began, or NULL if the profiler is disabled
+///
+/// Results lag behind by the startup option framesInFlight frames since they can't be read until the GPU is done
+/// with the frame. The renderer times the descriptor buffer copy, sprite batch compute dispatches, each render
+/// pass (one for the screen and one each time a target is set), shadow draws, and Nuklear. The list
+/// is owned by the renderer and is overwritten at the start of each frame.
+const VK2DGPUTiming *vk2dRendererGetGPUTimings(uint32_t *count);
+
 /// \brief Gets the average amount of time frames are taking to process from the end of vk2dRendererEndFrame to the end of the next vk2dRendererEndFrame
 /// \return Returns average frame time over a course of a second in ms (1000 / vk2dRendererGetAverageFrameTime() will give FPS)
 double vk2dRendererGetAverageFrameTime();
 
+/// \brief Limits how often frames may start, independent of vsync
+/// \param fps Target frames per second, 0 or less disables the limiter (the default)
+///
+/// The limiter waits at the start of vk2dRendererStartFrame. It sleeps for most of the remaining time and
+/// busy-waits the last VK2D_FRAME_LIMITER_SPIN_MS milliseconds since OS sleeps tend to overshoot. If a frame runs
+/// long the schedule is reset instead of rushing the following frames to catch up.
+void vk2dRendererSetFrameLimit(double fps);
+
+/// \brief Gets the frame limit set with vk2dRendererSetFrameLimit
+/// \return Returns the target frames per second, or 0 if the limiter is disabled
+double vk2dRendererGetFrameLimit();
+
+/// \brief Sets a function to be called once per frame at the latest point before drawing starts
+/// \param callback Function to call or NULL to remove it
+/// \param userdata Passed to the callback as-is
+///
+/// The callback runs inside vk2dRendererStartFrame once frame pacing, the frame limiter, and swapchain acquisition
+/// have all finished waiting. Polling input there instead of before vk2dRendererStartFrame keeps the delay between
+/// reading input and the frame reaching the screen as small as possible. Camera changes made in the callback
+/// apply to the frame being started.
+/// \warning Nothing may be drawn from inside the callback
+void vk2dRendererSetInputCallback(VK2DInputCallback callback, void *userdata);
+
 /// \brief Sets the current camera settings
 /// \param camera Camera settings to use
 ///
@@ -230,6 +361,10 @@ void vk2dRendererUnlockCameras();
 void vk2dRendererClear();
 
 /// \brief Clears the content so that every pixel in the target is set to be complete transparent (useful for new texture targets)
+///
+/// On the screen only the viewports of cameras that are being drawn to are cleared, texture targets
+/// are cleared entirely. vk2dRendererSetTargetOps with VK2D_TARGET_OP_CLEAR clears a whole target
+/// while switching to it.
 void vk2dRendererEmpty();
 
 /// \brief Returns the limits of the renderer on the current host
@@ -361,6 +496,24 @@ void vk2dRendererDrawGeometry(VK2DVertexColour *vertices, int count, float x, fl
 /// \param lightSource Light source position
 void vk2dRendererDrawShadows(VK2DShadowEnvironment shadowEnvironment, vec4 colour, vec2 lightSource);
 
+/// \brief Draws a shadow environment for several lights at once
+/// \param shadowEnvironment Shadows to draw
+/// \param lights Lights to draw shadows for
+/// \param count Number of lights in the list
+///
+/// Each light only draws the edges within its radius, the rest are culled on the CPU before
+/// anything is recorded, and its shadows are only extruded as far as its radius instead of to
+/// infinity.
+///
+/// All lights are recorded back to back into the current render target without switching passes
+/// or targets. Lights are kept apart by colour rather than by target: give each light its own
+/// channel in its colour (ie, {1, 0, 0, 0} for the first, {0, 1, 0, 0} for the second) and draw
+/// with VK2D_BLEND_MODE_ADD, then one light-accumulation target holds up to four lights' shadows
+/// and sampling a channel tells you how shadowed a pixel is for that light. This keeps a batch of
+/// lights to a single pass with no extra targets or copies, call this again per batch of four
+/// lights (or per target) when you have more.
+void vk2dRendererDrawShadowLights(VK2DShadowEnvironment shadowEnvironment, const VK2DShadowLight *lights, int count);
+
 /// \brief Renders a 3D model
 /// \param model Model to render
 /// \param x x position to draw at
@@ -384,6 +537,32 @@ void
 vk2dRendererDrawModel(VK2DModel model, float x, float y, float z, float xscale, float yscale, float zscale, float rot,
 					  vec3 axis, float originX, float originY, float originZ);
 
+/// \brief Renders many copies of a 3D model at once
+/// \param model Model to render
+/// \param transforms Model matrix of each copy, see vk2dRendererGetModelTransform
+/// \param count Number of copies to render
+/// \warning This function will only render to 3D-enabled cameras (which you must set up yourself) and if there are
+/// none available this function will simply do nothing.
+///
+/// The transforms are uploaded once and every copy is drawn with a single instanced draw per 3D camera.
+/// Use this instead of calling vk2dRendererDrawModel in a loop. transforms may only be NULL if count is 0.
+void vk2dRendererDrawModelInstanced(VK2DModel model, const mat4 *transforms, int count);
+
+/// \brief Builds the model matrix vk2dRendererDrawModel would use, for vk2dRendererDrawModelInstanced
+/// \param transform Matrix to write to
+/// \param x x position to draw at
+/// \param y y position to draw at
+/// \param z z position to draw at
+/// \param xscale Scale that will be applied to the x-plane of the model
+/// \param yscale Scale that will be applied to the y-plane of the model
+/// \param zscale Scale that will be applied to the z-plane of the model
+/// \param rot Rotation of the model
+/// \param axis Axis to rotate on
+/// \param originX x origin to rotate around
+/// \param originY y origin to rotate around
+/// \param originZ z origin to rotate around
+void vk2dRendererGetModelTransform(mat4 transform, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ);
+
 /// \brief Renders a 3D model as a wireframe
 /// \param model Model to render
 /// \param x x position to draw at
@@ -3,6 +3,7 @@
 /// \brief Declares functions only the internal renderer needs
 #pragma once
 #include <VK2D/Renderer.h>
+#include <vk_mem_alloc.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,6 +20,21 @@ void _vk2dRendererRemoveTarget(VK2DTexture tex);
 // This is used when changing the render target to make sure the texture is either ready to be drawn itself or rendered to
 void _vk2dTransitionImageLayout(VkImage img, VkImageLayout old, VkImageLayout new);
 
+// Moves one texture target back to shader read and another to colour attachment in a single barrier
+void _vk2dTransitionTargetSwap(VkImage previous, VkImage next);
+
+// Gets the current swapchain image's framebuffer, or VK_NULL_HANDLE if dynamic rendering means there are none
+VkFramebuffer _vk2dRendererGetScreenFramebuffer();
+
+// Gets the render pass for switching to the screen or a texture with the given ops, making it if this is the first use
+VkRenderPass _vk2dRendererGetTargetRenderPass(bool screen, const VK2DTargetOps *ops);
+
+// Clears the current target from inside its pass for whichever of its colour and depth ops are VK2D_TARGET_OP_CLEAR
+void _vk2dRendererClearTarget(const VK2DTargetOps *ops);
+
+// Same as _vk2dRendererClearTarget but on the screen it only clears the viewports of cameras being drawn to
+void _vk2dRendererClearCameras(const VK2DTargetOps *ops);
+
 // Rebuilds the matrices for a given buffer and camera
 void _vk2dCameraUpdateUBO(VK2DUniformBufferObject *ubo, VK2DCameraSpec *camera, int index);
 
@@ -43,6 +59,67 @@ void _vk2dRendererResetBoundPointers();
 // Gets the size of the rendered surface
 void _vk2dRendererGetSurfaceSize();
 
+// Marks a texture in the texture array as used this frame, queueing a reload if it was evicted
+void _vk2dRendererTouchTexture(uint32_t id);
+
+// Starts reloading evicted textures that were drawn last frame and swaps in finished reloads, call before recording starts
+void _vk2dRendererRestoreTextures();
+
+// Decodes and uploads one queued texture reload, called by the worker thread
+void _vk2dRendererRunTextureReload();
+
+// Cancels or waits on every texture reload in progress and frees them
+void _vk2dRendererDestroyTextureReloads();
+
+// Evicts least-recently-used textures until VRAM usage is under the eviction threshold
+void _vk2dRendererEvictTextures();
+
+// Runs one incremental defragmentation step, returns true once defragmentation is complete
+bool _vk2dRendererDefragmentStep(float budgetMs);
+
+// Finishes the pending defragmentation pass if it is moving the given allocation, call before freeing it
+void _vk2dRendererDefragmentRelease(VmaAllocation mem);
+
+// Waits on and ends any defragmentation in progress
+void _vk2dRendererDestroyDefragmentation();
+
+// Starts dynamic rendering to the screen or a texture target, clearing the screen also readies its images for the frame,
+// otherwise ops says how the target starts (NULL for the vk2dRendererSetTarget behaviour)
+void _vk2dRendererBeginRendering(VkCommandBuffer buf, VK2DTexture target, const vec4 clearColour, const VK2DTargetOps *ops, VkRenderingFlagsKHR flags);
+
+// Moves the swapchain image to the present layout once dynamic rendering to it is done for the frame
+void _vk2dRendererEndRenderingFrame(VkCommandBuffer buf);
+
+// Begins recording the screen pass into its secondary command buffer when the frame graph is enabled
+void _vk2dRendererBeginFrameGraph(const vec4 clearColour);
+
+// Points draws at the pass for the given target, starting a new one the first time a texture is targeted this frame
+void _vk2dRendererFrameGraphSetTarget(VK2DTexture target, const VK2DTargetOps *ops);
+
+// Records every offscreen pass followed by the screen pass into the frame's command buffer
+void _vk2dRendererEndFrameGraph();
+
+// Waits for the previous frame to be displayed if low-latency pacing is on, then for the frame limiter
+void _vk2dRendererPaceFrame();
+
+// Reads back the timestamps of the frame that last used this frame's query pool and resets it
+void _vk2dRendererBeginProfilerFrame();
+
+// Writes a starting timestamp at the given stage, returns the scope's index or -1 if it wasn't recorded
+int32_t _vk2dRendererBeginGPUScope(VkCommandBuffer buf, const char *name, VkPipelineStageFlagBits stage);
+
+// Writes the ending timestamp for a scope, does nothing if scope is -1
+void _vk2dRendererEndGPUScope(VkCommandBuffer buf, int32_t scope);
+
+// Uploads a shadow environment's edges and objects to the GPU if either changed since they were last uploaded
+void _vk2dShadowEnvironmentBake(VK2DShadowEnvironment shadowEnvironment);
+
+// Fills a baked shadow environment's light edge list with the edges within radius of a light, returns the edge count
+int _vk2dShadowEnvironmentCullLight(VK2DShadowEnvironment shadowEnvironment, float x, float y, float radius);
+
+// Fills a shadow environment's query results with the enabled objects whose bounds overlap an area, returns the object count
+int _vk2dShadowEnvironmentQuery(VK2DShadowEnvironment shadowEnvironment, float left, float top, float right, float bottom);
+
 /****************************** Renderer Initialization/Destruction ******************************/
 
 void _vk2dRendererCreateDebug();
@@ -62,6 +139,10 @@ void _vk2dRendererDestroyRenderPass();
 void _vk2dRendererInitNuklear();
 void _vk2dRendererQuitNuklear();
 void _vk2dRendererResetNuklear();
+
+// Converts the GUI and records it into buf, which must be inside the screen pass
+void _vk2dRendererDrawNuklear(VkCommandBuffer buf);
+
 void _vk2dRendererCreateDescriptorSetLayouts();
 void _vk2dRendererDestroyDescriptorSetLayout();
 void _vk2dRendererCreatePipelines();
@@ -72,6 +153,8 @@ void _vk2dRendererCreateUniformBuffers(bool newCamera);
 void _vk2dRendererDestroyUniformBuffers();
 void _vk2dRendererCreateSpriteBatching();
 void _vk2dRendererDestroySpriteBatching();
+void _vk2dRendererCreateProfiler();
+void _vk2dRendererDestroyProfiler();
 void _vk2dRendererCreateDescriptorPool(bool preserveDescCons);
 void _vk2dRendererDestroyDescriptorPool(bool preserveDescCons);
 void _vk2dRendererCreateSynchronization();
@@ -92,20 +175,25 @@ void _vk2dRendererAddDrawCommand(VK2DDrawCommand *command);
 // Resets current batch information
 void _vk2dRendererResetBatch();
 
-// Flushes the current batch if its necessary, pipe is the pipeline of the current draw command
-void _vk2dRendererFlushBatchIfNeeded(VK2DPipeline pipe);
+// Flushes the current batch if its necessary, pipe is the pipeline of the current draw command and reason is
+// what gets recorded if the batch is flushed because pipe isn't the batch's pipeline
+void _vk2dRendererFlushBatchIfNeeded(VK2DPipeline pipe, VK2DFlushReason reason);
+
+// Flushes the sprite batch, recording why in the frame stats
+void _vk2dRendererFlushSpriteBatch(VK2DFlushReason reason);
 
 void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon poly, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam);
 void _vk2dRendererDrawRawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTexture tex, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam);
-void _vk2dRendererDrawRawShadows(VkDescriptorSet set,
-    VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object,
-    vec4 colour, vec2 lightSource, VK2DCameraIndex cam);
+void _vk2dRendererDrawRawShadows(VkDescriptorSet *sets, vec4 colour, vec2 lightSource, float radius, VkBuffer *buffers, VkDeviceSize *offsets, uint32_t edgeCount, VK2DCameraIndex cam);
 void _vk2dRendererDrawRawInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2DDrawInstance *instances, int count, VK2DCameraIndex cam);
 void _vk2dRendererDraw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon poly, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight);
 void _vk2dRendererDrawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTexture tex, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight);
-void _vk2dRendererDrawShadows(VK2DShadowEnvironment shadowEnvironment, vec4 colour, vec2 lightSource);
-void _vk2dRendererDrawRaw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ, VK2DCameraIndex cam, float lineWidth);
+void _vk2dRendererDrawShadows(VkDescriptorSet objectSet, vec4 colour, vec2 lightSource, float radius, VkBuffer *buffers, VkDeviceSize *offsets, uint32_t edgeCount);
+void _vk2dRendererDrawShadowLights(VK2DShadowEnvironment shadowEnvironment, const VK2DShadowLight *lights, int count);
+void _vk2dRendererModelMatrix(mat4 model, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ);
+void _vk2dRendererDrawRaw3DInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, int count, VK2DCameraIndex cam, float lineWidth);
 void _vk2dRendererDraw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ, float lineWidth);
+void _vk2dRendererDraw3DInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, const mat4 *transforms, int count, float lineWidth);
 
 #ifdef __cplusplus
 }
@@ -70,9 +70,20 @@ void vk2dShadowEnvironmentAddEdge(VK2DShadowEnvironment shadowEnvironment, float
 /// \warning This invalidates all objects previously got from vk2dShadowEnvironmentAddObject
 void vk2dShadowEnvironmentResetEdges(VK2DShadowEnvironment shadowEnvironment);
 
-/// \brief Flushes the edges present in the environment to a VBO that can be drawn to screen
+/// \brief Flushes the edges present in the environment so they can be drawn to screen
 /// \param shadowEnvironment Shadow environment to flush
-/// \warning This function has heavy overhead and should not be called every frame.
+///
+/// This only copies the edges, nothing is sent to the GPU until the environment is drawn. Drawing uploads every
+/// flushed edge once, in object space and tagged with its object, so however many objects there are each light
+/// costs one draw per camera. The models and enabled flags of the objects live in a separate storage buffer that
+/// shadows.vert reads, so moving or enabling/disabling objects only rewrites that and the edges are only uploaded
+/// again when the environment is flushed. It never waits on the GPU: each environment keeps small rings of
+/// host-visible buffers and only writes to one once the frames that drew with it are finished, adding another if
+/// they are all in flight.
+///
+/// Flushing also puts every object into a uniform grid by its bounds in the game world, and moving an object
+/// only touches the grid if it crosses into other cells. Lights with a radius only look at the objects the grid
+/// puts near them, so in a large map most objects are skipped.
 void vk2dShadowEnvironmentFlushVBO(VK2DShadowEnvironment shadowEnvironment);
 
 #ifdef __cplusplus
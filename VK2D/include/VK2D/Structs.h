@@ -170,6 +170,28 @@ typedef enum {
 	VK2D_LOG_SEVERITY_UNKNOWN = 5,
 } VK2DLogSeverity;
 
+/// \brief Reasons the sprite batch may be flushed, see VK2DFrameStats
+typedef enum {
+    VK2D_FLUSH_REASON_EXPLICIT = 0,        ///< vk2dRendererFlushSpriteBatch was called or a GPU scope began/ended
+    VK2D_FLUSH_REASON_END_FRAME = 1,       ///< The frame ended
+    VK2D_FLUSH_REASON_BLEND_CHANGE = 2,    ///< The blend mode changed
+    VK2D_FLUSH_REASON_TARGET_SWITCH = 3,   ///< The render target changed
+    VK2D_FLUSH_REASON_SHADER_DRAW = 4,     ///< A shader draw needed a different pipeline than the batch
+    VK2D_FLUSH_REASON_PRIMITIVE = 5,       ///< A shape, polygon, geometry, model, or shadow was drawn
+    VK2D_FLUSH_REASON_OVERFLOW = 6,        ///< The batch reached VK2DRendererLimits::maxInstancedDraws
+    VK2D_FLUSH_REASON_CAMERA_CHANGE = 7,   ///< Camera lock, state, or texture camera setting changed
+    VK2D_FLUSH_REASON_PIPELINE_CHANGE = 8, ///< A sprite was drawn while the batch was set up for another pipeline
+    VK2D_FLUSH_REASON_MAX = 9,             ///< Number of flush reasons
+} VK2DFlushReason;
+
+/// \brief What happens to a render target's contents when drawing to it starts, see vk2dRendererSetTargetOps
+typedef enum {
+    VK2D_TARGET_OP_LOAD = 0,      ///< Keep what was already there
+    VK2D_TARGET_OP_CLEAR = 1,     ///< Clear colour to VK2DTargetOps::clearColour or depth to the far plane
+    VK2D_TARGET_OP_DONT_CARE = 2, ///< Old contents are undefined, for targets where every pixel gets drawn over
+    VK2D_TARGET_OP_MAX = 3,       ///< Number of target ops
+} VK2DTargetOp;
+
 // VK2D pointers
 VK2D_OPAQUE_POINTER(VK2DRenderer)
 VK2D_OPAQUE_POINTER(VK2DImage)
@@ -195,6 +217,9 @@ typedef float vec3[3];
 /// \brief 4D vector of floats
 typedef float vec4[4];
 
+/// \brief Called by the renderer once a frame as late as possible before drawing starts, see vk2dRendererSetInputCallback
+typedef void (*VK2DInputCallback)(void *userdata);
+
 /// \brief 4x4 matrix of floats
 typedef float mat4[16];
 
@@ -240,7 +265,6 @@ struct VK2DPushBuffer {
 
 /// \brief Push buffer used for 3D models
 struct VK2D3DPushBuffer {
-	mat4 model;            ///< Model matrix
 	vec4 colourMod;        ///< Color modifier
 	uint32_t textureIndex; ///< Index of the texture
 	uint32_t cameraIndex;  ///< Index of the camera
@@ -248,9 +272,9 @@ struct VK2D3DPushBuffer {
 
 /// \brief Push buffer used for hardware-accelerated shadows
 struct VK2DShadowsPushBuffer {
-    mat4 model;           ///< Model matrix for this shadow object
     vec2 lightSource;     ///< Light source position
-    vec2 _alignment;      ///< Simply for memory alignment
+    float radius;         ///< How far shadows are extruded from their edges, 0 to project them to infinity
+    float _alignment;     ///< Simply for memory alignment
     vec4 colour;          ///< Colour of this shadow render
     uint32_t cameraIndex; ///< Index of the camera
 };
@@ -278,6 +302,55 @@ struct VK2DStartupOptions {
 	/// a single geometry render. You may leave this as 0, in which case the renderer will
 	/// make it 256kb.
 	uint64_t vramPageSize;
+
+	/// Fraction of the device's VRAM budget (0-1) that, once exceeded, causes the renderer
+	/// to evict the least-recently-used textures that can be reloaded (those loaded with
+	/// vk2dTextureLoad, vk2dTextureFrom, or vk2dAssetsLoad). An evicted texture is drawn as
+	/// fully transparent until it is reloaded. Drawing it starts the reload at the start of the next
+	/// frame, decoded on the worker thread if VK2DRendererLimits::supportsMultiThreadLoading is true,
+	/// and it is swapped back in at the start of the first frame after that finishes. Leave this
+	/// as 0 to disable texture eviction entirely.
+	float vramEvictionThreshold;
+
+	/// Records GPU timestamps around each phase of the frame and any scopes the user adds
+	/// with vk2dRendererBeginGPUScope, see vk2dRendererGetGPUTimings. This has a very small
+	/// cost but is off by default.
+	bool enableGPUProfiler;
+
+	/// Number of frames to keep CPU/GPU frame times for, see vk2dRendererGetFrameTimeStats.
+	/// You may leave this as 0, in which case the renderer will keep 1000 frames.
+	uint32_t frameTimeHistory;
+
+	/// Width of the screen in pixels when the renderer is started without a window, 0 uses 1280
+	uint32_t headlessWidth;
+
+	/// Height of the screen in pixels when the renderer is started without a window, 0 uses 720
+	uint32_t headlessHeight;
+
+	/// Number of frames the CPU may record ahead of the GPU, from 1 to VK2D_MAX_FRAMES_IN_FLIGHT. 1 gives the
+	/// lowest latency, 3 the most throughput. You may leave this as 0, in which case VK2D_DEFAULT_FRAMES_IN_FLIGHT is used.
+	uint32_t framesInFlight;
+
+	/// Submits the descriptor buffer copy and sprite batch compute work to a dedicated compute queue so it can
+	/// overlap graphics work from the previous frame. Only takes effect on devices with a compute-only queue
+	/// family, and GPU profiler scopes are not recorded for work on that queue. Off by default.
+	bool enableAsyncCompute;
+
+	/// Holds each frame back until the previous one has actually been displayed using VK_KHR_present_wait, keeping
+	/// input-to-photon latency as low and consistent as possible at the cost of some throughput. Only takes effect
+	/// if VK2DRendererLimits::supportsPresentWait is true. Off by default.
+	bool lowLatencyPacing;
+
+	/// Records draws to each render target into their own command buffers instead of switching render passes on
+	/// every vk2dRendererSetTarget. At the end of the frame all texture target passes are rendered in the order they
+	/// were recorded, then the screen is drawn in a single render pass. Texture targets sampling each other work as
+	/// before, but the screen always samples the final contents a texture target has for the frame. Off by default.
+	bool enableFrameGraph;
+
+	/// Replaces render passes and framebuffers with VK_KHR_dynamic_rendering so target switches don't need
+	/// framebuffer objects and resizing the window doesn't recreate any. Only takes effect if
+	/// VK2DRendererLimits::supportsDynamicRendering is true. Off by default.
+	bool enableDynamicRendering;
 };
 
 /// \brief User configurable settings
@@ -326,6 +399,18 @@ struct VK2DRendererLimits {
 	uint64_t maxGeometryVertices;    ///< Maximum vertices that can be used in one vk2dRendererDrawGeometryCall, if you use more vertices than this nothing will happen.
 	bool supportsMultiThreadLoading; ///< Whether or not the host supports loading assets in another thread, if attempt to load assets in another thread and this is false, assets will be loaded on the main thread instead
 	bool supportsVRAMUsage;          ///< Whether or not the host supports accurate VRAM usage, if this is false VMA will provide a less accurate estimate
+	bool supportsPresentWait;        ///< Whether or not the host supports VK_KHR_present_wait, if this is false the lowLatencyPacing startup option does nothing
+	bool supportsDynamicRendering;   ///< Whether or not the host supports VK_KHR_dynamic_rendering, if this is false the enableDynamicRendering startup option does nothing
+};
+
+/// \brief How drawing to a render target starts, see vk2dRendererSetTargetOps
+///
+/// A zero-initialized VK2DTargetOps behaves the same as vk2dRendererSetTarget.
+struct VK2DTargetOps {
+	VK2DTargetOp colour; ///< What happens to the target's colour
+	vec4 clearColour;    ///< Colour to clear to if `colour` is VK2D_TARGET_OP_CLEAR
+	VK2DTargetOp depth;  ///< What happens to the target's depth, texture targets never keep depth between passes so VK2D_TARGET_OP_LOAD clears it for them
+	bool discardDepth;   ///< If true depth is thrown away once the pass is over, only matters for the screen since texture target depth is always discarded
 };
 
 /// \brief Represents the data you need for each element in an instanced draw
@@ -361,9 +446,51 @@ struct VK2DComputePushBuffer {
 /// \brief Info for the shadow environment to keep track of
 struct VK2DShadowObjectInfo {
     bool enabled;       ///< Whether or not this object is enabled
-    int startingVertex; ///< Vertex in the master VBO to start from for this object
-    int vertexCount;    ///< Number of vertices for this model
+    int startingEdge;   ///< Edge in the environment's edge list this object starts from
+    int edgeCount;      ///< Number of edges in this object
     mat4 model;         ///< Model for this shadow object
+    vec4 localBounds;   ///< Left, top, right, and bottom of this object's edges before the model is applied
+    vec4 bounds;        ///< Left, top, right, and bottom of this object in the game world
+    int cells[4];       ///< Left, top, right, and bottom grid cell this object is in
+    bool inGrid;        ///< Whether or not this object is in the environment's grid
+    bool large;         ///< Whether this object is in the list for objects covering too many cells instead
+    uint32_t queryId;   ///< Last grid query that found this object, so it is only returned once per query
+};
+
+/// \brief A light to draw shadows for, see vk2dRendererDrawShadowLights
+struct VK2DShadowLight {
+    vec2 position; ///< Position of the light in the game world
+    float radius;  ///< Edges further than this from the light cast no shadows and shadows stop this far from it, 0 for no limit
+    vec4 colour;   ///< Colour of this light's shadows
+};
+
+/// \brief Counters for everything the renderer did in a frame, see vk2dRendererGetFrameStats
+struct VK2DFrameStats {
+    uint32_t drawCalls;                                ///< Number of draw commands recorded
+    uint32_t pipelineBinds;                            ///< Number of pipelines bound, graphics and compute
+    uint32_t descriptorSetBinds;                       ///< Number of vkCmdBindDescriptorSets calls
+    uint32_t spriteFlushes[VK2D_FLUSH_REASON_MAX];     ///< Number of sprite batch flushes, indexed by VK2DFlushReason
+    uint32_t spritesSubmitted;                         ///< Number of sprites drawn through the sprite batch
+    uint32_t descriptorSetsAllocated;                  ///< Number of descriptor sets allocated
+    uint64_t descriptorBufferBytes;                    ///< Bytes copied into the descriptor buffer
+    uint32_t renderPassBegins;                         ///< Number of render passes started
+};
+
+/// \brief Distribution of frame times over a number of frames, see vk2dRendererGetFrameTimeStats
+struct VK2DFrameTimeStats {
+    uint32_t frames; ///< Number of frames these numbers were calculated from, 0 if none were available
+    double mean;     ///< Mean frame time in milliseconds
+    double p50;      ///< Median frame time in milliseconds
+    double p95;      ///< 95th percentile frame time in milliseconds
+    double p99;      ///< 99th percentile frame time in milliseconds
+    double max;      ///< Longest frame time in milliseconds
+};
+
+/// \brief Time the GPU spent in a profiler scope, see vk2dRendererGetGPUTimings
+struct VK2DGPUTiming {
+    const char *name; ///< Name given to the scope
+    uint32_t depth;   ///< Number of scopes this one is nested inside of
+    double ms;        ///< Milliseconds between the start and end of the scope on the GPU
 };
 
 /// \brief Information needed to queue an asset loading off-thread
@@ -450,9 +577,14 @@ VK2D_USER_STRUCT(VK2DDrawInstance)
 VK2D_USER_STRUCT(VK2DDrawCommand)
 VK2D_USER_STRUCT(VK2DAssetLoad)
 VK2D_USER_STRUCT(VK2DShadowObjectInfo)
+VK2D_USER_STRUCT(VK2DShadowLight)
+VK2D_USER_STRUCT(VK2DGPUTiming)
+VK2D_USER_STRUCT(VK2DFrameStats)
+VK2D_USER_STRUCT(VK2DFrameTimeStats)
 VK2D_USER_STRUCT(VK2DInstancedPushBuffer)
 VK2D_USER_STRUCT(VK2DComputePushBuffer)
 VK2D_USER_STRUCT(VK2DLogger)
+VK2D_USER_STRUCT(VK2DTargetOps)
 
 #ifdef __cplusplus
 }
@@ -56,6 +56,16 @@ bool vk2dTextureIsTarget(VK2DTexture tex);
 /// \return Returns the texture's image
 VK2DImage vk2dTextureGetImage(VK2DTexture tex);
 
+/// \brief Copies a texture's pixels back from VRAM
+/// \param tex Texture to read, either a target or a texture loaded from an image
+/// \param pixels Buffer of at least width * height * 4 bytes that will be filled with RGBA8 pixels, row by row
+/// \return Returns true if the pixels were read
+///
+/// This waits for the GPU to finish everything submitted so far, so it's meant for tests, screenshots,
+/// and headless rendering rather than every frame. It may not be called between vk2dRendererStartFrame
+/// and vk2dRendererEndFrame.
+bool vk2dTextureRead(VK2DTexture tex, void *pixels);
+
 /// \brief Returns a unique ID for this texture
 /// \param tex Texture to get the id of
 /// \return Returns a unique uint32_t ID for this texture, used for sprite batching/user shaders
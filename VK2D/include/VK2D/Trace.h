@@ -0,0 +1,49 @@
+/// \file Trace.h
+/// \author Paolo Mazzon
+/// \brief Compile-time optional CPU trace zones for renderer internals
+///
+/// Tracing is compiled out unless VK2D_ENABLE_TRACING is defined (the CMake option of the
+/// same name does this). By default zones are collected in memory and can be written out
+/// with vk2dRendererWriteTrace as a Chrome `trace_event` JSON file, which can be opened in
+/// chrome://tracing or Perfetto. If VK2D_TRACY is also defined the zones are forwarded to
+/// the Tracy client instead.
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(VK2D_ENABLE_TRACING) && defined(VK2D_TRACY)
+#include <tracy/TracyC.h>
+#define VK2D_TRACE_BEGIN(zone, name) TracyCZoneN(zone, name, 1)
+#define VK2D_TRACE_END(zone) TracyCZoneEnd(zone)
+#elif defined(VK2D_ENABLE_TRACING)
+#define VK2D_TRACE_BEGIN(zone, name) const VK2DTraceZone zone = _vk2dTraceBegin(name)
+#define VK2D_TRACE_END(zone) _vk2dTraceEnd(zone)
+#else
+#define VK2D_TRACE_BEGIN(zone, name) ((void)0)
+#define VK2D_TRACE_END(zone) ((void)0)
+#endif
+
+/// \brief A zone that has been started but not yet ended
+typedef struct VK2DTraceZone {
+    const char *name; ///< Name of the zone, must be a string literal
+    uint64_t start;   ///< Performance counter value at the start of the zone
+} VK2DTraceZone;
+
+/// \brief Sets up the trace event buffer, must be called before any other thread may record zones
+void _vk2dTraceInit();
+
+/// \brief Frees the trace event buffer
+void _vk2dTraceQuit();
+
+/// \brief Starts a zone, use VK2D_TRACE_BEGIN instead of calling this directly
+VK2DTraceZone _vk2dTraceBegin(const char *name);
+
+/// \brief Ends a zone and records it, use VK2D_TRACE_END instead of calling this directly
+void _vk2dTraceEnd(VK2DTraceZone zone);
+
+#ifdef __cplusplus
+}
+#endif
@@ -42,5 +42,20 @@ int _vk2dWorkerThread(void *data);
 /// \brief The internal texture creation function
 VK2DTexture _vk2dTextureFromInternal(const void *data, int size, bool mainThread);
 
+/// \brief Remembers where a texture came from so it can be reloaded after eviction, data is copied
+void _vk2dTextureKeepSource(VK2DTexture tex, const char *filename, const void *data, int size);
+
+/// \brief Whether or not a texture can be evicted from VRAM and reloaded later
+bool _vk2dTextureIsReloadable(VK2DTexture tex);
+
+/// \brief Frees a reloadable texture's image from VRAM, returning the number of bytes freed
+VkDeviceSize _vk2dTextureEvict(VK2DTexture tex);
+
+/// \brief Decodes and uploads an evicted texture's source file or data, returning NULL if it can't be decoded
+VK2DImage _vk2dTextureReloadImage(const char *sourceFile, const void *sourceData, int sourceSize, bool mainThread);
+
+/// \brief Moves a reloaded image into an evicted texture, only safe once no frame in flight draws the texture
+void _vk2dTextureRestore(VK2DTexture tex, VK2DImage image);
+
 /// \brief The internal model creation function
 VK2DModel _vk2dModelFromInternal(const void *objFile, uint32_t objFileSize, VK2DTexture texture, bool mainThread);
\ No newline at end of file
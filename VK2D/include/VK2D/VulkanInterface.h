@@ -24,6 +24,7 @@ void vk2dVulkanSubmitSingleUseBuffer(VkCommandBuffer buffer);
 /// \warning The draw buffer is guaranteed to be in a render pass but there is no guarantee on which one
 /// \note Each frame contains three command buffers: Copy, compute and draw. Their execution starts in that order
 /// with automatic barriers on important resources.
+/// \note With `enableFrameGraph` on this is a secondary command buffer for the current target's pass
 VkCommandBuffer vk2dVulkanGetDrawBuffer();
 
 /// \brief Returns the command buffer being used for compute commands. You may use this buffer for whatever.
@@ -31,6 +32,7 @@ VkCommandBuffer vk2dVulkanGetDrawBuffer();
 /// \warning This is only valid until the next time another VK2D function is called
 /// \note Each frame contains three command buffers: Copy, compute and draw. Their execution starts in that order
 /// with automatic barriers on important resources.
+/// \warning If `enableAsyncCompute` is on this buffer may be submitted to a compute-only queue
 VkCommandBuffer vk2dVulkanGetComputeBuffer();
 
 /// \brief Returns the command buffer being used for copy commands
@@ -38,6 +40,7 @@ VkCommandBuffer vk2dVulkanGetComputeBuffer();
 /// \warning This is only valid until the next time another VK2D function is called
 /// \note Each frame contains three command buffers: Copy, compute and draw. Their execution starts in that order
 /// with automatic barriers on important resources.
+/// \warning If `enableAsyncCompute` is on this buffer may be submitted to a compute-only queue
 VkCommandBuffer vk2dVulkanGetCopyBuffer();
 
 /// \brief Copies arbitrary data into a device-local buffer that can then be accessed from command buffers
@@ -78,8 +81,8 @@ uint32_t vk2dVulkanGetQueueFamily();
 /// \return Returns the swapchain image count
 uint32_t vk2dVulkanGetSwapchainImageCount();
 
-/// \brief Returns the maximum number of frames in flight allowed at once
-/// \return Returns the maximum number of frames in flight allowed at once
+/// \brief Returns the number of frames in flight the renderer was started with
+/// \return Returns the number of frames in flight allowed at once, see the startup option framesInFlight
 uint32_t vk2dVulkanGetMaxFramesInFlight();
 
 /// \brief Returns the VMA instance
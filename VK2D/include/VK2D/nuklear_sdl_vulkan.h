@@ -19,27 +19,34 @@
 #include <string.h>
 #include <SDL3/SDL.h>
 
-enum nk_sdl_init_state { NK_SDL_DEFAULT = 0 };
-
 NK_API struct nk_context *nk_sdl_init(SDL_Window *win, VkDevice logical_device,
-                                      VkPhysicalDevice physical_device, uint32_t graphics_queue_family_index,
-                                      VkImageView *image_views, uint32_t image_views_len, VkFormat color_format,
-                                      enum nk_sdl_init_state init_state, VkDeviceSize max_vertex_buffer,
-                                      VkDeviceSize max_element_buffer);
+                                      VkRenderPass render_pass, VkSampleCountFlagBits samples,
+                                      VkFormat color_format, VkFormat depth_format,
+                                      uint32_t frames_in_flight,
+                                      VkDescriptorSetLayout sampler_layout,
+                                      VkDescriptorSetLayout texture_layout);
 NK_API void nk_sdl_shutdown(void);
 NK_API void nk_sdl_font_stash_begin(struct nk_font_atlas **atlas);
-NK_API void nk_sdl_font_stash_end(VkQueue graphics_queue);
+NK_API const void *nk_sdl_font_stash_bake(int *width, int *height);
+NK_API void nk_sdl_font_stash_end(uint32_t font_texture_index);
 NK_API int nk_sdl_handle_event(SDL_Event *evt);
-NK_API VkSemaphore nk_sdl_render(VkQueue graphics_queue, uint32_t buffer_index,
-        VkSemaphore wait_semaphore, enum nk_anti_aliasing AA);
-NK_API void nk_sdl_resize(VkImageView *imageViews, uint32_t imageViewCount, uint32_t framebuffer_width,
-                          uint32_t framebuffer_height);
+NK_API void nk_sdl_convert(enum nk_anti_aliasing AA, const void **vertices,
+                           nk_size *vertices_size, const void **elements,
+                           nk_size *elements_size, float projection[16]);
+NK_API uint32_t nk_sdl_render(VkCommandBuffer command_buffer, uint32_t frame,
+                              VkBuffer vertex_buffer, VkDeviceSize vertex_offset,
+                              VkBuffer index_buffer, VkDeviceSize index_offset,
+                              VkBuffer uniform_buffer, VkDeviceSize uniform_offset,
+                              VkDescriptorSet sampler_set, VkDescriptorSet texture_set,
+                              void (*use_texture)(uint32_t texture_index));
+NK_API void nk_sdl_resize(VkRenderPass render_pass, VkSampleCountFlagBits samples,
+                          uint32_t framebuffer_width, uint32_t framebuffer_height);
 NK_API void nk_sdl_device_destroy(void);
-NK_API void nk_sdl_device_create(VkDevice logical_device,
-                                 VkPhysicalDevice physical_device, uint32_t graphics_queue_family_index,
-                                 VkImageView *image_views, uint32_t image_views_len, VkFormat color_format,
-                                 VkDeviceSize max_vertex_buffer, VkDeviceSize max_element_buffer,
-                                 uint32_t framebuffer_width, uint32_t framebuffer_height);
+NK_API void nk_sdl_device_create(VkDevice logical_device, VkRenderPass render_pass,
+                                 VkSampleCountFlagBits samples, VkFormat color_format,
+                                 VkFormat depth_format, uint32_t frames_in_flight,
+                                 VkDescriptorSetLayout sampler_layout,
+                                 VkDescriptorSetLayout texture_layout);
 NK_API void nk_sdl_handle_grab(void);
 
 #endif
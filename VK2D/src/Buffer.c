@@ -6,6 +6,7 @@
 #include "VK2D/Initializers.h"
 #include <malloc.h>
 #include "VK2D/Renderer.h"
+#include "VK2D/RendererMeta.h"
 #include "VK2D/Opaque.h"
 
 VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags mem) {
@@ -19,7 +20,8 @@ VK2DBuffer vk2dBufferCreate(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUs
 		buf->dev = dev;
 		buf->size = size;
 		buf->offset = 0;
-		VkBufferCreateInfo bufferCreateInfo = vk2dInitBufferCreateInfo(size, usage, &dev->pd->QueueFamily.graphicsFamily, 1);
+		buf->usage = usage;
+		VkBufferCreateInfo bufferCreateInfo = vk2dInitBufferCreateInfo(size, usage, dev->queueFamilies, dev->queueFamilyCount);
 		VmaAllocationCreateInfo allocationCreateInfo = {0};
 		allocationCreateInfo.requiredFlags = mem;
 		VkResult result = vmaCreateBuffer(gRenderer->vma, &bufferCreateInfo, &allocationCreateInfo, &buf->buf, &buf->mem, VK_NULL_HANDLE);
@@ -67,10 +69,14 @@ VK2DBuffer vk2dBufferLoad(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsag
 	// Create the actual vbo
 	VK2DBuffer ret = vk2dBufferCreate(dev,
 			size,
-			usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	if (ret != NULL)
+	if (ret != NULL) {
 	    vk2dBufferCopy(stageBuffer, ret, mainThread);
+
+	    // Buffers with static contents may be moved around by vk2dRendererDefragment
+	    vmaSetAllocationUserData(gRenderer->vma, ret->mem, ret);
+	}
 	vk2dBufferFree(stageBuffer);
 
 	return ret;
@@ -105,10 +111,12 @@ VK2DBuffer vk2dBufferLoad2(VK2DLogicalDevice dev, VkDeviceSize size, VkBufferUsa
 	// Create the buffer
 	VK2DBuffer ret = vk2dBufferCreate(dev,
 									  size + size2,
-									  usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 									  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    if (ret != NULL)
+    if (ret != NULL) {
 	    vk2dBufferCopy(stageBuffer, ret, mainThread);
+	    vmaSetAllocationUserData(gRenderer->vma, ret->mem, ret);
+	}
 
 	vk2dBufferFree(stageBuffer);
 
@@ -134,6 +142,7 @@ void vk2dBufferFree(VK2DBuffer buf) {
     if (gRenderer == NULL || vk2dStatusFatal())
         return;
 	if (buf != NULL) {
+		_vk2dRendererDefragmentRelease(buf->mem);
 		vmaDestroyBuffer(gRenderer->vma, buf->buf, buf->mem);
 		free(buf);
 	}
@@ -9,6 +9,7 @@
 
 void _vk2dCameraUpdateUBO(VK2DUniformBufferObject *ubo, VK2DCameraSpec *camera);
 void _vk2dRendererFlushUBOBuffer(uint32_t frame, int camera);
+void _vk2dRendererFlushSpriteBatch(VK2DFlushReason reason);
 VK2DCameraIndex vk2dCameraCreate(VK2DCameraSpec spec) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (gRenderer == NULL) {
@@ -66,7 +67,7 @@ void vk2dCameraSetState(VK2DCameraIndex index, VK2DCameraState state) {
 	    return;
 	}
 
-    vk2dRendererFlushSpriteBatch();
+    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_CAMERA_CHANGE);
     gRenderer->cameras[index].state = state;
 }
 
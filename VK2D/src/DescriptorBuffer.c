@@ -9,6 +9,7 @@
 #include "VK2D/Initializers.h"
 #include "VK2D/PhysicalDevice.h"
 #include "VK2D/Opaque.h"
+#include "VK2D/Trace.h"
 
 static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferAppendBuffer(VK2DDescriptorBuffer db) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
@@ -41,7 +42,7 @@ static _VK2DDescriptorBufferInternal *_vk2dDescriptorBufferAppendBuffer(VK2DDesc
 	buffer->deviceBuffer = vk2dBufferCreate(
 			db->dev,
 			db->pageSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
 	if (buffer->stageBuffer == NULL || buffer->deviceBuffer == NULL) {
@@ -115,6 +116,8 @@ void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceS
         return;
 
     if (size < db->pageSize) {
+        VK2D_TRACE_BEGIN(zone, "vk2dDescriptorBufferCopyData");
+
         // Find a buffer with enough space
         _VK2DDescriptorBufferInternal *spot = NULL;
         for (int i = 0; i < db->bufferCount && spot == NULL; i++) {
@@ -131,9 +134,11 @@ void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceS
                 VkResult result = vmaMapMemory(gRenderer->vma, spot->stageBuffer->mem, &spot->hostData);
                 if (result != VK_SUCCESS) {
                     vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
+                    VK2D_TRACE_END(zone);
                     return;
                 }
             } else {
+                VK2D_TRACE_END(zone);
                 return;
             }
         }
@@ -141,6 +146,7 @@ void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceS
         // Copy data over
         uint8_t *np = spot->hostData;
         memcpy(np + spot->size, data, size);
+        gRenderer->frameStats.descriptorBufferBytes += size;
         *outBuffer = spot->deviceBuffer->buf;
         *offset = spot->size;
 
@@ -151,6 +157,7 @@ void vk2dDescriptorBufferCopyData(VK2DDescriptorBuffer db, void *data, VkDeviceS
         } else {
             spot->size += size;
         }
+        VK2D_TRACE_END(zone);
     }
 }
 
@@ -227,8 +234,8 @@ void vk2dDescriptorBufferRecordCopyPipelineBarrier(VK2DDescriptorBuffer db, VkCo
             db->memoryBarriers[i].pNext = VK_NULL_HANDLE;
             db->memoryBarriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
             db->memoryBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-            db->memoryBarriers[i].srcQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
-            db->memoryBarriers[i].dstQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
+            db->memoryBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            db->memoryBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
             db->memoryBarriers[i].buffer = db->buffers[i].deviceBuffer->buf;
             db->memoryBarriers[i].offset = 0;
             db->memoryBarriers[i].size = db->buffers[i].size;
@@ -262,9 +269,9 @@ void vk2dDescriptorBufferRecordComputePipelineBarrier(VK2DDescriptorBuffer db, V
             db->memoryBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
             db->memoryBarriers[i].pNext = VK_NULL_HANDLE;
             db->memoryBarriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-            db->memoryBarriers[i].dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-            db->memoryBarriers[i].srcQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
-            db->memoryBarriers[i].dstQueueFamilyIndex = gRenderer->pd->QueueFamily.graphicsFamily;
+            db->memoryBarriers[i].dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            db->memoryBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            db->memoryBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
             db->memoryBarriers[i].buffer = db->buffers[i].deviceBuffer->buf;
             db->memoryBarriers[i].offset = 0;
             db->memoryBarriers[i].size = db->buffers[i].size;
@@ -277,7 +284,7 @@ void vk2dDescriptorBufferRecordComputePipelineBarrier(VK2DDescriptorBuffer db, V
     vkCmdPipelineBarrier(
             buf,
             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
             0,
             0,
             VK_NULL_HANDLE,
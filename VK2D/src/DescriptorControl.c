@@ -8,7 +8,9 @@
 #include "VK2D/Validation.h"
 #include "VK2D/Initializers.h"
 #include "VK2D/LogicalDevice.h"
+#include "VK2D/Renderer.h"
 #include "VK2D/Opaque.h"
+#include "VK2D/Trace.h"
 #include <malloc.h>
 
 // Places another descriptor pool at the end of a given desc con's list, extending the list if need be
@@ -60,6 +62,7 @@ VkDescriptorSet _vk2dDescConGetAvailableSet(VK2DDescCon descCon) {
 	uint32_t i = 0;
 	VkResult res;
 	VkDescriptorSetAllocateInfo allocInfo = vk2dInitDescriptorSetAllocateInfo(VK_NULL_HANDLE, 1, &descCon->layout);
+	VK2D_TRACE_BEGIN(zone, "_vk2dDescConGetAvailableSet");
 
 	while (set == VK_NULL_HANDLE) {
 		allocInfo.descriptorPool = descCon->pools[i];
@@ -75,6 +78,9 @@ VkDescriptorSet _vk2dDescConGetAvailableSet(VK2DDescCon descCon) {
 			_vk2dDescConAppendList(descCon);
 	}
 
+	if (set != VK_NULL_HANDLE)
+		vk2dRendererGetPointer()->frameStats.descriptorSetsAllocated++;
+	VK2D_TRACE_END(zone);
 	return set;
 }
 
@@ -10,6 +10,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "VK2D/stb_image.h"
 #include "VK2D/Renderer.h"
+#include "VK2D/RendererMeta.h"
 #include <malloc.h>
 
 #include <vk_mem_alloc.h>
@@ -131,6 +132,8 @@ VK2DImage vk2dImageCreate(VK2DLogicalDevice dev, uint32_t width, uint32_t height
 		out->width = width;
 		out->height = height;
 		out->set = VK_NULL_HANDLE;
+		out->format = format;
+		out->usage = usage;
 		VkImageCreateInfo imageCreateInfo = vk2dInitImageCreateInfo(width, height, format, usage, 1, samples);
 		VmaAllocationCreateInfo allocationCreateInfo = {0};
 		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -182,7 +185,7 @@ VK2DImage vk2dImageLoad(VK2DLogicalDevice dev, const char *filename) {
             stbi_image_free(pixels);
 
             out = vk2dImageCreate(dev, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT,
-                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
+                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
 
 
             if (out != NULL) {
@@ -218,7 +221,7 @@ VK2DImage vk2dImageFromPixels(VK2DLogicalDevice dev, const void *pixels, int w,
                 vmaUnmapMemory(gRenderer->vma, stage->mem);
 
                 out = vk2dImageCreate(dev, w, h, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT,
-                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
+                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
 
 
                 if (out != NULL) {
@@ -242,6 +245,7 @@ VK2DImage vk2dImageFromPixels(VK2DLogicalDevice dev, const void *pixels, int w,
 void vk2dImageFree(VK2DImage img) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (img != NULL) {
+		_vk2dRendererDefragmentRelease(img->mem);
 		vkDestroyImageView(img->dev->dev, img->view, VK_NULL_HANDLE);
 		vmaDestroyImage(gRenderer->vma, img->img, img->mem);
 		free(img);
@@ -397,7 +397,7 @@ VkBufferCreateInfo vk2dInitBufferCreateInfo(VkDeviceSize size, VkBufferUsageFlag
 	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferCreateInfo.pQueueFamilyIndices = queueFamilies;
 	bufferCreateInfo.queueFamilyIndexCount = queueFamilyCount;
-	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	bufferCreateInfo.sharingMode = queueFamilyCount > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
 	bufferCreateInfo.usage = usage;
 	bufferCreateInfo.size = size;
 	return bufferCreateInfo;
@@ -13,6 +13,9 @@
 
 #define MAX_SEVERITY_LABEL_LENGTH (sizeof("unknown") - 1)
 #define MAX_TIME_STRING_SIZE 26
+#define LOG_QUEUE_SIZE 256 // must be a power of two
+#define LOG_MESSAGE_SIZE 512 // longer messages are truncated in the queue
+#define LOG_WRITER_TIMEOUT 100 // ms the writer sleeps if nothing signals it
 
 #define COERCE_SEVERITY(SEVERITY)                                              \
 	do {                                                                   \
@@ -25,9 +28,32 @@ typedef struct VK2DDefaultLogger {
     SDL_Mutex *mutex;
     FILE *errorOutput;
     FILE *standardOutput;
-    VK2DLogSeverity severity;
+    SDL_AtomicInt severity;
 } VK2DDefaultLogger;
 
+// A single message waiting to be written by the writer thread
+typedef struct VK2DLogEntry {
+    SDL_AtomicU32 sequence; // slot state, see logQueuePush/logQueuePop
+    VK2DLogSeverity severity;
+    SDL_Time time;
+    char msg[LOG_MESSAGE_SIZE];
+} VK2DLogEntry;
+
+// Bounded multi-producer/single-consumer ring of messages for the default
+// logger. Producers claim slots with a CAS on head and never block, if the
+// ring is full the message is dropped and counted instead. The consumer side
+// is serialized by the default logger's mutex so fatal messages can drain it
+// from the logging thread.
+typedef struct VK2DLogQueue {
+    VK2DLogEntry entries[LOG_QUEUE_SIZE];
+    SDL_AtomicU32 head;    // next slot a producer will claim
+    uint32_t tail;         // next slot to be written, only touched under the mutex
+    SDL_AtomicInt dropped; // messages dropped since the last drain
+    SDL_AtomicInt running; // whether the writer thread is alive
+    SDL_Semaphore *signal;
+    SDL_Thread *thread;
+} VK2DLogQueue;
+
 static VK2DLogger *gLogger;
 static SDL_Mutex *gLoggerMutex;
 static bool gInitialized = false;
@@ -44,11 +70,16 @@ static VK2DDefaultLogger gDefaultLogger = {
         .mutex = NULL,
         .errorOutput = NULL,
         .standardOutput = NULL,
-        .severity = VK2D_LOG_SEVERITY_INFO,
+        .severity = {VK2D_LOG_SEVERITY_INFO},
 };
+static VK2DLogQueue gLogQueue;
+
+static VK2DLogger *currentLogger() {
+    return SDL_GetAtomicPointer((void **)&gLogger);
+}
 
 static bool usingDefaultLogger() {
-    return gLogger == (VK2DLogger *)&gDefaultLogger;
+    return currentLogger() == (VK2DLogger *)&gDefaultLogger;
 }
 
 // We use arrays in some places for severity data, this should be called on any
@@ -100,34 +131,35 @@ static FILE * defaultLogOutput(const VK2DDefaultLogger *log, const VK2DLogSeveri
 }
 
 static VK2DLogSeverity defaultSeverity(void *ptr) {
-    const VK2DDefaultLogger *log = ptr;
-    SDL_LockMutex(log->mutex);
-    const VK2DLogSeverity severity = log->severity;
-    SDL_UnlockMutex(log->mutex);
-    return severity;
+    VK2DDefaultLogger *log = ptr;
+    return (VK2DLogSeverity)SDL_GetAtomicInt(&log->severity);
 }
 
+// Called on every log call so it avoids locks entirely, the default logger's
+// severity is read straight from its atomic
 static bool shouldLog(const VK2DLogSeverity severity) {
     if (severity == VK2D_LOG_SEVERITY_UNKNOWN
         || severity == VK2D_LOG_SEVERITY_FATAL)
         return true;
-    SDL_LockMutex(gLoggerMutex);
-    if (gLogger->severityFn == NULL) return true;
-    const VK2DLogSeverity current = gLogger->severityFn(gLogger->context);
-    SDL_UnlockMutex(gLoggerMutex);
+    VK2DLogger *logger = currentLogger();
+    VK2DLogSeverity current;
+    if (logger == (VK2DLogger *)&gDefaultLogger)
+        current = defaultSeverity(&gDefaultLogger);
+    else if (logger->severityFn == NULL)
+        return true;
+    else
+        current = logger->severityFn(logger->context);
     return severity >= current;
 }
 
-static void writeTimeString(char *buf) {
+static void writeTimeString(char *buf, SDL_Time time) {
     static const char *WEEK_DAYS[]
             = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
     static const char *MONTHS[] = { "Jan", "Feb", "Mar", "Apr", "May",
                                     "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
-    SDL_Time time;
     SDL_DateTime dt;
 
-    if (!SDL_GetCurrentTime(&time)
-        || !SDL_TimeToDateTime(time, &dt, true)) {
+    if (time == 0 || !SDL_TimeToDateTime(time, &dt, true)) {
         memset(buf, '-', MAX_TIME_STRING_SIZE);
         return;
     }
@@ -139,18 +171,17 @@ static void writeTimeString(char *buf) {
 
 static void destroyLogger(const bool lock) {
     if (lock) SDL_LockMutex(gLoggerMutex);
-    if (gLogger != NULL) {
-        if (gLogger->destroy != NULL)
-            gLogger->destroy(gLogger->context);
-        gLogger = NULL;
+    VK2DLogger *logger = currentLogger();
+    if (logger != NULL) {
+        if (logger->destroy != NULL)
+            logger->destroy(logger->context);
+        SDL_SetAtomicPointer((void **)&gLogger, NULL);
     }
     if (lock) SDL_UnlockMutex(gLoggerMutex);
 }
 
-static void defaultLog(void *ptr, VK2DLogSeverity severity, const char *msg) {
-    const VK2DDefaultLogger *log = (VK2DDefaultLogger *)ptr;
-    assert(usingDefaultLogger());
-    COERCE_SEVERITY(severity);
+// Writes a single formatted line, the default logger's mutex must be held
+static void writeLogLine(const VK2DDefaultLogger *log, VK2DLogSeverity severity, SDL_Time time, const char *msg) {
     FILE *out = defaultLogOutput(log, severity);
     size_t labelLength = 0;
     const char *label = severityLabel(severity, &labelLength);
@@ -159,23 +190,147 @@ static void defaultLog(void *ptr, VK2DLogSeverity severity, const char *msg) {
     const size_t paddingLength = MAX_SEVERITY_LABEL_LENGTH - labelLength;
     for (int i = 0; i < paddingLength; i++) { padding[i] = ' '; }
     padding[paddingLength] = '\0';
-    writeTimeString(timeString);
+    writeTimeString(timeString, time);
     // asctime() adds an extra \n at the end
     timeString[MAX_TIME_STRING_SIZE - 2] = '\0';
-    if (vk2dRendererHasStdoutLogging()) {
+    if (out != NULL)
         fprintf(out, "[%s] [%s]%s %s\n", timeString, label, padding, msg);
-        fflush(out);
+}
+
+static SDL_Time currentTime() {
+    SDL_Time time;
+    if (!SDL_GetCurrentTime(&time)) return 0;
+    return time;
+}
+
+// Copies a message into the ring without blocking, returns false if the ring
+// is full (the message is dropped)
+static bool logQueuePush(VK2DLogSeverity severity, const char *msg) {
+    VK2DLogQueue *q = &gLogQueue;
+    uint32_t pos = SDL_GetAtomicU32(&q->head);
+    VK2DLogEntry *entry;
+    while (true) {
+        entry = &q->entries[pos & (LOG_QUEUE_SIZE - 1)];
+        const int32_t diff = (int32_t)(SDL_GetAtomicU32(&entry->sequence) - pos);
+        if (diff == 0) {
+            if (SDL_CompareAndSwapAtomicU32(&q->head, pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            // The writer hasn't released this slot yet, the ring is full
+            SDL_AddAtomicInt(&q->dropped, 1);
+            return false;
+        }
+        pos = SDL_GetAtomicU32(&q->head);
+    }
+    entry->severity = severity;
+    entry->time = currentTime();
+    SDL_strlcpy(entry->msg, msg, LOG_MESSAGE_SIZE);
+    SDL_SetAtomicU32(&entry->sequence, pos + 1); // publish to the writer
+    SDL_SignalSemaphore(q->signal);
+    return true;
+}
+
+// Writes out everything currently in the ring, the default logger's mutex must be held
+static void logQueueDrain(const VK2DDefaultLogger *log) {
+    VK2DLogQueue *q = &gLogQueue;
+    const int dropped = SDL_SetAtomicInt(&q->dropped, 0);
+    if (dropped > 0) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "%i log messages dropped, log queue was full", dropped);
+        writeLogLine(log, VK2D_LOG_SEVERITY_WARN, currentTime(), msg);
+    }
+
+    bool wrote = dropped > 0;
+    while (true) {
+        VK2DLogEntry *entry = &q->entries[q->tail & (LOG_QUEUE_SIZE - 1)];
+        if ((int32_t)(SDL_GetAtomicU32(&entry->sequence) - (q->tail + 1)) < 0)
+            break; // nothing published here yet
+        writeLogLine(log, entry->severity, entry->time, entry->msg);
+        SDL_SetAtomicU32(&entry->sequence, q->tail + LOG_QUEUE_SIZE); // hand the slot back to producers
+        q->tail++;
+        wrote = true;
+    }
+
+    if (wrote) {
+        if (log->standardOutput != NULL) fflush(log->standardOutput);
+        if (log->errorOutput != NULL) fflush(log->errorOutput);
+    }
+}
+
+static int logWriterThread(void *data) {
+    VK2DDefaultLogger *log = data;
+    while (SDL_GetAtomicInt(&gLogQueue.running)) {
+        SDL_WaitSemaphoreTimeout(gLogQueue.signal, LOG_WRITER_TIMEOUT);
+        SDL_LockMutex(log->mutex);
+        logQueueDrain(log);
+        SDL_UnlockMutex(log->mutex);
+    }
+    return 0;
+}
+
+static void defaultLog(void *ptr, VK2DLogSeverity severity, const char *msg) {
+    VK2DDefaultLogger *log = (VK2DDefaultLogger *)ptr;
+    assert(usingDefaultLogger());
+    COERCE_SEVERITY(severity);
+    if (!vk2dRendererHasStdoutLogging()) {
+        if (severity == VK2D_LOG_SEVERITY_FATAL) abort();
+        return;
+    }
+
+    // Fatal messages and anything logged without a writer thread are written
+    // synchronously, after whatever is still queued so ordering is kept
+    if (severity == VK2D_LOG_SEVERITY_FATAL || !SDL_GetAtomicInt(&gLogQueue.running)) {
+        SDL_LockMutex(log->mutex);
+        logQueueDrain(log);
+        writeLogLine(log, severity, currentTime(), msg);
+        FILE *out = defaultLogOutput(log, severity);
+        if (out != NULL) fflush(out);
+        SDL_UnlockMutex(log->mutex);
+    } else {
+        logQueuePush(severity, msg);
     }
     if (severity == VK2D_LOG_SEVERITY_FATAL) abort();
 }
 
+static void logWriterStart() {
+    for (uint32_t i = 0; i < LOG_QUEUE_SIZE; i++)
+        SDL_SetAtomicU32(&gLogQueue.entries[i].sequence, i);
+    SDL_SetAtomicU32(&gLogQueue.head, 0);
+    gLogQueue.tail = 0;
+    SDL_SetAtomicInt(&gLogQueue.dropped, 0);
+    gLogQueue.signal = SDL_CreateSemaphore(0);
+    if (gLogQueue.signal == NULL)
+        return;
+    SDL_SetAtomicInt(&gLogQueue.running, 1);
+    gLogQueue.thread = SDL_CreateThread(logWriterThread, "VK2DLogWriter", &gDefaultLogger);
+    if (gLogQueue.thread == NULL) {
+        // Fall back to writing synchronously
+        SDL_SetAtomicInt(&gLogQueue.running, 0);
+        SDL_DestroySemaphore(gLogQueue.signal);
+        gLogQueue.signal = NULL;
+    }
+}
+
+static void logWriterStop() {
+    if (gLogQueue.thread != NULL) {
+        SDL_SetAtomicInt(&gLogQueue.running, 0);
+        SDL_SignalSemaphore(gLogQueue.signal);
+        SDL_WaitThread(gLogQueue.thread, NULL);
+        gLogQueue.thread = NULL;
+    }
+    SDL_LockMutex(gDefaultLogger.mutex);
+    logQueueDrain(&gDefaultLogger);
+    SDL_UnlockMutex(gDefaultLogger.mutex);
+    SDL_DestroySemaphore(gLogQueue.signal);
+    gLogQueue.signal = NULL;
+}
+
 void vk2dSetLogger(VK2DLogger *logger) {
     // this could be called before initialization by an external library
     vk2dLoggerInit();
     SDL_LockMutex(gLoggerMutex);
     destroyLogger(false);
-    if (logger != NULL) gLogger = logger;
-    else gLogger = (VK2DLogger *)&gDefaultLogger;
+    SDL_SetAtomicPointer((void **)&gLogger, logger != NULL ? logger : (VK2DLogger *)&gDefaultLogger);
     SDL_UnlockMutex(gLoggerMutex);
 }
 
@@ -213,7 +368,8 @@ void vk2dLoggerLogv(VK2DLogSeverity severity, const char *fmt, va_list ap) {
 }
 
 void vk2dLoggerLog(const VK2DLogSeverity severity, const char *msg) {
-    gLogger->log(gLogger->context, severity, msg);
+    VK2DLogger *logger = currentLogger();
+    logger->log(logger->context, severity, msg);
     assert(severity != VK2D_LOG_SEVERITY_FATAL);
 #ifdef NDEBUG
     if (severity == VK2D_LOG_SEVERITY_FATAL) abort();
@@ -222,9 +378,10 @@ void vk2dLoggerLog(const VK2DLogSeverity severity, const char *msg) {
 
 void vk2dLoggerDestroy() {
     destroyLogger(true);
+    logWriterStop();
     SDL_DestroyMutex(gLoggerMutex);
     SDL_DestroyMutex(gDefaultLogger.mutex);
-    gLogger = NULL;
+    SDL_SetAtomicPointer((void **)&gLogger, NULL);
     gInitialized = false;
 }
 
@@ -234,7 +391,8 @@ void vk2dLoggerInit() {
     gDefaultLogger.standardOutput = stdout;
     gDefaultLogger.mutex = SDL_CreateMutex();
     gLoggerMutex = SDL_CreateMutex();
-    gLogger = (VK2DLogger *)&gDefaultLogger;
+    SDL_SetAtomicPointer((void **)&gLogger, &gDefaultLogger);
+    logWriterStart();
     gInitialized = true;
 }
 
@@ -251,9 +409,7 @@ void vk2dDefaultLoggerSetErrorOutput(FILE *out) {
 }
 
 void vk2dDefaultLoggerSetSeverity(const VK2DLogSeverity severity) {
-    SDL_LockMutex(gDefaultLogger.mutex);
-    gDefaultLogger.severity = severity;
-    SDL_UnlockMutex(gDefaultLogger.mutex);
+    SDL_SetAtomicInt(&gDefaultLogger.severity, severity);
 }
 
 #define LOG_WRAP_FN(NAME, SEVERITY)                                            \
@@ -26,12 +26,58 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
     vkEnumerateDeviceExtensionProperties(dev->dev, VK_NULL_HANDLE, &extensionCount, props);
     const bool instanceExtensionSupported = gRenderer->limits.supportsVRAMUsage;
     gRenderer->limits.supportsVRAMUsage = false;
+    bool presentIdExtension = false;
+    bool presentWaitExtension = false;
+    bool dynamicRenderingExtension = false;
 	for (int i = 0; i < extensionCount; i++) {
 	    if (strcmp(props[i].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0 && instanceExtensionSupported)
 	        gRenderer->limits.supportsVRAMUsage = true;
+	    if (strcmp(props[i].extensionName, VK_KHR_PRESENT_ID_EXTENSION_NAME) == 0)
+	        presentIdExtension = true;
+	    if (strcmp(props[i].extensionName, VK_KHR_PRESENT_WAIT_EXTENSION_NAME) == 0)
+	        presentWaitExtension = true;
+	    if (strcmp(props[i].extensionName, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) == 0)
+	        dynamicRenderingExtension = true;
 	}
     free(props);
 
+    // Optional features are queried whenever the device has their extensions so the limits report
+    // what the hardware supports, they are only enabled if the startup options ask for them
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR
+    };
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+            .pNext = &presentIdFeatures
+    };
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR
+    };
+    gRenderer->limits.supportsPresentWait = false;
+    gRenderer->limits.supportsDynamicRendering = false;
+    if (graphicsDevice) {
+        VkPhysicalDeviceFeatures2 features2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2
+        };
+        void **queryChain = &features2.pNext;
+        if (presentIdExtension && presentWaitExtension) {
+            *queryChain = &presentWaitFeatures;
+            queryChain = &presentIdFeatures.pNext;
+        }
+        if (dynamicRenderingExtension) {
+            *queryChain = &dynamicRenderingFeatures;
+            queryChain = &dynamicRenderingFeatures.pNext;
+        }
+        if (features2.pNext != NULL)
+            vkGetPhysicalDeviceFeatures2(dev->dev, &features2);
+        presentIdFeatures.pNext = NULL;
+        gRenderer->limits.supportsPresentWait = presentIdExtension && presentWaitExtension &&
+                presentWaitFeatures.presentWait && presentIdFeatures.presentId;
+        gRenderer->limits.supportsDynamicRendering = dynamicRenderingExtension && dynamicRenderingFeatures.dynamicRendering;
+    }
+    const bool enablePresentWait = gRenderer->limits.supportsPresentWait && gRenderer->options.lowLatencyPacing;
+    const bool enableDynamicRendering = gRenderer->limits.supportsDynamicRendering && gRenderer->options.enableDynamicRendering;
+
 	// Find limits
 	if (ldev != NULL) {
 		// Assemble the required features
@@ -70,12 +116,32 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
                 .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE
 		};
 
+		// All GPU work is tracked on timeline semaphores, core in 1.2
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {
+		        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+		        .timelineSemaphore = VK_TRUE
+		};
+		indexingFeatures.pNext = &timelineFeatures;
+
+		// Optional features go on the end of the chain
+		void **featureChain = &timelineFeatures.pNext;
+		if (enablePresentWait) {
+			*featureChain = &presentWaitFeatures;
+			featureChain = &presentIdFeatures.pNext;
+		}
+		if (enableDynamicRendering) {
+			*featureChain = &dynamicRenderingFeatures;
+			featureChain = &dynamicRenderingFeatures.pNext;
+		}
+
 		// Basic device create info
 		float priority[] = {1, 1};
 		VkDeviceQueueCreateInfo queueCreateInfo = vk2dInitDeviceQueueCreateInfo(queueFamily, priority);
 		queueCreateInfo.queueCount = gRenderer->limits.supportsMultiThreadLoading ? 2 : 1;
-		VkDeviceQueueCreateInfo queues[] = {queueCreateInfo};
-		VkDeviceCreateInfo deviceCreateInfo = vk2dInitDeviceCreateInfo(queues, 1, &feats, debug);
+		const bool asyncCompute = graphicsDevice && gRenderer->options.enableAsyncCompute &&
+		        dev->QueueFamily.computeFamily != dev->QueueFamily.graphicsFamily;
+		VkDeviceQueueCreateInfo queues[] = {queueCreateInfo, vk2dInitDeviceQueueCreateInfo(dev->QueueFamily.computeFamily, priority)};
+		VkDeviceCreateInfo deviceCreateInfo = vk2dInitDeviceCreateInfo(queues, asyncCompute ? 2 : 1, &feats, debug);
         deviceCreateInfo.pNext = &indexingFeatures;
 
         // Device layers and extensions
@@ -89,6 +155,13 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
         if (gRenderer->limits.supportsVRAMUsage) {
             deviceExtensions[deviceExtensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
         }
+        if (enablePresentWait) {
+            deviceExtensions[deviceExtensionCount++] = VK_KHR_PRESENT_ID_EXTENSION_NAME;
+            deviceExtensions[deviceExtensionCount++] = VK_KHR_PRESENT_WAIT_EXTENSION_NAME;
+        }
+        if (enableDynamicRendering) {
+            deviceExtensions[deviceExtensionCount++] = VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME;
+        }
         deviceCreateInfo.enabledExtensionCount = deviceExtensionCount;
         deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions;
         deviceCreateInfo.enabledLayerCount = deviceLayerCount;
@@ -106,6 +179,65 @@ VK2DLogicalDevice vk2dLogicalDeviceCreate(VK2DPhysicalDevice dev, bool enableAll
 		if (queueCreateInfo.queueCount == 2)
 			vkGetDeviceQueue(ldev->dev, queueFamily, 1, &ldev->loadQueue);
 
+		// Extension functions aren't exported by the loader, whether they were found is what says
+		// the features are in use since the limits only say what the device supports
+		ldev->waitForPresent = NULL;
+		if (enablePresentWait) {
+			ldev->waitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(ldev->dev, "vkWaitForPresentKHR");
+			if (ldev->waitForPresent != NULL)
+				vk2dLogInfo("Low-latency pacing enabled...");
+		}
+		ldev->beginRendering = NULL;
+		ldev->endRendering = NULL;
+		if (enableDynamicRendering) {
+			ldev->beginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(ldev->dev, "vkCmdBeginRenderingKHR");
+			ldev->endRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(ldev->dev, "vkCmdEndRenderingKHR");
+		}
+		gRenderer->dynamicRendering = ldev->beginRendering != NULL && ldev->endRendering != NULL;
+		if (gRenderer->dynamicRendering)
+			vk2dLogInfo("Dynamic rendering enabled...");
+
+		// Buffers are shared with the async compute queue if there is one
+		ldev->computeQueue = VK_NULL_HANDLE;
+		ldev->computePool = VK_NULL_HANDLE;
+		ldev->queueFamilies[0] = queueFamily;
+		ldev->queueFamilyCount = 1;
+		if (asyncCompute) {
+			VkCommandPoolCreateInfo computePoolCreateInfo = vk2dInitCommandPoolCreateInfo(dev->QueueFamily.computeFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+			if (vkCreateCommandPool(ldev->dev, &computePoolCreateInfo, VK_NULL_HANDLE, &ldev->computePool) == VK_SUCCESS) {
+				vkGetDeviceQueue(ldev->dev, dev->QueueFamily.computeFamily, 0, &ldev->computeQueue);
+				ldev->queueFamilies[1] = dev->QueueFamily.computeFamily;
+				ldev->queueFamilyCount = 2;
+				vk2dLogInfo("Async compute enabled on queue family %i...", dev->QueueFamily.computeFamily);
+			} else {
+				vk2dLogWarn("Failed to create async compute command pool, compute will run on the graphics queue.");
+			}
+		} else if (graphicsDevice && gRenderer->options.enableAsyncCompute) {
+			vk2dLogInfo("Device has no dedicated compute queue, compute will run on the graphics queue.");
+		}
+
+		// Timelines for each queue
+		VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+		        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		        .initialValue = 0
+		};
+		VkSemaphoreCreateInfo timelineCreateInfo = vk2dInitSemaphoreCreateInfo(0);
+		timelineCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		ldev->timelineValue = 0;
+		ldev->loadTimelineValue = 0;
+		ldev->loadTimeline = VK_NULL_HANDLE;
+		result = vkCreateSemaphore(ldev->dev, &timelineCreateInfo, VK_NULL_HANDLE, &ldev->timeline);
+		VkResult result2 = VK_SUCCESS;
+		if (queueCreateInfo.queueCount == 2)
+			result2 = vkCreateSemaphore(ldev->dev, &timelineCreateInfo, VK_NULL_HANDLE, &ldev->loadTimeline);
+		if (result != VK_SUCCESS || result2 != VK_SUCCESS) {
+		    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create timeline semaphores, Vulkan error %i/%i.", result, result2);
+		    vkDestroyDevice(ldev->dev, VK_NULL_HANDLE);
+		    free(ldev);
+		    return NULL;
+		}
+
 		VkCommandPoolCreateInfo commandPoolCreateInfo = vk2dInitCommandPoolCreateInfo(queueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 		result = vkCreateCommandPool(ldev->dev, &commandPoolCreateInfo, VK_NULL_HANDLE, &ldev->pool);
         if (result != VK_SUCCESS) {
@@ -157,6 +289,9 @@ void vk2dLogicalDeviceFree(VK2DLogicalDevice dev) {
 			vkDestroyCommandPool(dev->dev, dev->loadPool, VK_NULL_HANDLE);
 		}
 		vkDestroyCommandPool(dev->dev, dev->pool, VK_NULL_HANDLE);
+		vkDestroyCommandPool(dev->dev, dev->computePool, VK_NULL_HANDLE);
+		vkDestroySemaphore(dev->dev, dev->timeline, VK_NULL_HANDLE);
+		vkDestroySemaphore(dev->dev, dev->loadTimeline, VK_NULL_HANDLE);
 		vkDestroyDevice(dev->dev, VK_NULL_HANDLE);
 		free(dev);
 	}
@@ -211,35 +346,53 @@ VkCommandBuffer vk2dLogicalDeviceGetSingleUseBuffer(VK2DLogicalDevice dev, bool
 }
 
 void vk2dLogicalDeviceSubmitSingleBuffer(VK2DLogicalDevice dev, VkCommandBuffer buffer, bool mainThread) {
-	VkSubmitInfo submitInfo = vk2dInitSubmitInfo(&buffer, 1, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+	const uint64_t value = vk2dLogicalDeviceNextTimelineValue(dev, mainThread);
+	VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+	        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+	        .signalSemaphoreValueCount = 1,
+	        .pSignalSemaphoreValues = &value
+	};
+	VkSemaphore timeline = mainThread ? dev->timeline : dev->loadTimeline;
+	VkSubmitInfo submitInfo = vk2dInitSubmitInfo(&buffer, 1, &timeline, 1, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+	submitInfo.pNext = &timelineSubmitInfo;
 	vkEndCommandBuffer(buffer);
-	if (mainThread) {
-		VkResult result = vkQueueSubmit(dev->queue, 1, &submitInfo, VK_NULL_HANDLE);
-        if (result == VK_SUCCESS) {
-            result = vkQueueWaitIdle(dev->queue);
-            if (result == VK_SUCCESS) {
-                vkFreeCommandBuffers(dev->dev, dev->pool, 1, &buffer);
-            } else {
-                vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to wait for queue, Vulkan error %i", result);
-            }
-        } else {
-            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit queue, Vulkan error %i", result);
-        }
+	VkResult result = vkQueueSubmit(mainThread ? dev->queue : dev->loadQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	if (result == VK_SUCCESS) {
+		vk2dLogicalDeviceWaitTimeline(dev, value, mainThread);
+		vkFreeCommandBuffers(dev->dev, mainThread ? dev->pool : dev->loadPool, 1, &buffer);
 	} else {
-		VkResult result = vkQueueSubmit(dev->loadQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        if (result == VK_SUCCESS) {
-            result = vkQueueWaitIdle(dev->loadQueue);
-            if (result == VK_SUCCESS) {
-                vkFreeCommandBuffers(dev->dev, dev->loadPool, 1, &buffer);
-            } else {
-                vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to wait for queue, Vulkan error %i", result);
-            }
-        } else {
-            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit queue, Vulkan error %i", result);
-        }
+		vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit queue, Vulkan error %i", result);
+	}
+}
+
+uint64_t vk2dLogicalDeviceNextTimelineValue(VK2DLogicalDevice dev, bool mainThread) {
+	return mainThread ? ++dev->timelineValue : ++dev->loadTimelineValue;
+}
+
+void vk2dLogicalDeviceWaitTimeline(VK2DLogicalDevice dev, uint64_t value, bool mainThread) {
+	if (value == 0)
+		return;
+	VkSemaphore timeline = mainThread ? dev->timeline : dev->loadTimeline;
+	VkSemaphoreWaitInfo waitInfo = {
+	        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+	        .semaphoreCount = 1,
+	        .pSemaphores = &timeline,
+	        .pValues = &value
+	};
+	VkResult result = vkWaitSemaphores(dev->dev, &waitInfo, UINT64_MAX);
+	if (result == VK_ERROR_DEVICE_LOST) {
+	    vk2dRaise(VK2D_STATUS_DEVICE_LOST, "Vulkan device lost.");
+	} else if (result != VK_SUCCESS) {
+	    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to wait for timeline, Vulkan error %i", result);
 	}
 }
 
+bool vk2dLogicalDeviceTimelineReached(VK2DLogicalDevice dev, uint64_t value, bool mainThread) {
+	uint64_t current = 0;
+	vkGetSemaphoreCounterValue(dev->dev, mainThread ? dev->timeline : dev->loadTimeline, &current);
+	return current >= value;
+}
+
 VkFence vk2dLogicalDeviceGetFence(VK2DLogicalDevice dev, VkFenceCreateFlagBits flags) {
 	VkFenceCreateInfo fenceCreateInfo = vk2dInitFenceCreateInfo(flags);
 	VkFence fence;
@@ -0,0 +1,773 @@
+/// \file NullBackend.c
+/// \author Paolo Mazzon
+/// \brief Stub Vulkan implementation used when VK2D is built with VK2D_NULL_BACKEND
+///
+/// Every Vulkan entry point VK2D, VMA, and the Nuklear backend use is defined here so the library
+/// links without the Vulkan loader. Commands are accepted and dropped, fences are always signaled,
+/// and device memory is plain host memory so mapping still works. Each entry point counts its calls
+/// so CPU side microbenchmarks can check how much Vulkan work a draw call generates.
+#include <stdlib.h>
+#include <string.h>
+#include <SDL3/SDL.h>
+#include <vulkan/vulkan.h>
+
+#include "VK2D/Renderer.h"
+
+#ifdef VK2D_NULL_BACKEND
+
+// Every stubbed entry point, used for counting calls and vkGet*ProcAddr
+#define VK2D_NULL_ENTRY_POINTS(X) \
+    X(vkCreateInstance) X(vkDestroyInstance) X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties) X(vkEnumeratePhysicalDevices) X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceFeatures) X(vkGetPhysicalDeviceFeatures2) X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties2) X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkEnumerateDeviceExtensionProperties) X(vkGetInstanceProcAddr) X(vkGetDeviceProcAddr) \
+    X(vkCreateDevice) X(vkDestroyDevice) X(vkGetDeviceQueue) X(vkDeviceWaitIdle) X(vkQueueWaitIdle) \
+    X(vkQueueSubmit) X(vkCreateHeadlessSurfaceEXT) X(vkDestroySurfaceKHR) \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR) X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR) X(vkCreateSwapchainKHR) X(vkDestroySwapchainKHR) \
+    X(vkGetSwapchainImagesKHR) X(vkAcquireNextImageKHR) X(vkQueuePresentKHR) \
+    X(vkCreateDebugReportCallbackEXT) X(vkDestroyDebugReportCallbackEXT) \
+    X(vkAllocateMemory) X(vkFreeMemory) X(vkMapMemory) X(vkUnmapMemory) X(vkFlushMappedMemoryRanges) \
+    X(vkInvalidateMappedMemoryRanges) X(vkCreateBuffer) X(vkDestroyBuffer) X(vkCreateImage) X(vkDestroyImage) \
+    X(vkGetBufferMemoryRequirements) X(vkGetImageMemoryRequirements) X(vkGetBufferMemoryRequirements2) \
+    X(vkGetImageMemoryRequirements2) X(vkGetDeviceBufferMemoryRequirements) \
+    X(vkGetDeviceImageMemoryRequirements) X(vkBindBufferMemory) X(vkBindImageMemory) X(vkBindBufferMemory2) \
+    X(vkBindImageMemory2) X(vkCreateImageView) X(vkDestroyImageView) X(vkCreateSampler) X(vkDestroySampler) \
+    X(vkCreateFramebuffer) X(vkDestroyFramebuffer) X(vkCreateRenderPass) X(vkDestroyRenderPass) \
+    X(vkCreateShaderModule) X(vkDestroyShaderModule) X(vkCreatePipelineLayout) X(vkDestroyPipelineLayout) \
+    X(vkCreateGraphicsPipelines) X(vkCreateComputePipelines) X(vkDestroyPipeline) \
+    X(vkCreateDescriptorSetLayout) X(vkDestroyDescriptorSetLayout) X(vkCreateDescriptorPool) \
+    X(vkDestroyDescriptorPool) X(vkResetDescriptorPool) X(vkAllocateDescriptorSets) X(vkUpdateDescriptorSets) \
+    X(vkCreateCommandPool) X(vkDestroyCommandPool) X(vkResetCommandPool) X(vkAllocateCommandBuffers) \
+    X(vkFreeCommandBuffers) X(vkBeginCommandBuffer) X(vkEndCommandBuffer) X(vkResetCommandBuffer) \
+    X(vkCreateFence) X(vkDestroyFence) X(vkResetFences) X(vkWaitForFences) X(vkGetFenceStatus) \
+    X(vkWaitSemaphores) X(vkGetSemaphoreCounterValue) X(vkCreateSemaphore) X(vkDestroySemaphore) \
+    X(vkCreateQueryPool) X(vkDestroyQueryPool) \
+    X(vkGetQueryPoolResults) X(vkCmdBeginRenderPass) X(vkCmdEndRenderPass) X(vkCmdExecuteCommands) \
+    X(vkCmdBeginRenderingKHR) X(vkCmdEndRenderingKHR) X(vkCmdClearAttachments) \
+    X(vkCmdBindPipeline) X(vkCmdBindDescriptorSets) X(vkCmdBindVertexBuffers) X(vkCmdBindIndexBuffer) X(vkCmdDraw) \
+    X(vkCmdDrawIndexed) X(vkCmdDispatch) X(vkCmdPushConstants) X(vkCmdSetViewport) X(vkCmdSetScissor) \
+    X(vkCmdSetLineWidth) X(vkCmdPipelineBarrier) X(vkCmdCopyBuffer) X(vkCmdCopyBufferToImage) \
+    X(vkCmdCopyImage) X(vkCmdCopyImageToBuffer) X(vkCmdWriteTimestamp) X(vkCmdResetQueryPool)
+
+#define VK2D_NULL_ENUM(name) NULL_ENTRY_##name,
+typedef enum {
+    VK2D_NULL_ENTRY_POINTS(VK2D_NULL_ENUM)
+    NULL_ENTRY_MAX
+} VK2DNullEntryPoint;
+
+static SDL_AtomicInt gCallCounts[NULL_ENTRY_MAX];
+static SDL_AtomicInt gNextHandle;
+static SDL_AtomicInt gNextImage;
+
+#define NULL_CALL(name) SDL_AddAtomicInt(&gCallCounts[NULL_ENTRY_##name], 1)
+#define NULL_HANDLE(type) ((type)(uintptr_t)(SDL_AddAtomicInt(&gNextHandle, 1) + 1))
+#define NULL_SWAPCHAIN_IMAGES 3
+
+// Buffers, images, and memory need to remember their size for memory requirements and mapping
+typedef struct VK2DNullObject {
+    VkDeviceSize size;
+    void *data;
+} VK2DNullObject;
+
+static VK2DNullObject *_vk2dNullObjectCreate(VkDeviceSize size, bool backed) {
+    VK2DNullObject *object = calloc(1, sizeof(VK2DNullObject));
+    if (object != NULL) {
+        object->size = size;
+        object->data = backed ? calloc(1, size > 0 ? size : 1) : NULL;
+    }
+    return object;
+}
+
+static void _vk2dNullObjectFree(uint64_t handle) {
+    VK2DNullObject *object = (VK2DNullObject*)(uintptr_t)handle;
+    if (object != NULL) {
+        free(object->data);
+        free(object);
+    }
+}
+
+/****************************** Instance & devices ******************************/
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkInstance *pInstance) {
+    NULL_CALL(vkCreateInstance);
+    *pInstance = NULL_HANDLE(VkInstance);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroyInstance);
+}
+
+// Fills out a Vulkan enumeration from a list of names
+static VkResult _vk2dNullEnumerate(const char **names, uint32_t nameCount, uint32_t *pPropertyCount, VkExtensionProperties *pProperties) {
+    if (pProperties == NULL) {
+        *pPropertyCount = nameCount;
+        return VK_SUCCESS;
+    }
+    for (uint32_t i = 0; i < nameCount && i < *pPropertyCount; i++) {
+        memset(&pProperties[i], 0, sizeof(VkExtensionProperties));
+        strncpy(pProperties[i].extensionName, names[i], VK_MAX_EXTENSION_NAME_SIZE - 1);
+        pProperties[i].specVersion = 1;
+    }
+    const bool incomplete = *pPropertyCount < nameCount;
+    *pPropertyCount = incomplete ? *pPropertyCount : nameCount;
+    return incomplete ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(const char *pLayerName, uint32_t *pPropertyCount, VkExtensionProperties *pProperties) {
+    NULL_CALL(vkEnumerateInstanceExtensionProperties);
+    const char *extensions[] = {
+            VK_KHR_SURFACE_EXTENSION_NAME,
+            VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME,
+            VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+            VK_EXT_DEBUG_REPORT_EXTENSION_NAME
+    };
+    return _vk2dNullEnumerate(extensions, 4, pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceLayerProperties(uint32_t *pPropertyCount, VkLayerProperties *pProperties) {
+    NULL_CALL(vkEnumerateInstanceLayerProperties);
+    *pPropertyCount = 0;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(VkInstance instance, uint32_t *pPhysicalDeviceCount, VkPhysicalDevice *pPhysicalDevices) {
+    NULL_CALL(vkEnumeratePhysicalDevices);
+    if (pPhysicalDevices != NULL && *pPhysicalDeviceCount > 0)
+        pPhysicalDevices[0] = (VkPhysicalDevice)(uintptr_t)1;
+    *pPhysicalDeviceCount = 1;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties *pProperties) {
+    NULL_CALL(vkGetPhysicalDeviceProperties);
+    memset(pProperties, 0, sizeof(VkPhysicalDeviceProperties));
+    pProperties->apiVersion = VK_API_VERSION_1_1;
+    pProperties->deviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+    strncpy(pProperties->deviceName, "VK2D Null Device", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+    VkPhysicalDeviceLimits *limits = &pProperties->limits;
+    limits->maxImageDimension2D = 16384;
+    limits->maxUniformBufferRange = UINT32_MAX;
+    limits->maxStorageBufferRange = UINT32_MAX;
+    limits->maxPushConstantsSize = 256;
+    limits->maxMemoryAllocationCount = UINT32_MAX;
+    limits->maxSamplerAllocationCount = UINT32_MAX;
+    limits->bufferImageGranularity = 1;
+    limits->maxBoundDescriptorSets = 32;
+    limits->maxPerStageDescriptorSamplers = UINT32_MAX;
+    limits->maxPerStageDescriptorSampledImages = UINT32_MAX;
+    limits->maxDescriptorSetSampledImages = UINT32_MAX;
+    limits->maxSamplerAnisotropy = 16;
+    limits->minMemoryMapAlignment = 64;
+    limits->minUniformBufferOffsetAlignment = 256;
+    limits->minStorageBufferOffsetAlignment = 256;
+    limits->framebufferColorSampleCounts = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_2_BIT | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+    limits->framebufferDepthSampleCounts = limits->framebufferColorSampleCounts;
+    limits->timestampComputeAndGraphics = VK_TRUE;
+    limits->timestampPeriod = 1;
+    limits->lineWidthRange[0] = 1;
+    limits->lineWidthRange[1] = 8;
+    limits->nonCoherentAtomSize = 64;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *pFeatures) {
+    NULL_CALL(vkGetPhysicalDeviceFeatures);
+    memset(pFeatures, 0, sizeof(VkPhysicalDeviceFeatures));
+    pFeatures->wideLines = VK_TRUE;
+    pFeatures->fillModeNonSolid = VK_TRUE;
+    pFeatures->samplerAnisotropy = VK_TRUE;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFeatures2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2 *pFeatures) {
+    NULL_CALL(vkGetPhysicalDeviceFeatures2);
+    memset(&pFeatures->features, 0, sizeof(VkPhysicalDeviceFeatures));
+    for (VkBaseOutStructure *next = pFeatures->pNext; next != NULL; next = next->pNext)
+        if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR)
+            ((VkPhysicalDeviceDynamicRenderingFeaturesKHR*)next)->dynamicRendering = VK_TRUE;
+}
+
+// One heap with one memory type that can do everything
+static void _vk2dNullMemoryProperties(VkPhysicalDeviceMemoryProperties *pMemoryProperties) {
+    memset(pMemoryProperties, 0, sizeof(VkPhysicalDeviceMemoryProperties));
+    pMemoryProperties->memoryHeapCount = 1;
+    pMemoryProperties->memoryHeaps[0].size = (VkDeviceSize)4 * 1024 * 1024 * 1024;
+    pMemoryProperties->memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    pMemoryProperties->memoryTypeCount = 1;
+    pMemoryProperties->memoryTypes[0].heapIndex = 0;
+    pMemoryProperties->memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties *pMemoryProperties) {
+    NULL_CALL(vkGetPhysicalDeviceMemoryProperties);
+    _vk2dNullMemoryProperties(pMemoryProperties);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2 *pMemoryProperties) {
+    NULL_CALL(vkGetPhysicalDeviceMemoryProperties2);
+    _vk2dNullMemoryProperties(&pMemoryProperties->memoryProperties);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice, uint32_t *pQueueFamilyPropertyCount, VkQueueFamilyProperties *pQueueFamilyProperties) {
+    NULL_CALL(vkGetPhysicalDeviceQueueFamilyProperties);
+    if (pQueueFamilyProperties != NULL && *pQueueFamilyPropertyCount > 0) {
+        memset(pQueueFamilyProperties, 0, sizeof(VkQueueFamilyProperties));
+        pQueueFamilyProperties[0].queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+        pQueueFamilyProperties[0].queueCount = 2;
+        pQueueFamilyProperties[0].timestampValidBits = 64;
+        pQueueFamilyProperties[0].minImageTransferGranularity.width = 1;
+        pQueueFamilyProperties[0].minImageTransferGranularity.height = 1;
+        pQueueFamilyProperties[0].minImageTransferGranularity.depth = 1;
+    }
+    *pQueueFamilyPropertyCount = 1;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatProperties *pFormatProperties) {
+    NULL_CALL(vkGetPhysicalDeviceFormatProperties);
+    pFormatProperties->linearTilingFeatures = ~(VkFormatFeatureFlags)0;
+    pFormatProperties->optimalTilingFeatures = ~(VkFormatFeatureFlags)0;
+    pFormatProperties->bufferFeatures = ~(VkFormatFeatureFlags)0;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(VkPhysicalDevice physicalDevice, const char *pLayerName, uint32_t *pPropertyCount, VkExtensionProperties *pProperties) {
+    NULL_CALL(vkEnumerateDeviceExtensionProperties);
+    const char *extensions[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
+    return _vk2dNullEnumerate(extensions, 2, pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDevice *pDevice) {
+    NULL_CALL(vkCreateDevice);
+    *pDevice = NULL_HANDLE(VkDevice);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroyDevice);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue *pQueue) {
+    NULL_CALL(vkGetDeviceQueue);
+    *pQueue = NULL_HANDLE(VkQueue);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice device) {
+    NULL_CALL(vkDeviceWaitIdle);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue queue) {
+    NULL_CALL(vkQueueWaitIdle);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence) {
+    NULL_CALL(vkQueueSubmit);
+    return VK_SUCCESS;
+}
+
+/****************************** Surfaces & swapchains ******************************/
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateHeadlessSurfaceEXT(VkInstance instance, const VkHeadlessSurfaceCreateInfoEXT *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkSurfaceKHR *pSurface) {
+    NULL_CALL(vkCreateHeadlessSurfaceEXT);
+    *pSurface = NULL_HANDLE(VkSurfaceKHR);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySurfaceKHR(VkInstance instance, VkSurfaceKHR surface, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroySurfaceKHR);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, VkSurfaceKHR surface, VkBool32 *pSupported) {
+    NULL_CALL(vkGetPhysicalDeviceSurfaceSupportKHR);
+    *pSupported = VK_TRUE;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkSurfaceCapabilitiesKHR *pSurfaceCapabilities) {
+    NULL_CALL(vkGetPhysicalDeviceSurfaceCapabilitiesKHR);
+    memset(pSurfaceCapabilities, 0, sizeof(VkSurfaceCapabilitiesKHR));
+    pSurfaceCapabilities->minImageCount = 2;
+    pSurfaceCapabilities->maxImageCount = NULL_SWAPCHAIN_IMAGES;
+    pSurfaceCapabilities->currentExtent.width = UINT32_MAX;
+    pSurfaceCapabilities->currentExtent.height = UINT32_MAX;
+    pSurfaceCapabilities->maxImageExtent.width = 16384;
+    pSurfaceCapabilities->maxImageExtent.height = 16384;
+    pSurfaceCapabilities->maxImageArrayLayers = 1;
+    pSurfaceCapabilities->supportedTransforms = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    pSurfaceCapabilities->currentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    pSurfaceCapabilities->supportedCompositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    pSurfaceCapabilities->supportedUsageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, uint32_t *pPresentModeCount, VkPresentModeKHR *pPresentModes) {
+    NULL_CALL(vkGetPhysicalDeviceSurfacePresentModesKHR);
+    const VkPresentModeKHR modes[] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+    if (pPresentModes != NULL)
+        memcpy(pPresentModes, modes, sizeof(VkPresentModeKHR) * (*pPresentModeCount < 3 ? *pPresentModeCount : 3));
+    else
+        *pPresentModeCount = 3;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(VkDevice device, const VkSwapchainCreateInfoKHR *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkSwapchainKHR *pSwapchain) {
+    NULL_CALL(vkCreateSwapchainKHR);
+    *pSwapchain = NULL_HANDLE(VkSwapchainKHR);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroySwapchainKHR);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pSwapchainImageCount, VkImage *pSwapchainImages) {
+    NULL_CALL(vkGetSwapchainImagesKHR);
+    if (pSwapchainImages != NULL) {
+        for (uint32_t i = 0; i < *pSwapchainImageCount && i < NULL_SWAPCHAIN_IMAGES; i++)
+            pSwapchainImages[i] = NULL_HANDLE(VkImage);
+    } else {
+        *pSwapchainImageCount = NULL_SWAPCHAIN_IMAGES;
+    }
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapchain, uint64_t timeout, VkSemaphore semaphore, VkFence fence, uint32_t *pImageIndex) {
+    NULL_CALL(vkAcquireNextImageKHR);
+    *pImageIndex = (uint32_t)SDL_AddAtomicInt(&gNextImage, 1) % NULL_SWAPCHAIN_IMAGES;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo) {
+    NULL_CALL(vkQueuePresentKHR);
+    if (pPresentInfo->pResults != NULL)
+        for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++)
+            pPresentInfo->pResults[i] = VK_SUCCESS;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDebugReportCallbackEXT(VkInstance instance, const VkDebugReportCallbackCreateInfoEXT *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkDebugReportCallbackEXT *pCallback) {
+    NULL_CALL(vkCreateDebugReportCallbackEXT);
+    *pCallback = NULL_HANDLE(VkDebugReportCallbackEXT);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDebugReportCallbackEXT(VkInstance instance, VkDebugReportCallbackEXT callback, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroyDebugReportCallbackEXT);
+}
+
+/****************************** Memory ******************************/
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo, const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory) {
+    NULL_CALL(vkAllocateMemory);
+    VK2DNullObject *memory = _vk2dNullObjectCreate(pAllocateInfo->allocationSize, true);
+    if (memory == NULL || memory->data == NULL) {
+        free(memory);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    *pMemory = (VkDeviceMemory)(uintptr_t)memory;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkFreeMemory);
+    _vk2dNullObjectFree((uint64_t)(uintptr_t)memory);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void **ppData) {
+    NULL_CALL(vkMapMemory);
+    *ppData = (uint8_t*)((VK2DNullObject*)(uintptr_t)memory)->data + offset;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice device, VkDeviceMemory memory) {
+    NULL_CALL(vkUnmapMemory);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkFlushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange *pMemoryRanges) {
+    NULL_CALL(vkFlushMappedMemoryRanges);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange *pMemoryRanges) {
+    NULL_CALL(vkInvalidateMappedMemoryRanges);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer) {
+    NULL_CALL(vkCreateBuffer);
+    VK2DNullObject *buffer = _vk2dNullObjectCreate(pCreateInfo->size, false);
+    if (buffer == NULL)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    *pBuffer = (VkBuffer)(uintptr_t)buffer;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroyBuffer);
+    _vk2dNullObjectFree((uint64_t)(uintptr_t)buffer);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, VkImage *pImage) {
+    NULL_CALL(vkCreateImage);
+    // Assume the widest format VK2D uses, the memory is never touched anyway
+    const VkDeviceSize size = (VkDeviceSize)pCreateInfo->extent.width * pCreateInfo->extent.height * pCreateInfo->extent.depth *
+                              pCreateInfo->arrayLayers * pCreateInfo->samples * 4;
+    VK2DNullObject *image = _vk2dNullObjectCreate(size, false);
+    if (image == NULL)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    *pImage = (VkImage)(uintptr_t)image;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroyImage);
+    _vk2dNullObjectFree((uint64_t)(uintptr_t)image);
+}
+
+static void _vk2dNullMemoryRequirements(uint64_t handle, VkMemoryRequirements *pMemoryRequirements) {
+    pMemoryRequirements->size = ((VK2DNullObject*)(uintptr_t)handle)->size;
+    pMemoryRequirements->alignment = 256;
+    pMemoryRequirements->memoryTypeBits = 1;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements *pMemoryRequirements) {
+    NULL_CALL(vkGetBufferMemoryRequirements);
+    _vk2dNullMemoryRequirements((uint64_t)(uintptr_t)buffer, pMemoryRequirements);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements(VkDevice device, VkImage image, VkMemoryRequirements *pMemoryRequirements) {
+    NULL_CALL(vkGetImageMemoryRequirements);
+    _vk2dNullMemoryRequirements((uint64_t)(uintptr_t)image, pMemoryRequirements);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements2(VkDevice device, const VkBufferMemoryRequirementsInfo2 *pInfo, VkMemoryRequirements2 *pMemoryRequirements) {
+    NULL_CALL(vkGetBufferMemoryRequirements2);
+    _vk2dNullMemoryRequirements((uint64_t)(uintptr_t)pInfo->buffer, &pMemoryRequirements->memoryRequirements);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements2(VkDevice device, const VkImageMemoryRequirementsInfo2 *pInfo, VkMemoryRequirements2 *pMemoryRequirements) {
+    NULL_CALL(vkGetImageMemoryRequirements2);
+    _vk2dNullMemoryRequirements((uint64_t)(uintptr_t)pInfo->image, &pMemoryRequirements->memoryRequirements);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceBufferMemoryRequirements(VkDevice device, const VkDeviceBufferMemoryRequirements *pInfo, VkMemoryRequirements2 *pMemoryRequirements) {
+    NULL_CALL(vkGetDeviceBufferMemoryRequirements);
+    pMemoryRequirements->memoryRequirements.size = pInfo->pCreateInfo->size;
+    pMemoryRequirements->memoryRequirements.alignment = 256;
+    pMemoryRequirements->memoryRequirements.memoryTypeBits = 1;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceImageMemoryRequirements(VkDevice device, const VkDeviceImageMemoryRequirements *pInfo, VkMemoryRequirements2 *pMemoryRequirements) {
+    NULL_CALL(vkGetDeviceImageMemoryRequirements);
+    const VkImageCreateInfo *createInfo = pInfo->pCreateInfo;
+    pMemoryRequirements->memoryRequirements.size = (VkDeviceSize)createInfo->extent.width * createInfo->extent.height * createInfo->extent.depth *
+                                                   createInfo->arrayLayers * createInfo->samples * 4;
+    pMemoryRequirements->memoryRequirements.alignment = 256;
+    pMemoryRequirements->memoryRequirements.memoryTypeBits = 1;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset) {
+    NULL_CALL(vkBindBufferMemory);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset) {
+    NULL_CALL(vkBindImageMemory);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindBufferMemoryInfo *pBindInfos) {
+    NULL_CALL(vkBindBufferMemory2);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfo *pBindInfos) {
+    NULL_CALL(vkBindImageMemory2);
+    return VK_SUCCESS;
+}
+
+/****************************** Objects that only need a handle ******************************/
+
+// Defines a create/destroy pair for an object that doesn't need any state
+#define VK2D_NULL_SIMPLE_OBJECT(type, create, destroy, createInfo) \
+    VKAPI_ATTR VkResult VKAPI_CALL create(VkDevice device, const createInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator, type *pObject) { \
+        NULL_CALL(create); \
+        *pObject = NULL_HANDLE(type); \
+        return VK_SUCCESS; \
+    } \
+    VKAPI_ATTR void VKAPI_CALL destroy(VkDevice device, type object, const VkAllocationCallbacks *pAllocator) { \
+        NULL_CALL(destroy); \
+    }
+
+VK2D_NULL_SIMPLE_OBJECT(VkImageView, vkCreateImageView, vkDestroyImageView, VkImageViewCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkSampler, vkCreateSampler, vkDestroySampler, VkSamplerCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkFramebuffer, vkCreateFramebuffer, vkDestroyFramebuffer, VkFramebufferCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkRenderPass, vkCreateRenderPass, vkDestroyRenderPass, VkRenderPassCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkShaderModule, vkCreateShaderModule, vkDestroyShaderModule, VkShaderModuleCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkPipelineLayout, vkCreatePipelineLayout, vkDestroyPipelineLayout, VkPipelineLayoutCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkDescriptorSetLayout, vkCreateDescriptorSetLayout, vkDestroyDescriptorSetLayout, VkDescriptorSetLayoutCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkDescriptorPool, vkCreateDescriptorPool, vkDestroyDescriptorPool, VkDescriptorPoolCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkCommandPool, vkCreateCommandPool, vkDestroyCommandPool, VkCommandPoolCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkFence, vkCreateFence, vkDestroyFence, VkFenceCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkSemaphore, vkCreateSemaphore, vkDestroySemaphore, VkSemaphoreCreateInfo)
+VK2D_NULL_SIMPLE_OBJECT(VkQueryPool, vkCreateQueryPool, vkDestroyQueryPool, VkQueryPoolCreateInfo)
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo *pCreateInfos, const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines) {
+    NULL_CALL(vkCreateGraphicsPipelines);
+    for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = NULL_HANDLE(VkPipeline);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo *pCreateInfos, const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines) {
+    NULL_CALL(vkCreateComputePipelines);
+    for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = NULL_HANDLE(VkPipeline);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator) {
+    NULL_CALL(vkDestroyPipeline);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags) {
+    NULL_CALL(vkResetDescriptorPool);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo, VkDescriptorSet *pDescriptorSets) {
+    NULL_CALL(vkAllocateDescriptorSets);
+    for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++)
+        pDescriptorSets[i] = NULL_HANDLE(VkDescriptorSet);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet *pDescriptorWrites, uint32_t descriptorCopyCount, const VkCopyDescriptorSet *pDescriptorCopies) {
+    NULL_CALL(vkUpdateDescriptorSets);
+}
+
+/****************************** Command buffers & synchronization ******************************/
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags) {
+    NULL_CALL(vkResetCommandPool);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *pAllocateInfo, VkCommandBuffer *pCommandBuffers) {
+    NULL_CALL(vkAllocateCommandBuffers);
+    for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++)
+        pCommandBuffers[i] = NULL_HANDLE(VkCommandBuffer);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers) {
+    NULL_CALL(vkFreeCommandBuffers);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo) {
+    NULL_CALL(vkBeginCommandBuffer);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffer commandBuffer) {
+    NULL_CALL(vkEndCommandBuffer);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags) {
+    NULL_CALL(vkResetCommandBuffer);
+    return VK_SUCCESS;
+}
+
+// Fences are signaled the moment anything looks at them
+VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences) {
+    NULL_CALL(vkResetFences);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBool32 waitAll, uint64_t timeout) {
+    NULL_CALL(vkWaitForFences);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device, VkFence fence) {
+    NULL_CALL(vkGetFenceStatus);
+    return VK_SUCCESS;
+}
+
+// Same goes for timelines, they have always reached every value
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitSemaphores(VkDevice device, const VkSemaphoreWaitInfo *pWaitInfo, uint64_t timeout) {
+    NULL_CALL(vkWaitSemaphores);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetSemaphoreCounterValue(VkDevice device, VkSemaphore semaphore, uint64_t *pValue) {
+    NULL_CALL(vkGetSemaphoreCounterValue);
+    *pValue = UINT64_MAX;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, size_t dataSize, void *pData, VkDeviceSize stride, VkQueryResultFlags flags) {
+    NULL_CALL(vkGetQueryPoolResults);
+    memset(pData, 0, dataSize);
+    return VK_SUCCESS;
+}
+
+/****************************** Commands ******************************/
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin, VkSubpassContents contents) {
+    NULL_CALL(vkCmdBeginRenderPass);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer commandBuffer) {
+    NULL_CALL(vkCmdEndRenderPass);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers) {
+    NULL_CALL(vkCmdExecuteCommands);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderingKHR(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR *pRenderingInfo) {
+    NULL_CALL(vkCmdBeginRenderingKHR);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderingKHR(VkCommandBuffer commandBuffer) {
+    NULL_CALL(vkCmdEndRenderingKHR);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_t attachmentCount, const VkClearAttachment *pAttachments, uint32_t rectCount, const VkClearRect *pRects) {
+    NULL_CALL(vkCmdClearAttachments);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline) {
+    NULL_CALL(vkCmdBindPipeline);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t *pDynamicOffsets) {
+    NULL_CALL(vkCmdBindDescriptorSets);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer *pBuffers, const VkDeviceSize *pOffsets) {
+    NULL_CALL(vkCmdBindVertexBuffers);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+    NULL_CALL(vkCmdBindIndexBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+    NULL_CALL(vkCmdDraw);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    NULL_CALL(vkCmdDrawIndexed);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    NULL_CALL(vkCmdDispatch);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void *pValues) {
+    NULL_CALL(vkCmdPushConstants);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport *pViewports) {
+    NULL_CALL(vkCmdSetViewport);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D *pScissors) {
+    NULL_CALL(vkCmdSetScissor);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth) {
+    NULL_CALL(vkCmdSetLineWidth);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier *pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
+    NULL_CALL(vkCmdPipelineBarrier);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy *pRegions) {
+    NULL_CALL(vkCmdCopyBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy *pRegions) {
+    NULL_CALL(vkCmdCopyBufferToImage);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageCopy *pRegions) {
+    NULL_CALL(vkCmdCopyImage);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy *pRegions) {
+    NULL_CALL(vkCmdCopyImageToBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query) {
+    NULL_CALL(vkCmdWriteTimestamp);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount) {
+    NULL_CALL(vkCmdResetQueryPool);
+}
+
+/****************************** Lookup ******************************/
+
+#define VK2D_NULL_NAME(name) #name,
+static const char *gEntryPointNames[NULL_ENTRY_MAX] = {
+    VK2D_NULL_ENTRY_POINTS(VK2D_NULL_NAME)
+};
+
+#define VK2D_NULL_POINTER(name) (PFN_vkVoidFunction)name,
+static const PFN_vkVoidFunction gEntryPoints[NULL_ENTRY_MAX] = {
+    VK2D_NULL_ENTRY_POINTS(VK2D_NULL_POINTER)
+};
+
+static PFN_vkVoidFunction _vk2dNullFindEntryPoint(const char *pName) {
+    for (int i = 0; i < NULL_ENTRY_MAX; i++)
+        if (strcmp(gEntryPointNames[i], pName) == 0)
+            return gEntryPoints[i];
+    return NULL;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(VkInstance instance, const char *pName) {
+    NULL_CALL(vkGetInstanceProcAddr);
+    return _vk2dNullFindEntryPoint(pName);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice device, const char *pName) {
+    NULL_CALL(vkGetDeviceProcAddr);
+    return _vk2dNullFindEntryPoint(pName);
+}
+
+uint64_t vk2dRendererGetVulkanCallCount(const char *entryPoint) {
+    if (entryPoint == NULL) {
+        uint64_t total = 0;
+        for (int i = 0; i < NULL_ENTRY_MAX; i++)
+            total += (uint32_t)SDL_GetAtomicInt(&gCallCounts[i]);
+        return total;
+    }
+    for (int i = 0; i < NULL_ENTRY_MAX; i++)
+        if (strcmp(gEntryPointNames[i], entryPoint) == 0)
+            return (uint32_t)SDL_GetAtomicInt(&gCallCounts[i]);
+    return 0;
+}
+
+void vk2dRendererResetVulkanCallCounts() {
+    for (int i = 0; i < NULL_ENTRY_MAX; i++)
+        SDL_SetAtomicInt(&gCallCounts[i], 0);
+}
+
+#else
+
+uint64_t vk2dRendererGetVulkanCallCount(const char *entryPoint) {
+    return 0;
+}
+
+void vk2dRendererResetVulkanCallCounts() {
+    // Calls are only counted by the null backend
+}
+
+#endif
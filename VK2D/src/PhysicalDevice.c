@@ -57,6 +57,15 @@ static bool _vk2dPhysicalDeviceSupportsQueueFamilies(VkInstance instance, VkPhys
                 }
             }
         }
+
+        // Prefer a compute-only family for async compute if the device has one
+        for (i = 0; i < queueFamilyCount && gfx; i++) {
+            if (queueList[i].queueCount > 0 && queueList[i].queueFlags & VK_QUEUE_COMPUTE_BIT &&
+                !(queueList[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                out->QueueFamily.computeFamily = i;
+                break;
+            }
+        }
     } else {
 	    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate queue family properties.");
 	}
@@ -118,6 +118,15 @@ VK2DPipeline vk2dPipelineCreate(VK2DLogicalDevice dev, VkRenderPass renderPass,
             pipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         }
 
+		// Without a render pass the pipeline only needs to know the attachment formats, textures and the
+		// swapchain share the same colour format so one set of pipelines works for both
+		VkPipelineRenderingCreateInfoKHR renderingCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
+				.colorAttachmentCount = 1,
+				.pColorAttachmentFormats = &gRenderer->surfaceFormat.format,
+				.depthAttachmentFormat = gRenderer->depthBufferFormat
+		};
+
 		for (i = 0; i < VK2D_BLEND_MODE_MAX; i++) {
 			VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = vk2dInitPipelineColorBlendStateCreateInfo(&VK2D_BLEND_MODES[i], 1);
 			VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = vk2dInitGraphicsPipelineCreateInfo(
@@ -133,6 +142,8 @@ VK2DPipeline vk2dPipelineCreate(VK2DLogicalDevice dev, VkRenderPass renderPass,
 					&pipelineDynamicStateCreateInfo,
 					pipe->layout,
 					renderPass);
+			if (renderPass == VK_NULL_HANDLE)
+				graphicsPipelineCreateInfo.pNext = &renderingCreateInfo;
 			result = vkCreateGraphicsPipelines(dev->dev, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, VK_NULL_HANDLE, &pipe->pipes[i]);
 			if (result != VK_SUCCESS) {
 			    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create pipeline, Vulkan error %i.", result);
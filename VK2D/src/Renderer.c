@@ -4,6 +4,7 @@
 #include <SDL3/SDL_vulkan.h>
 #include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "VK2D/RendererMeta.h"
@@ -23,6 +24,7 @@
 #include "VK2D/Pipeline.h"
 #include "VK2D/Logger.h"
 #include "VK2D/nuklear_defs.h"
+#include "VK2D/Trace.h"
 
 /******************************* Forward declarations *******************************/
 
@@ -43,7 +45,11 @@ static VK2DStartupOptions DEFAULT_STARTUP_OPTIONS = {
     .quitOnError = true,
     .errorFile = "vk2derror.txt",
     .vramPageSize = 256 * 1000,
-    .maxTextures = 10000
+    .maxTextures = 10000,
+    .frameTimeHistory = 1000,
+    .headlessWidth = 1280,
+    .headlessHeight = 720,
+    .framesInFlight = VK2D_DEFAULT_FRAMES_IN_FLIGHT
 };
 
 /******************************* User-visible functions *******************************/
@@ -66,10 +72,26 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
             userOptions.maxTextures = DEFAULT_STARTUP_OPTIONS.maxTextures;
         if (userOptions.errorFile == NULL)
             userOptions.errorFile = DEFAULT_STARTUP_OPTIONS.errorFile;
+        if (userOptions.frameTimeHistory == 0)
+            userOptions.frameTimeHistory = DEFAULT_STARTUP_OPTIONS.frameTimeHistory;
+        if (userOptions.headlessWidth == 0)
+            userOptions.headlessWidth = DEFAULT_STARTUP_OPTIONS.headlessWidth;
+        if (userOptions.headlessHeight == 0)
+            userOptions.headlessHeight = DEFAULT_STARTUP_OPTIONS.headlessHeight;
+        if (userOptions.framesInFlight == 0)
+            userOptions.framesInFlight = DEFAULT_STARTUP_OPTIONS.framesInFlight;
+        else if (userOptions.framesInFlight > VK2D_MAX_FRAMES_IN_FLIGHT)
+            userOptions.framesInFlight = VK2D_MAX_FRAMES_IN_FLIGHT;
+    }
+
+    // Nuklear needs a window to pull input from
+    if (window == NULL && userOptions.enableNuklear) {
+        userOptions.enableNuklear = false;
     }
 
 	// Validation initialization needs to happen right away
 	vk2dValidationBegin(userOptions.errorFile, userOptions.quitOnError);
+	_vk2dTraceInit();
 
     if (vk2dRendererGetPointer() != NULL) {
         // Print all available layers
@@ -78,6 +100,7 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
         VkResult result = vkEnumerateInstanceLayerProperties(&systemLayerCount, VK_NULL_HANDLE);
 
         if (result != VK_SUCCESS) {
+            _vk2dTraceQuit();
             free(gRenderer);
             gRenderer = NULL;
             vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to get layers, Vulkan error %i.", result);
@@ -88,6 +111,7 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
         result = vkEnumerateInstanceLayerProperties(&systemLayerCount, systemLayers);
 
         if (result != VK_SUCCESS) {
+            _vk2dTraceQuit();
             free(gRenderer);
             gRenderer = NULL;
             vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to get layers, Vulkan error %i.", result);
@@ -100,11 +124,21 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
         vkEnumerateInstanceExtensionProperties(VK_NULL_HANDLE, &instanceExtensionCount, VK_NULL_HANDLE);
         instanceExtensions = malloc(instanceExtensionCount * sizeof(VkExtensionProperties));
         vkEnumerateInstanceExtensionProperties(VK_NULL_HANDLE, &instanceExtensionCount, instanceExtensions);
+        bool supportsHeadless = false;
         for (i = 0; i < instanceExtensionCount; i++) {
             if (strcmp(instanceExtensions[i].extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
                 gRenderer->limits.supportsVRAMUsage = true;
+            if (strcmp(instanceExtensions[i].extensionName, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME) == 0)
+                supportsHeadless = true;
         }
         free(instanceExtensions);
+        if (window == NULL && !supportsHeadless) {
+            _vk2dTraceQuit();
+            free(gRenderer);
+            gRenderer = NULL;
+            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Headless rendering requested but %s is not available.", VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+            return VK2D_ERROR;
+        }
 
         // Create extension/layer lists
         const char *extensions[10] = {0};
@@ -120,14 +154,21 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
             extensions[extensionCount++] = VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME;
         }
 
-        // Find number of total number of extensions
-        sdlExtensions = (void*)SDL_Vulkan_GetInstanceExtensions(&sdlExtensionsCount);
+        // Find number of total number of extensions, headless surfaces don't need anything from SDL
+        static const char *headlessExtensions[] = {VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME};
+        if (window == NULL) {
+            sdlExtensions = headlessExtensions;
+            sdlExtensionsCount = 2;
+        } else {
+            sdlExtensions = (void*)SDL_Vulkan_GetInstanceExtensions(&sdlExtensionsCount);
+        }
 
 		// Copy user options
 		gRenderer->options = userOptions;
 
 		// Load extensions
 		if (!sdlExtensions) {
+            _vk2dTraceQuit();
             free(gRenderer);
             gRenderer = NULL;
             vk2dRaise(VK2D_STATUS_SDL_ERROR | VK2D_STATUS_VULKAN_ERROR, "Failed to get extensions, SDL error %s.", SDL_GetError());
@@ -165,6 +206,7 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
 
         if (result != VK_SUCCESS) {
 		    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create Vulkan instance, Vulkan error %i.", result);
+		    _vk2dTraceQuit();
 		    free(gRenderer);
 		    gRenderer = NULL;
 		    return VK2D_ERROR;
@@ -247,6 +289,7 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
 		_vk2dRendererCreateUnits();
 		_vk2dRendererCreateSynchronization();
 		_vk2dRendererCreateSpriteBatching();
+		_vk2dRendererCreateProfiler();
 		_vk2dRendererInitNuklear();
 
 		// Quit if something failed
@@ -267,6 +310,7 @@ VK2DResult vk2dRendererInit(SDL_Window *window, VK2DRendererConfig config, const
 		SDL_SetAtomicInt(&gRNG, time(0));
 	} else {
 		errorCode = VK2D_ERROR;
+		_vk2dTraceQuit();
 		vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate renderer struct.");
 	}
 
@@ -280,6 +324,8 @@ void vk2dRendererQuit() {
 
 		// Destroy subsystems
         _vk2dRendererQuitNuklear();
+        _vk2dRendererDestroyDefragmentation();
+        _vk2dRendererDestroyProfiler();
         _vk2dRendererDestroySpriteBatching();
 		_vk2dRendererDestroySynchronization();
 		_vk2dRendererDestroyTargetsList();
@@ -305,6 +351,7 @@ void vk2dRendererQuit() {
 		free(gRenderer->vmaBudgets);
 
         vk2dLogInfo("VK2D has been uninitialized.");
+		_vk2dTraceQuit();
 		vk2dValidationEnd();
 		free(gRenderer);
 		gRenderer = NULL;
@@ -319,7 +366,7 @@ vk2dHostInformation()
 
 void vk2dRendererWait() {
 	if (vk2dRendererGetPointer() != NULL)
-		vkQueueWaitIdle(gRenderer->ld->queue);
+		vk2dLogicalDeviceWaitTimeline(gRenderer->ld, gRenderer->ld->timelineValue, true);
 }
 
 VK2DRenderer vk2dRendererGetPointer() {
@@ -366,6 +413,47 @@ void vk2dRendererGetVRAMUsage(float *inUse, float *total) {
     *inUse /= 1048576;
 }
 
+void vk2dRendererBeginGPUScope(const char *name) {
+    if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal() && gRenderer->procedStartFrame) {
+        if (gRenderer->gpuScopeDepth >= VK2D_MAX_GPU_SCOPE_DEPTH) {
+            vk2dLogWarn("GPU scope \"%s\" is nested too deeply, it will not be recorded.", name);
+            return;
+        }
+
+        // Anything batched before this shouldn't count towards this scope
+        vk2dRendererFlushSpriteBatch();
+        int32_t scope = _vk2dRendererBeginGPUScope(gRenderer->drawBuffer, name, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        gRenderer->gpuScopeStack[gRenderer->gpuScopeDepth++] = scope;
+    }
+}
+
+void vk2dRendererEndGPUScope() {
+    if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal() && gRenderer->procedStartFrame && gRenderer->gpuScopeDepth > 0) {
+        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererEndGPUScope(gRenderer->drawBuffer, gRenderer->gpuScopeStack[--gRenderer->gpuScopeDepth]);
+    }
+}
+
+const VK2DGPUTiming *vk2dRendererGetGPUTimings(uint32_t *count) {
+    *count = 0;
+    if (vk2dRendererGetPointer() != NULL && gRenderer->gpuTimings != NULL) {
+        *count = gRenderer->gpuTimingCount;
+        return gRenderer->gpuTimings;
+    }
+    return NULL;
+}
+
+bool vk2dRendererDefragment(float budgetMs) {
+    if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
+        if (gRenderer->procedStartFrame) {
+            vk2dLogWarn("vk2dRendererDefragment may not be called between vk2dRendererStartFrame and vk2dRendererEndFrame.");
+            return false;
+        }
+        return _vk2dRendererDefragmentStep(budgetMs);
+    }
+    return false;
+}
+
 void vk2dRendererStartFrame(const vec4 clearColour) {
 	if (vk2dRendererGetPointer() != NULL) {
 		if (!gRenderer->procedStartFrame) {
@@ -375,14 +463,20 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 
 			gRenderer->previousTime = SDL_GetPerformanceCounter();
 
+			// Low-latency pacing and the frame limiter
+			_vk2dRendererPaceFrame();
+
 			// Wait for previous rendering to be finished
-			vkWaitForFences(gRenderer->ld->dev, 1, &gRenderer->inFlightFences[gRenderer->currentFrame], VK_TRUE,
-							UINT64_MAX);
+			VK2D_TRACE_BEGIN(fenceZone, "Wait for frame fence");
+			vk2dLogicalDeviceWaitTimeline(gRenderer->ld, gRenderer->frames[gRenderer->currentFrame].timelineValue, true);
+			VK2D_TRACE_END(fenceZone);
 
 			// Acquire image
+			VK2D_TRACE_BEGIN(acquireZone, "Acquire swapchain image");
 			VkResult result = vkAcquireNextImageKHR(gRenderer->ld->dev, gRenderer->swapchain, UINT64_MAX,
-								  gRenderer->imageAvailableSemaphores[gRenderer->currentFrame], VK_NULL_HANDLE,
+								  gRenderer->frames[gRenderer->currentFrame].imageAvailableSemaphore, VK_NULL_HANDLE,
 								  &gRenderer->scImageIndex);
+			VK2D_TRACE_END(acquireZone);
 
 			if (result < 0) {
 			    if (result == VK_ERROR_DEVICE_LOST) {
@@ -393,11 +487,12 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 			    return;
 			}
 
-			if (gRenderer->imagesInFlight[gRenderer->scImageIndex] != VK_NULL_HANDLE) {
-				vkWaitForFences(gRenderer->ld->dev, 1, &gRenderer->imagesInFlight[gRenderer->scImageIndex], VK_TRUE,
-								UINT64_MAX);
-			}
-			gRenderer->imagesInFlight[gRenderer->scImageIndex] = gRenderer->inFlightFences[gRenderer->currentFrame];
+			// The image may still be in use by a frame from a different frame context
+			vk2dLogicalDeviceWaitTimeline(gRenderer->ld, gRenderer->imagesInFlight[gRenderer->scImageIndex], true);
+
+			// All waiting is done, this is the last moment the game can read input before the frame is built
+			if (gRenderer->inputCallback != NULL)
+			    gRenderer->inputCallback(gRenderer->inputCallbackData);
 
 			/*********** Start-of-frame tasks ***********/
 
@@ -407,12 +502,17 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 			// Update VMA's frame
             vmaSetCurrentFrameIndex(gRenderer->vma, gRenderer->currentFrame);
 
+			// Bring back textures drawn while evicted, then make room in VRAM if we're over budget
+			gRenderer->frameCount++;
+			_vk2dRendererRestoreTextures();
+			_vk2dRendererEvictTextures();
+
 			// Reset current render targets
-			gRenderer->targetFrameBuffer = gRenderer->framebuffers[gRenderer->scImageIndex];
+			gRenderer->targetFrameBuffer = _vk2dRendererGetScreenFramebuffer();
 			gRenderer->targetRenderPass = gRenderer->renderPass;
 			gRenderer->targetSubPass = 0;
 			gRenderer->targetImage = gRenderer->swapchainImages[gRenderer->scImageIndex];
-			gRenderer->targetUBOSet = gRenderer->uboDescriptorSets[gRenderer->currentFrame]; // TODO: Should prob be reworked
+			gRenderer->targetUBOSet = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet; // TODO: Should prob be reworked
 			gRenderer->target = VK2D_TARGET_SCREEN;
 			_vk2dRendererResetBatch();
 
@@ -420,23 +520,26 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 			VkCommandBufferBeginInfo beginInfo = vk2dInitCommandBufferBeginInfo(
 					VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
 					VK_NULL_HANDLE);
-			result = vkResetCommandBuffer(gRenderer->commandBuffer[gRenderer->scImageIndex], 0);
-            VkResult result2 = vkResetCommandBuffer(gRenderer->dbCommandBuffer[gRenderer->scImageIndex], 0);
-            VkResult result3 = vkResetCommandBuffer(gRenderer->computeCommandBuffer[gRenderer->scImageIndex], 0);
+			result = vkResetCommandBuffer(gRenderer->frames[gRenderer->currentFrame].commandBuffer, 0);
+            VkResult result2 = vkResetCommandBuffer(gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer, 0);
+            VkResult result3 = vkResetCommandBuffer(gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer, 0);
             if (result != VK_SUCCESS || result2 != VK_SUCCESS || result3 != VK_SUCCESS) {
 			    vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "Failed to reset command buffer at start of frame.");
 			    return;
 			}
-			result = vkBeginCommandBuffer(gRenderer->commandBuffer[gRenderer->scImageIndex], &beginInfo);
-            result2 = vkBeginCommandBuffer(gRenderer->dbCommandBuffer[gRenderer->scImageIndex], &beginInfo);
-            result3 = vkBeginCommandBuffer(gRenderer->computeCommandBuffer[gRenderer->scImageIndex], &beginInfo);
+			result = vkBeginCommandBuffer(gRenderer->frames[gRenderer->currentFrame].commandBuffer, &beginInfo);
+            result2 = vkBeginCommandBuffer(gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer, &beginInfo);
+            result3 = vkBeginCommandBuffer(gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer, &beginInfo);
             if (result != VK_SUCCESS || result2 != VK_SUCCESS || result3 != VK_SUCCESS) {
                 vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin command buffer at start of frame, Vulkan error %i/%i/%i.", result, result2, result3);
                 return;
             }
 
+			// Collect the timings of the last frame to use this slot
+			_vk2dRendererBeginProfilerFrame();
+
 			// Begin descriptor buffer and sprite batching
-            vk2dDescriptorBufferBeginFrame(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
+            vk2dDescriptorBufferBeginFrame(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer);
             //gRenderer->spriteBatchCount = 0;
 
 			// Flush the current ubo into its buffer for the frame
@@ -446,33 +549,46 @@ void vk2dRendererStartFrame(const vec4 clearColour) {
 			_vk2dRendererFlushUBOBuffers();
 
 			// Desc cons
-			vk2dDescConReset(gRenderer->descConShaders[gRenderer->currentFrame]);
-            vk2dDescConReset(gRenderer->descConCompute[gRenderer->currentFrame]);
-            vk2dDescConReset(gRenderer->descConSBO[gRenderer->currentFrame]);
-
-            // Setup render pass
-			VkRect2D rect = {0};
-			rect.extent.width = gRenderer->surfaceWidth;
-			rect.extent.height = gRenderer->surfaceHeight;
-			const uint32_t clearCount = 2;
-			VkClearValue clearValues[2] = {0};
-			clearValues[0].color.float32[0] = clearColour[0];
-			clearValues[0].color.float32[1] = clearColour[1];
-			clearValues[0].color.float32[2] = clearColour[2];
-			clearValues[0].color.float32[3] = clearColour[3];
-			clearValues[1].depthStencil.depth = 1;
-			VkRenderPassBeginInfo renderPassBeginInfo = vk2dInitRenderPassBeginInfo(
-					gRenderer->renderPass,
-					gRenderer->framebuffers[gRenderer->scImageIndex],
-					rect,
-					clearValues,
-					clearCount);
-
-			vkCmdBeginRenderPass(gRenderer->commandBuffer[gRenderer->scImageIndex], &renderPassBeginInfo,
-								 VK_SUBPASS_CONTENTS_INLINE);
+			vk2dDescConReset(gRenderer->frames[gRenderer->currentFrame].descConShaders);
+            vk2dDescConReset(gRenderer->frames[gRenderer->currentFrame].descConCompute);
+            vk2dDescConReset(gRenderer->frames[gRenderer->currentFrame].descConSBO);
+
+            // Setup render pass, the frame graph puts it off until the end of the frame
+			gRenderer->drawBuffer = gRenderer->frames[gRenderer->currentFrame].commandBuffer;
+			if (gRenderer->options.enableFrameGraph) {
+			    _vk2dRendererBeginFrameGraph(clearColour);
+			} else if (gRenderer->dynamicRendering) {
+                gRenderer->gpuPassScope = _vk2dRendererBeginGPUScope(gRenderer->frames[gRenderer->currentFrame].commandBuffer, "Screen pass", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+                _vk2dRendererBeginRendering(gRenderer->frames[gRenderer->currentFrame].commandBuffer, VK2D_TARGET_SCREEN, clearColour, NULL, 0);
+                gRenderer->frameStats.renderPassBegins++;
+			} else {
+                VkRect2D rect = {0};
+                rect.extent.width = gRenderer->surfaceWidth;
+                rect.extent.height = gRenderer->surfaceHeight;
+                const uint32_t clearCount = 2;
+                VkClearValue clearValues[2] = {0};
+                clearValues[0].color.float32[0] = clearColour[0];
+                clearValues[0].color.float32[1] = clearColour[1];
+                clearValues[0].color.float32[2] = clearColour[2];
+                clearValues[0].color.float32[3] = clearColour[3];
+                clearValues[1].depthStencil.depth = 1;
+                VkRenderPassBeginInfo renderPassBeginInfo = vk2dInitRenderPassBeginInfo(
+                        gRenderer->renderPass,
+                        gRenderer->framebuffers[gRenderer->scImageIndex],
+                        rect,
+                        clearValues,
+                        clearCount);
+
+                gRenderer->gpuPassScope = _vk2dRendererBeginGPUScope(gRenderer->frames[gRenderer->currentFrame].commandBuffer, "Screen pass", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+                vkCmdBeginRenderPass(gRenderer->frames[gRenderer->currentFrame].commandBuffer, &renderPassBeginInfo,
+                                     VK_SUBPASS_CONTENTS_INLINE);
+                gRenderer->frameStats.renderPassBegins++;
+			}
 
 			// Bind compute pipeline to the compute buffer
-            vkCmdBindPipeline(gRenderer->computeCommandBuffer[gRenderer->scImageIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vk2dPipelineGetCompute(gRenderer->spriteBatchPipe));
+            vkCmdBindPipeline(gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk2dPipelineGetCompute(gRenderer->spriteBatchPipe));
+            gRenderer->frameStats.pipelineBinds++;
+            gRenderer->gpuComputeScope = _vk2dRendererBeginGPUScope(gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer, "Sprite batch compute", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
 		}
 	}
 }
@@ -482,7 +598,7 @@ VK2DResult vk2dRendererEndFrame() {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
 		if (gRenderer->procedStartFrame) {
 		    // Flush whatevers on batch
-		    vk2dRendererFlushSpriteBatch();
+		    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_END_FRAME);
 
 			gRenderer->procedStartFrame = false;
 
@@ -491,19 +607,41 @@ VK2DResult vk2dRendererEndFrame() {
 				vk2dRendererSetTarget(VK2D_TARGET_SCREEN);
 			}
 
+            // The GUI is drawn over everything else in the screen pass
+            if (gRenderer->options.enableNuklear)
+                _vk2dRendererDrawNuklear(gRenderer->drawBuffer);
+
 			// Dispatch compute and end the descriptor buffer frame
-            vkCmdEndRenderPass(gRenderer->commandBuffer[gRenderer->scImageIndex]);
+            if (gRenderer->options.enableFrameGraph) {
+                _vk2dRendererEndFrameGraph();
+            } else if (gRenderer->dynamicRendering) {
+                gRenderer->ld->endRendering(gRenderer->frames[gRenderer->currentFrame].commandBuffer);
+                _vk2dRendererEndGPUScope(gRenderer->frames[gRenderer->currentFrame].commandBuffer, gRenderer->gpuPassScope);
+            } else {
+                vkCmdEndRenderPass(gRenderer->frames[gRenderer->currentFrame].commandBuffer);
+                _vk2dRendererEndGPUScope(gRenderer->frames[gRenderer->currentFrame].commandBuffer, gRenderer->gpuPassScope);
+            }
+
+            // Without a render pass nothing else puts the swapchain image in the layout presenting expects
+            if (gRenderer->dynamicRendering)
+                _vk2dRendererEndRenderingFrame(gRenderer->frames[gRenderer->currentFrame].commandBuffer);
+            _vk2dRendererEndGPUScope(gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer, gRenderer->gpuComputeScope);
 			//_vk2dRendererDispatchCompute();
-            vk2dDescriptorBufferEndFrame(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
+            const int32_t copyScope = _vk2dRendererBeginGPUScope(gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer, "Descriptor buffer copy", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            vk2dDescriptorBufferEndFrame(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer);
+            _vk2dRendererEndGPUScope(gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer, copyScope);
 
             // Record necessary pipeline barriers to the copy and compute buffers
-            vk2dDescriptorBufferRecordCopyPipelineBarrier(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
-            vk2dDescriptorBufferRecordComputePipelineBarrier(gRenderer->descriptorBuffers[gRenderer->currentFrame], gRenderer->computeCommandBuffer[gRenderer->scImageIndex]);
+            vk2dDescriptorBufferRecordCopyPipelineBarrier(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer);
+            // With async compute the semaphore between the queues takes the place of the compute barrier
+            const bool asyncCompute = gRenderer->ld->computeQueue != VK_NULL_HANDLE;
+            if (!asyncCompute)
+                vk2dDescriptorBufferRecordComputePipelineBarrier(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer);
 
             // PRESENT
-            VkResult result = vkEndCommandBuffer(gRenderer->commandBuffer[gRenderer->scImageIndex]);
-            VkResult result2 = vkEndCommandBuffer(gRenderer->dbCommandBuffer[gRenderer->scImageIndex]);
-            VkResult result3 = vkEndCommandBuffer(gRenderer->computeCommandBuffer[gRenderer->scImageIndex]);
+            VkResult result = vkEndCommandBuffer(gRenderer->frames[gRenderer->currentFrame].commandBuffer);
+            VkResult result2 = vkEndCommandBuffer(gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer);
+            VkResult result3 = vkEndCommandBuffer(gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer);
             if (result != VK_SUCCESS || result2 != VK_SUCCESS || result3 != VK_SUCCESS) {
                 vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin command buffer at start of frame, Vulkan error %i/%i/%i.", result, result2, result3);
                 return VK2D_ERROR;
@@ -511,23 +649,53 @@ VK2DResult vk2dRendererEndFrame() {
 
 			// Wait for image before doing things
 			VkPipelineStageFlags waitStage[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-			VkCommandBuffer bufs[] = {gRenderer->dbCommandBuffer[gRenderer->scImageIndex], gRenderer->computeCommandBuffer[gRenderer->scImageIndex], gRenderer->commandBuffer[gRenderer->scImageIndex]};
+			VkCommandBuffer bufs[] = {gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer, gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer, gRenderer->frames[gRenderer->currentFrame].commandBuffer};
 			VkSubmitInfo submitInfo = vk2dInitSubmitInfo(
 					bufs,
 					3,
 					&gRenderer->renderFinishedSemaphores[gRenderer->scImageIndex],
 					1,
-					&gRenderer->imageAvailableSemaphores[gRenderer->currentFrame],
+					&gRenderer->frames[gRenderer->currentFrame].imageAvailableSemaphore,
 					1,
 					waitStage);
 
-			// Submit queue
-			if (vkResetFences(gRenderer->ld->dev, 1, &gRenderer->inFlightFences[gRenderer->currentFrame]) != VK_SUCCESS) {
-			    vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "Failed to reset fences.");
-                return VK2D_ERROR;
+			// Copies and compute go to their own queue first, graphics waits on them before vertex input
+			VkPipelineStageFlags asyncWaitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+			VkSemaphore asyncWaitSemaphores[] = {gRenderer->frames[gRenderer->currentFrame].imageAvailableSemaphore, gRenderer->frames[gRenderer->currentFrame].computeFinishedSemaphore};
+			if (asyncCompute) {
+			    VkSubmitInfo computeSubmitInfo = vk2dInitSubmitInfo(bufs, 2, &gRenderer->frames[gRenderer->currentFrame].computeFinishedSemaphore, 1, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+			    result = vkQueueSubmit(gRenderer->ld->computeQueue, 1, &computeSubmitInfo, VK_NULL_HANDLE);
+			    if (result < 0) {
+			        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit compute queue, Vulkan error %i.", result);
+			        return VK2D_ERROR;
+			    }
+			    submitInfo.pCommandBuffers = &bufs[2];
+			    submitInfo.commandBufferCount = 1;
+			    submitInfo.pWaitSemaphores = asyncWaitSemaphores;
+			    submitInfo.pWaitDstStageMask = asyncWaitStages;
+			    submitInfo.waitSemaphoreCount = 2;
 			}
-			result = vkQueueSubmit(gRenderer->ld->queue, 1, &submitInfo,
-										 gRenderer->inFlightFences[gRenderer->currentFrame]);
+
+			// The frame is done once the device timeline reaches this value
+			const uint64_t frameValue = vk2dLogicalDeviceNextTimelineValue(gRenderer->ld, true);
+			VkSemaphore signalSemaphores[] = {gRenderer->renderFinishedSemaphores[gRenderer->scImageIndex], gRenderer->ld->timeline};
+			const uint64_t signalValues[] = {0, frameValue};
+			VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+			        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			        .signalSemaphoreValueCount = 2,
+			        .pSignalSemaphoreValues = signalValues
+			};
+			submitInfo.pSignalSemaphores = signalSemaphores;
+			submitInfo.signalSemaphoreCount = 2;
+			submitInfo.pNext = &timelineSubmitInfo;
+
+			// Submit queue
+			VK2D_TRACE_BEGIN(submitZone, "Queue submit");
+			result = vkQueueSubmit(gRenderer->ld->queue, 1, &submitInfo, VK_NULL_HANDLE);
+			VK2D_TRACE_END(submitZone);
+			gRenderer->frames[gRenderer->currentFrame].timelineValue = frameValue;
+			gRenderer->frames[gRenderer->currentFrame].frame = gRenderer->frameCount;
+			gRenderer->imagesInFlight[gRenderer->scImageIndex] = frameValue;
 
             // Error check queue
 			if (result < 0) {
@@ -538,24 +706,26 @@ VK2DResult vk2dRendererEndFrame() {
                 return VK2D_ERROR;
 			}
 
-			// Synchronization depends on if nuklear is enabled
-            VkSemaphore presentWaitSemaphores[1] = {gRenderer->renderFinishedSemaphores[gRenderer->scImageIndex]};
-
-            // Draw nuklear
-			if (gRenderer->options.enableNuklear) {
-				VkSemaphore nkSemaphore = nk_sdl_render(
-				    gRenderer->ld->queue, gRenderer->scImageIndex,
-				    gRenderer->renderFinishedSemaphores[gRenderer->scImageIndex],
-				    NK_ANTI_ALIASING_ON);
-                presentWaitSemaphores[0] = nkSemaphore;
-			}
-
 			// Final present info bit
 			VkPresentInfoKHR presentInfo = vk2dInitPresentInfoKHR(&gRenderer->swapchain, 1, &gRenderer->scImageIndex,
 																  &result,
-																  presentWaitSemaphores,
+																  &gRenderer->renderFinishedSemaphores[gRenderer->scImageIndex],
 																  1);
+
+			// Tag the present so the next frame can wait for it to be displayed
+			const uint64_t presentId = gRenderer->presentId + 1;
+			VkPresentIdKHR presentIdInfo = {
+			        .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+			        .swapchainCount = 1,
+			        .pPresentIds = &presentId
+			};
+			if (gRenderer->options.lowLatencyPacing && gRenderer->ld->waitForPresent != NULL)
+			    presentInfo.pNext = &presentIdInfo;
+			VK2D_TRACE_BEGIN(presentZone, "Queue present");
 			VkResult queueRes = vkQueuePresentKHR(gRenderer->ld->queue, &presentInfo);
+			VK2D_TRACE_END(presentZone);
+			if (presentInfo.pNext != NULL && queueRes >= 0)
+			    gRenderer->presentId = presentId;
 			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || gRenderer->resetSwapchain ||
 				queueRes == VK_ERROR_OUT_OF_DATE_KHR) {
 				_vk2dRendererResetSwapchain();
@@ -565,11 +735,21 @@ VK2DResult vk2dRendererEndFrame() {
                 vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to present frame, Vulkan error %i/%i.", queueRes, result);
 			}
 
-			gRenderer->currentFrame = (gRenderer->currentFrame + 1) % VK2D_MAX_FRAMES_IN_FLIGHT;
+			gRenderer->currentFrame = (gRenderer->currentFrame + 1) % gRenderer->options.framesInFlight;
+
+			// Publish this frame's stats
+			const VK2DFrameStats emptyStats = {0};
+			gRenderer->previousFrameStats = gRenderer->frameStats;
+			gRenderer->frameStats = emptyStats;
 
 			// Calculate time
-			gRenderer->accumulatedTime += (((double) SDL_GetPerformanceCounter() - gRenderer->previousTime) /
+			const double frameTime = (((double) SDL_GetPerformanceCounter() - gRenderer->previousTime) /
 										   (double) SDL_GetPerformanceFrequency()) * 1000;
+			VK2DFrameTime *history = &gRenderer->frameTimes[gRenderer->frameCount % gRenderer->options.frameTimeHistory];
+			history->frame = gRenderer->frameCount;
+			history->cpu = frameTime;
+			history->gpu = -1;
+			gRenderer->accumulatedTime += frameTime;
 			gRenderer->amountOfFrames++;
 			if (gRenderer->accumulatedTime >= 1000) {
 				gRenderer->frameTimeAverage = gRenderer->accumulatedTime / gRenderer->amountOfFrames;
@@ -588,68 +768,113 @@ VK2DLogicalDevice vk2dRendererGetDevice() {
 	return NULL;
 }
 
-void vk2dRendererSetTarget(VK2DTexture target) {
-	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-		if (target != gRenderer->target) {
-            vk2dRendererFlushSpriteBatch();
+// Switches to a different target, ops is NULL for the vk2dRendererSetTarget behaviour
+static void _vk2dRendererSwitchTarget(VK2DTexture target, const VK2DTargetOps *ops) {
+	VK2D_TRACE_BEGIN(zone, "vk2dRendererSetTarget");
+	_vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_TARGET_SWITCH);
 
-			// In case the user attempts to switch targets from one texture to another
-			if (target != VK2D_TARGET_SCREEN && gRenderer->target != VK2D_TARGET_SCREEN) {
-				vk2dRendererSetTarget(VK2D_TARGET_SCREEN);
-			}
+	// Dont let the user bind textures that are not targets
+	if (target != VK2D_TARGET_SCREEN && !vk2dTextureIsTarget(target)) {
+		vk2dLogInfo("Texture cannot be used as a target.");
+		VK2D_TRACE_END(zone);
+		return;
+	}
 
-			// Dont let the user bind textures that are not targets
-			if (target != VK2D_TARGET_SCREEN && !vk2dTextureIsTarget(target)) {
-                vk2dLogInfo("Texture cannot be used as a target.");
-				return;
-			}
+	VK2DTexture previousTarget = gRenderer->target;
+	gRenderer->target = target;
+
+	// Figure out which render pass to use, the same ops always get the same pass
+	VkRenderPass pass = _vk2dRendererGetTargetRenderPass(target == VK2D_TARGET_SCREEN, ops);
+	VkFramebuffer framebuffer =
+			target == VK2D_TARGET_SCREEN ? _vk2dRendererGetScreenFramebuffer() : target->fbo;
+	VkImage image = target == VK2D_TARGET_SCREEN ? gRenderer->swapchainImages[gRenderer->scImageIndex]
+												 : target->img->img;
+	VkDescriptorSet buffer =
+			target == VK2D_TARGET_SCREEN ? gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet
+										 : target->uboSet;
+
+	// The frame graph only needs to know where draws go, passes are recorded at the end of the frame
+	if (gRenderer->options.enableFrameGraph) {
+		gRenderer->targetRenderPass = pass;
+		gRenderer->targetFrameBuffer = framebuffer;
+		gRenderer->targetImage = image;
+		gRenderer->targetUBOSet = buffer;
+		_vk2dRendererFrameGraphSetTarget(target, ops);
+		_vk2dRendererResetBoundPointers();
+		VK2D_TRACE_END(zone);
+		return;
+	}
 
-			gRenderer->target = target;
-
-			// Figure out which render pass to use
-			VkRenderPass pass = target == VK2D_TARGET_SCREEN ? gRenderer->midFrameSwapRenderPass
-															 : gRenderer->externalTargetRenderPass;
-			VkFramebuffer framebuffer =
-					target == VK2D_TARGET_SCREEN ? gRenderer->framebuffers[gRenderer->scImageIndex] : target->fbo;
-			VkImage image = target == VK2D_TARGET_SCREEN ? gRenderer->swapchainImages[gRenderer->scImageIndex]
-														 : target->img->img;
-			VkDescriptorSet buffer =
-					target == VK2D_TARGET_SCREEN ? gRenderer->uboDescriptorSets[gRenderer->currentFrame]
-												 : target->uboSet;
-
-			vkCmdEndRenderPass(gRenderer->commandBuffer[gRenderer->scImageIndex]);
-
-			// Now we either have to transition the image layout depending on whats going in and whats poppin out
-			if (target == VK2D_TARGET_SCREEN)
-				_vk2dTransitionImageLayout(gRenderer->targetImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-										   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-			else
-				_vk2dTransitionImageLayout(target->img->img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-										   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-
-			// Assign new render targets
-			gRenderer->targetRenderPass = pass;
-			gRenderer->targetFrameBuffer = framebuffer;
-			gRenderer->targetImage = image;
-			gRenderer->targetUBOSet = buffer;
-
-			// Setup new render pass
-			VkRect2D rect = {0};
-			rect.extent.width = target == VK2D_TARGET_SCREEN ? gRenderer->surfaceWidth : target->img->width;
-			rect.extent.height = target == VK2D_TARGET_SCREEN ? gRenderer->surfaceHeight : target->img->height;
-			VkClearValue clear[2] = {0};
-			clear[1].depthStencil.depth = 1;
-			VkRenderPassBeginInfo renderPassBeginInfo = vk2dInitRenderPassBeginInfo(
-					pass,
-					framebuffer,
-					rect,
-					clear,
-					2);
-
-			vkCmdBeginRenderPass(gRenderer->commandBuffer[gRenderer->scImageIndex], &renderPassBeginInfo,
-								 VK_SUBPASS_CONTENTS_INLINE);
+	if (gRenderer->dynamicRendering)
+		gRenderer->ld->endRendering(gRenderer->frames[gRenderer->currentFrame].commandBuffer);
+	else
+		vkCmdEndRenderPass(gRenderer->frames[gRenderer->currentFrame].commandBuffer);
+	_vk2dRendererEndGPUScope(gRenderer->frames[gRenderer->currentFrame].commandBuffer, gRenderer->gpuPassScope);
+	gRenderer->gpuPassScope = _vk2dRendererBeginGPUScope(gRenderer->frames[gRenderer->currentFrame].commandBuffer, target == VK2D_TARGET_SCREEN ? "Screen pass" : "Target pass", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+	// Now we either have to transition the image layout depending on whats going in and whats poppin out,
+	// going from one texture straight to another does both at once without resuming the swapchain pass
+	if (target == VK2D_TARGET_SCREEN)
+		_vk2dTransitionImageLayout(gRenderer->targetImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+								   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	else if (previousTarget != VK2D_TARGET_SCREEN)
+		_vk2dTransitionTargetSwap(gRenderer->targetImage, target->img->img);
+	else
+		_vk2dTransitionImageLayout(target->img->img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+								   VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+	// Assign new render targets
+	gRenderer->targetRenderPass = pass;
+	gRenderer->targetFrameBuffer = framebuffer;
+	gRenderer->targetImage = image;
+	gRenderer->targetUBOSet = buffer;
+
+	// Setup new render pass
+	if (gRenderer->dynamicRendering) {
+		_vk2dRendererBeginRendering(gRenderer->frames[gRenderer->currentFrame].commandBuffer, target, NULL, ops, 0);
+	} else {
+		VkRect2D rect = {0};
+		rect.extent.width = target == VK2D_TARGET_SCREEN ? gRenderer->surfaceWidth : target->img->width;
+		rect.extent.height = target == VK2D_TARGET_SCREEN ? gRenderer->surfaceHeight : target->img->height;
+		VkClearValue clear[2] = {0};
+		if (ops != NULL) {
+			clear[0].color.float32[0] = ops->clearColour[0];
+			clear[0].color.float32[1] = ops->clearColour[1];
+			clear[0].color.float32[2] = ops->clearColour[2];
+			clear[0].color.float32[3] = ops->clearColour[3];
+		}
+		clear[1].depthStencil.depth = 1;
+		VkRenderPassBeginInfo renderPassBeginInfo = vk2dInitRenderPassBeginInfo(
+				pass,
+				framebuffer,
+				rect,
+				clear,
+				2);
+
+		vkCmdBeginRenderPass(gRenderer->frames[gRenderer->currentFrame].commandBuffer, &renderPassBeginInfo,
+							 VK_SUBPASS_CONTENTS_INLINE);
+	}
+	gRenderer->frameStats.renderPassBegins++;
 
-			_vk2dRendererResetBoundPointers();
+	_vk2dRendererResetBoundPointers();
+	VK2D_TRACE_END(zone);
+}
+
+void vk2dRendererSetTarget(VK2DTexture target) {
+	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
+		if (target != gRenderer->target)
+			_vk2dRendererSwitchTarget(target, NULL);
+	}
+}
+
+void vk2dRendererSetTargetOps(VK2DTexture target, const VK2DTargetOps *ops) {
+	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
+		if (target != gRenderer->target) {
+			_vk2dRendererSwitchTarget(target, ops);
+		} else if (ops != NULL) {
+			// Already in the target's pass, so clearing inside of it is all that's left to do
+			_vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_TARGET_SWITCH);
+			_vk2dRendererClearTarget(ops);
 		}
 	}
 }
@@ -673,7 +898,7 @@ void vk2dRendererGetColourMod(vec4 dst) {
 }
 
 void vk2dRendererSetBlendMode(VK2DBlendMode blendMode) {
-    vk2dRendererFlushSpriteBatch();
+    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_BLEND_CHANGE);
 	if (vk2dRendererGetPointer() != NULL)
 		gRenderer->blendMode = blendMode;
 }
@@ -702,34 +927,140 @@ VK2DCameraSpec vk2dRendererGetCamera() {
 }
 
 void vk2dRendererSetTextureCamera(bool useCameraOnTextures) {
-    vk2dRendererFlushSpriteBatch();
+    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_CAMERA_CHANGE);
 	if (vk2dRendererGetPointer() != NULL)
 		gRenderer->enableTextureCameraUBO = useCameraOnTextures;
 }
 
 void vk2dRendererLockCameras(VK2DCameraIndex cam) {
-    vk2dRendererFlushSpriteBatch();
+    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_CAMERA_CHANGE);
 	if (vk2dRendererGetPointer() != NULL)
 		gRenderer->cameraLocked = cam;
 }
 
 void vk2dRendererUnlockCameras() {
-    vk2dRendererFlushSpriteBatch();
+    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_CAMERA_CHANGE);
 	if (vk2dRendererGetPointer() != NULL)
 		gRenderer->cameraLocked = VK2D_INVALID_CAMERA;
 }
 
+static int _vk2dCompareDoubles(const void *a, const void *b) {
+	const double x = *(const double*)a;
+	const double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+// Computes stats from the last window frames in the history, using either the cpu or gpu times
+static void _vk2dRendererComputeFrameTimeStats(uint32_t window, bool gpu, double *scratch, VK2DFrameTimeStats *out) {
+	const VK2DFrameTimeStats empty = {0};
+	*out = empty;
+	const uint32_t size = gRenderer->options.frameTimeHistory;
+	double total = 0;
+	for (uint32_t i = 0; i < window && i < gRenderer->frameCount; i++) {
+		const VK2DFrameTime *frameTime = &gRenderer->frameTimes[(gRenderer->frameCount - i) % size];
+		const double time = gpu ? frameTime->gpu : frameTime->cpu;
+		if (frameTime->frame != gRenderer->frameCount - i || time < 0)
+			continue;
+		scratch[out->frames++] = time;
+		total += time;
+	}
+	if (out->frames == 0)
+		return;
+
+	// Nearest-rank percentiles
+	qsort(scratch, out->frames, sizeof(double), _vk2dCompareDoubles);
+	out->mean = total / out->frames;
+	out->p50 = scratch[(uint32_t)ceil(0.50 * out->frames) - 1];
+	out->p95 = scratch[(uint32_t)ceil(0.95 * out->frames) - 1];
+	out->p99 = scratch[(uint32_t)ceil(0.99 * out->frames) - 1];
+	out->max = scratch[out->frames - 1];
+}
+
+void vk2dRendererGetFrameTimeStats(uint32_t window, VK2DFrameTimeStats *cpu, VK2DFrameTimeStats *gpu) {
+	const VK2DFrameTimeStats empty = {0};
+	if (cpu != NULL) *cpu = empty;
+	if (gpu != NULL) *gpu = empty;
+	if (vk2dRendererGetPointer() != NULL && gRenderer->frameTimes != NULL) {
+		if (window == 0 || window > gRenderer->options.frameTimeHistory)
+			window = gRenderer->options.frameTimeHistory;
+		double *scratch = malloc(sizeof(double) * window);
+		if (scratch == NULL) {
+			vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate space for frame time stats.");
+			return;
+		}
+		if (cpu != NULL)
+			_vk2dRendererComputeFrameTimeStats(window, false, scratch, cpu);
+		if (gpu != NULL)
+			_vk2dRendererComputeFrameTimeStats(window, true, scratch, gpu);
+		free(scratch);
+	}
+}
+
+bool vk2dRendererDumpFrameTimes(const char *filename) {
+	if (vk2dRendererGetPointer() != NULL && gRenderer->frameTimes != NULL) {
+		FILE *file = fopen(filename, "w");
+		if (file == NULL) {
+			vk2dRaise(VK2D_STATUS_FILE_NOT_FOUND, "Failed to open \"%s\" to dump frame times.", filename);
+			return false;
+		}
+
+		// Oldest to newest, GPU times that aren't known are left blank
+		const uint32_t size = gRenderer->options.frameTimeHistory;
+		fprintf(file, "frame,cpu_ms,gpu_ms\n");
+		const uint64_t first = gRenderer->frameCount >= size ? gRenderer->frameCount - size + 1 : 1;
+		for (uint64_t frame = first; frame <= gRenderer->frameCount; frame++) {
+			const VK2DFrameTime *frameTime = &gRenderer->frameTimes[frame % size];
+			if (frameTime->frame != frame)
+				continue;
+			if (frameTime->gpu >= 0)
+				fprintf(file, "%llu,%f,%f\n", (unsigned long long)frame, frameTime->cpu, frameTime->gpu);
+			else
+				fprintf(file, "%llu,%f,\n", (unsigned long long)frame, frameTime->cpu);
+		}
+		fclose(file);
+		return true;
+	}
+	return false;
+}
+
+VK2DFrameStats vk2dRendererGetFrameStats() {
+	if (vk2dRendererGetPointer() != NULL)
+		return gRenderer->previousFrameStats;
+	VK2DFrameStats stats = {0};
+	return stats;
+}
+
 double vk2dRendererGetAverageFrameTime() {
 	if (vk2dRendererGetPointer() != NULL)
 		return gRenderer->frameTimeAverage;
 	return 0;
 }
 
+void vk2dRendererSetFrameLimit(double fps) {
+	if (vk2dRendererGetPointer() != NULL) {
+		gRenderer->frameLimit = fps > 0 ? fps : 0;
+		gRenderer->nextFrameDeadline = 0;
+	}
+}
+
+double vk2dRendererGetFrameLimit() {
+	if (vk2dRendererGetPointer() != NULL)
+		return gRenderer->frameLimit;
+	return 0;
+}
+
+void vk2dRendererSetInputCallback(VK2DInputCallback callback, void *userdata) {
+	if (vk2dRendererGetPointer() != NULL) {
+		gRenderer->inputCallback = callback;
+		gRenderer->inputCallbackData = userdata;
+	}
+}
+
 void vk2dRendererClear() {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
-		VkDescriptorSet set = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
+		VkDescriptorSet set = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet;
 		_vk2dRendererDrawRaw(&set, 1, gRenderer->unitSquare, gRenderer->primFillPipe, 0, 0, 1, 1, 0, 0, 0, 1, 0, 0, 0,
 							 0, VK2D_INVALID_CAMERA);
 	}
@@ -737,21 +1068,11 @@ void vk2dRendererClear() {
 
 void vk2dRendererEmpty() {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
-		// Save old renderer state to revert back
-		VK2DBlendMode bm = vk2dRendererGetBlendMode();
-		vec4 c;
-		vk2dRendererGetColourMod(c);
-
-		// Set the render mode to be blend mode none, and the colour to be a flat 0
-		const vec4 clearColour = {0, 0, 0, 0};
-		vk2dRendererSetColourMod(clearColour);
-		vk2dRendererSetBlendMode(VK2D_BLEND_MODE_NONE);
-		vk2dRendererClear();
-
-		vk2dRendererSetColourMod(c);
-		vk2dRendererSetBlendMode(bm);
+		// Clearing the attachment inside the pass is cheaper than blending a quad over each camera
+		const VK2DTargetOps ops = {VK2D_TARGET_OP_CLEAR, {0, 0, 0, 0}, VK2D_TARGET_OP_LOAD, false};
+		_vk2dRendererClearCameras(&ops);
 	}
 }
 
@@ -765,35 +1086,35 @@ VK2DRendererLimits vk2dRendererGetLimits() {
 
 void vk2dRendererDrawRectangle(float x, float y, float w, float h, float r, float ox, float oy) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 		vk2dRendererDrawPolygon(gRenderer->unitSquare, x, y, true, 1, w, h, r, ox / (w / 3), oy / (h / 3));
 	}
 }
 
 void vk2dRendererDrawRectangleOutline(float x, float y, float w, float h, float r, float ox, float oy, float lineWidth) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 		vk2dRendererDrawPolygon(gRenderer->unitSquareOutline, x, y, false, lineWidth, w, h, r, ox / (w / 3), oy / (h / 3));
 	}
 }
 
 void vk2dRendererDrawCircle(float x, float y, float r) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 		vk2dRendererDrawPolygon(gRenderer->unitCircle, x, y, true, 1, r * 2, r * 2, 0, 0, 0);
 	}
 }
 
 void vk2dRendererDrawCircleOutline(float x, float y, float r, float lineWidth) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 		vk2dRendererDrawPolygon(gRenderer->unitCircleOutline, x, y, false, lineWidth, r * 2, r * 2, 0, 0, 0);
 	}
 }
 
 void vk2dRendererDrawLine(float x1, float y1, float x2, float y2) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 		float x = sqrtf(powf(y2 - y1, 2) + powf(x2 - x1, 2));
 		float r = atan2f(y2 - y1, x2 - x1);
 		vk2dRendererDrawPolygon(gRenderer->unitLine, x1, y1, false, 1, x, 1, r, 0, 0);
@@ -803,7 +1124,7 @@ void vk2dRendererDrawLine(float x1, float y1, float x2, float y2) {
 void vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float xInTex, float yInTex, float texWidth, float texHeight) {
     if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         if (shader != NULL) {
-            _vk2dRendererFlushBatchIfNeeded(shader->pipe);
+            _vk2dRendererFlushBatchIfNeeded(shader->pipe, VK2D_FLUSH_REASON_SHADER_DRAW);
 
             VkDescriptorSet sets[4];
             sets[1] = gRenderer->samplerSet;
@@ -812,10 +1133,10 @@ void vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, floa
             // Create the data uniform
             uint32_t setCount = 3;
             if (shader->uniformSize != 0) {
-                sets[3] = vk2dDescConGetSet(gRenderer->descConShaders[gRenderer->currentFrame]);
+                sets[3] = vk2dDescConGetSet(gRenderer->frames[gRenderer->currentFrame].descConShaders);
                 VkBuffer buffer;
                 VkDeviceSize offset;
-                vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], data, shader->uniformSize, &buffer, &offset);
+                vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, data, shader->uniformSize, &buffer, &offset);
                 VkDescriptorBufferInfo bufferInfo = {buffer,offset,shader->uniformSize};
                 VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
                 write.pBufferInfo = &bufferInfo;
@@ -827,6 +1148,8 @@ void vk2dRendererDrawShader(VK2DShader shader, void *data, VK2DTexture tex, floa
                 setCount = 4;
             }
 
+            if (tex != NULL)
+                _vk2dRendererTouchTexture(vk2dTextureGetID(tex));
             _vk2dRendererDrawShader(sets, setCount, tex, shader->pipe, x, y, xscale, yscale, rot, originX, originY, 1,
                               xInTex,
                               yInTex, texWidth, texHeight);
@@ -840,7 +1163,7 @@ void vk2dRendererAddBatch(VK2DDrawCommand *commands, uint32_t count) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         const VK2DPipeline pipe = gRenderer->instancedPipe;
         for (int i = 0; i < count; i++) {
-            _vk2dRendererFlushBatchIfNeeded(pipe);
+            _vk2dRendererFlushBatchIfNeeded(pipe, VK2D_FLUSH_REASON_PIPELINE_CHANGE);
             _vk2dRendererAddDrawCommand(&commands[i]);
         }
 	}
@@ -851,7 +1174,7 @@ void vk2dRendererDrawTexture(VK2DTexture tex, float x, float y, float xscale, fl
 		if (tex != NULL) {
 		    // Flush sprite batch if this is a pipeline change or commands at limit
 		    const VK2DPipeline pipe = gRenderer->instancedPipe;
-            _vk2dRendererFlushBatchIfNeeded(pipe);
+            _vk2dRendererFlushBatchIfNeeded(pipe, VK2D_FLUSH_REASON_PIPELINE_CHANGE);
 
 		    VK2DDrawCommand command;
 		    command.textureIndex = vk2dTextureGetID(tex);
@@ -879,7 +1202,7 @@ void vk2dRendererDrawTexture(VK2DTexture tex, float x, float y, float xscale, fl
 
 void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
         if (polygon != NULL) {
 			VkDescriptorSet set;
@@ -895,13 +1218,13 @@ void vk2dRendererDrawPolygon(VK2DPolygon polygon, float x, float y, bool filled,
 void vk2dRendererDrawGeometry(VK2DVertexColour *vertices, int count, float x, float y, bool filled, float lineWidth, float xscale, float yscale, float rot, float originX, float originY) {
     if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
         if (vertices != NULL && count > 0) {
-            vk2dRendererFlushSpriteBatch();
+            _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
             if (count <= gRenderer->limits.maxGeometryVertices) {
                 // Copy vertex data to the current descriptor buffer
                 VkBuffer buffer;
                 VkDeviceSize offset;
-                vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], vertices,
+                vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, vertices,
                                              count * sizeof(VK2DVertexColour), &buffer, &offset);
                 struct VK2DBuffer_t buf;
                 buf.buf = buffer;
@@ -924,10 +1247,28 @@ void vk2dRendererDrawGeometry(VK2DVertexColour *vertices, int count, float x, fl
 
 void vk2dRendererDrawShadows(VK2DShadowEnvironment shadowEnvironment, vec4 colour, vec2 lightSource) {
     if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
-        vk2dRendererFlushSpriteBatch();
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
-        if (shadowEnvironment != NULL && shadowEnvironment->vbo != NULL) {
-            _vk2dRendererDrawShadows(shadowEnvironment, colour, lightSource);
+        if (shadowEnvironment != NULL && shadowEnvironment->flushed) {
+            VK2DShadowLight light = {.position = {lightSource[0], lightSource[1]}, .radius = 0, .colour = {colour[0], colour[1], colour[2], colour[3]}};
+            const int32_t scope = _vk2dRendererBeginGPUScope(gRenderer->drawBuffer, "Shadows", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            _vk2dRendererDrawShadowLights(shadowEnvironment, &light, 1);
+            _vk2dRendererEndGPUScope(gRenderer->drawBuffer, scope);
+            _vk2dRendererResetBoundPointers();
+        } else {
+            vk2dRaise(VK2D_STATUS_BAD_ASSET, "Shadow environment not prepared.");
+        }
+    }
+}
+
+void vk2dRendererDrawShadowLights(VK2DShadowEnvironment shadowEnvironment, const VK2DShadowLight *lights, int count) {
+    if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
+        _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
+
+        if (shadowEnvironment != NULL && shadowEnvironment->flushed) {
+            const int32_t scope = _vk2dRendererBeginGPUScope(gRenderer->drawBuffer, "Shadows", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            _vk2dRendererDrawShadowLights(shadowEnvironment, lights, count);
+            _vk2dRendererEndGPUScope(gRenderer->drawBuffer, scope);
             _vk2dRendererResetBoundPointers();
         } else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Shadow environment not prepared.");
@@ -938,12 +1279,13 @@ void vk2dRendererDrawShadows(VK2DShadowEnvironment shadowEnvironment, vec4 colou
 void vk2dRendererDrawModel(VK2DModel model, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
 		if (model != NULL) {
-            vk2dRendererFlushSpriteBatch();
+            _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
-			VkDescriptorSet sets[3];
+			VkDescriptorSet sets[4];
 			sets[1] = gRenderer->modelSamplerSet;
 			sets[2] = gRenderer->texArrayDescriptorSet;
-			_vk2dRendererDraw3D(sets, 3, model, gRenderer->modelPipe, x, y, z, xscale, yscale, zscale, rot, axis, originX,
+			_vk2dRendererTouchTexture(vk2dTextureGetID(model->tex));
+			_vk2dRendererDraw3D(sets, 4, model, gRenderer->modelPipe, x, y, z, xscale, yscale, zscale, rot, axis, originX,
 								originY, originZ, 1);
 		} else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Model does not exist.");
@@ -951,15 +1293,38 @@ void vk2dRendererDrawModel(VK2DModel model, float x, float y, float z, float xsc
 	}
 }
 
+void vk2dRendererDrawModelInstanced(VK2DModel model, const mat4 *transforms, int count) {
+	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
+		if (model != NULL && (transforms != NULL || count <= 0)) {
+            _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
+
+			VkDescriptorSet sets[4];
+			sets[1] = gRenderer->modelSamplerSet;
+			sets[2] = gRenderer->texArrayDescriptorSet;
+			_vk2dRendererTouchTexture(vk2dTextureGetID(model->tex));
+			_vk2dRendererDraw3DInstanced(sets, 4, model, gRenderer->modelPipe, transforms, count, 1);
+		} else if (model == NULL) {
+            vk2dRaise(VK2D_STATUS_BAD_ASSET, "Model does not exist.");
+		} else {
+            vk2dRaise(VK2D_STATUS_BAD_ASSET, "Transforms do not exist.");
+		}
+	}
+}
+
+void vk2dRendererGetModelTransform(mat4 transform, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ) {
+	_vk2dRendererModelMatrix(transform, x, y, z, xscale, yscale, zscale, rot, axis, originX, originY, originZ);
+}
+
 void vk2dRendererDrawWireframe(VK2DModel model, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ, float lineWidth) {
 	if (vk2dRendererGetPointer() != NULL && !vk2dStatusFatal()) {
 		if (model != NULL) {
-		    vk2dRendererFlushSpriteBatch();
+		    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_PRIMITIVE);
 
-			VkDescriptorSet sets[3];
+			_vk2dRendererTouchTexture(vk2dTextureGetID(model->tex));
+			VkDescriptorSet sets[4];
 			sets[1] = gRenderer->modelSamplerSet;
 			sets[2] = model->tex->img->set;
-			_vk2dRendererDraw3D(sets, 3, model, gRenderer->wireframePipe, x, y, z, xscale, yscale, zscale, rot, axis, originX,
+			_vk2dRendererDraw3D(sets, 4, model, gRenderer->wireframePipe, x, y, z, xscale, yscale, zscale, rot, axis, originX,
 								originY, originZ, lineWidth);
 		} else {
             vk2dRaise(VK2D_STATUS_BAD_ASSET, "Model does not exist.");
@@ -1002,20 +1367,29 @@ static void _vk2dRendererFlushPerCamera(VkCommandBuffer buf, int cameraIndex) {
     vkCmdSetScissor(buf, 0, 1, &scissor);
     vkCmdPushConstants(buf, gRenderer->currentBatchPipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(struct VK2DInstancedPushBuffer), &push);
     vkCmdDraw(buf, 6 * gRenderer->drawCommandCount, 1, 0, 0);
+    gRenderer->frameStats.drawCalls++;
 }
 
 void vk2dRendererFlushSpriteBatch() {
+    _vk2dRendererFlushSpriteBatch(VK2D_FLUSH_REASON_EXPLICIT);
+}
+
+void _vk2dRendererFlushSpriteBatch(VK2DFlushReason reason) {
     // This function does several things
     //  1. Copies the current sprite batch to the descriptor buffer
     //  2. Reserves space on the descriptor buffer for the compute output
     //  3. Dispatch the compute shader on the compute command buffer
     //  4. Send out the draw command that uses the soon-to-be-filled compute output as vertex input
     if (gRenderer->currentBatchPipeline != NULL && gRenderer->drawCommandCount > 0) {
+        VK2D_TRACE_BEGIN(zone, "Flush sprite batch");
+        gRenderer->frameStats.spriteFlushes[reason]++;
+        gRenderer->frameStats.spritesSubmitted += gRenderer->drawCommandCount;
+
         // Copy the draw commands into a buffer
         VkBuffer drawCommands, drawInstances;
         VkDeviceSize drawCommandsOffset, drawInstancesOffset;
         vk2dDescriptorBufferCopyData(
-                gRenderer->descriptorBuffers[gRenderer->currentFrame],
+                gRenderer->frames[gRenderer->currentFrame].descriptorBuffer,
                 gRenderer->drawCommands,
                 gRenderer->drawCommandCount * sizeof(struct VK2DDrawCommand),
                 &drawCommands,
@@ -1024,7 +1398,7 @@ void vk2dRendererFlushSpriteBatch() {
 
         // Reserve space for the draw instances
         vk2dDescriptorBufferReserveSpace(
-                gRenderer->descriptorBuffers[gRenderer->currentFrame],
+                gRenderer->frames[gRenderer->currentFrame].descriptorBuffer,
                 gRenderer->drawCommandCount * sizeof(VK2DDrawInstance),
                 &drawInstances,
                 &drawInstancesOffset
@@ -1032,8 +1406,8 @@ void vk2dRendererFlushSpriteBatch() {
 
         // Create descriptor sets
         const uint32_t drawCount = gRenderer->drawCommandCount;
-        VkDescriptorSet descriptorSet = vk2dDescConGetSet(gRenderer->descConCompute[gRenderer->currentFrame]);
-        VkDescriptorSet vertexShaderSBOSet = vk2dDescConGetSet(gRenderer->descConSBO[gRenderer->currentFrame]);
+        VkDescriptorSet descriptorSet = vk2dDescConGetSet(gRenderer->frames[gRenderer->currentFrame].descConCompute);
+        VkDescriptorSet vertexShaderSBOSet = vk2dDescConGetSet(gRenderer->frames[gRenderer->currentFrame].descConSBO);
         VkDescriptorBufferInfo bufferInfos[2] = {
                 {
                         .buffer = drawCommands,
@@ -1066,24 +1440,27 @@ void vk2dRendererFlushSpriteBatch() {
         vkUpdateDescriptorSets(gRenderer->ld->dev, 2, writes, 0, VK_NULL_HANDLE);
 
         // Queue compute dispatches to the compute command buffer, synchronization will be recorded at the end of the frame
-        VkCommandBuffer computeBuf = gRenderer->computeCommandBuffer[gRenderer->scImageIndex];
+        VkCommandBuffer computeBuf = gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer;
         VK2DComputePushBuffer push = { .drawCount = drawCount };
         vkCmdPushConstants(computeBuf, gRenderer->spriteBatchPipe->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VK2DComputePushBuffer), &push);
         vkCmdBindDescriptorSets(computeBuf, VK_PIPELINE_BIND_POINT_COMPUTE, gRenderer->spriteBatchPipe->layout, 0, 1, &descriptorSet, 0, VK_NULL_HANDLE);
+        gRenderer->frameStats.descriptorSetBinds++;
         vkCmdDispatch(computeBuf, (drawCount / 64) + 1, 1, 1);
 
         // Dispatch compute and draw command
-        VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+        VkCommandBuffer buf = gRenderer->drawBuffer;
         _vk2dRendererResetBoundPointers();
         vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(gRenderer->instancedPipe, gRenderer->blendMode));
+        gRenderer->frameStats.pipelineBinds++;
         VkDescriptorSet sets[] = {
-            gRenderer->target != NULL && !gRenderer->enableTextureCameraUBO ? gRenderer->targetUBOSet : gRenderer->uboDescriptorSets[gRenderer->currentFrame],
+            gRenderer->target != NULL && !gRenderer->enableTextureCameraUBO ? gRenderer->targetUBOSet : gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet,
             gRenderer->samplerSet,
             gRenderer->texArrayDescriptorSet,
             vertexShaderSBOSet
         };
         // These things are the same across every camera, so they are only bound once
         vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->instancedPipe->layout, 0, 4, sets, 0, VK_NULL_HANDLE);
+        gRenderer->frameStats.descriptorSetBinds++;
         vkCmdSetLineWidth(buf, 1);
 
         // Draw once per camera
@@ -1102,6 +1479,7 @@ void vk2dRendererFlushSpriteBatch() {
         gRenderer->drawCommandCount = 0;
         gRenderer->currentBatchPipeline = NULL;
         gRenderer->currentBatchPipelineID = VK2D_PIPELINE_ID_NONE;
+        VK2D_TRACE_END(zone);
     }
 }
 
@@ -2,6 +2,7 @@
 /// \author Paolo Mazzon
 #include <vulkan/vulkan.h>
 #include <SDL3/SDL_vulkan.h>
+#include <math.h>
 
 #include "VK2D/RendererMeta.h"
 #include "VK2D/Validation.h"
@@ -9,6 +10,7 @@
 #include "VK2D/Constants.h"
 #include "VK2D/LogicalDevice.h"
 #include "VK2D/Image.h"
+#include "VK2D/Texture.h"
 #include "VK2D/Pipeline.h"
 #include "VK2D/Blobs.h"
 #include "VK2D/Buffer.h"
@@ -20,6 +22,7 @@
 #include "VK2D/Opaque.h"
 #include "VK2D/Logger.h"
 #include "VK2D/nuklear_defs.h"
+#include "VK2D/Trace.h"
 
 // For debugging
 PFN_vkCreateDebugReportCallbackEXT fvkCreateDebugReportCallbackEXT;
@@ -111,6 +114,778 @@ void _vk2dRendererResetBoundPointers() {
 	gRenderer->prevVBO = VK_NULL_HANDLE;
 }
 
+void _vk2dRendererTouchTexture(uint32_t id) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || id >= gRenderer->options.maxTextures)
+        return;
+    VK2DTextureDescriptorInfo *info = &gRenderer->textureArray[id];
+    if (!info->active)
+        return;
+    info->lastUsedFrame = gRenderer->frameCount;
+
+    // Reloading here would stall recording and rewrite a descriptor frames in flight may be using
+    if (info->evicted && !info->reloadQueued) {
+        info->reloadQueued = true;
+        gRenderer->texturesPendingReload++;
+    }
+}
+
+// Gets the timeline value that signals the end of a frame, 0 if it was never submitted or its context was reused
+static uint64_t _vk2dRendererFrameTimelineValue(uint64_t frame) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    for (int i = 0; i < gRenderer->options.framesInFlight; i++)
+        if (gRenderer->frames[i].frame == frame)
+            return gRenderer->frames[i].timelineValue;
+    return 0;
+}
+
+static void _vk2dRendererLockTextureReloads() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (gRenderer->limits.supportsMultiThreadLoading)
+        SDL_LockMutex(gRenderer->ld->loadListMutex);
+}
+
+static void _vk2dRendererUnlockTextureReloads() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (gRenderer->limits.supportsMultiThreadLoading)
+        SDL_UnlockMutex(gRenderer->ld->loadListMutex);
+}
+
+static void _vk2dRendererFreeTextureReload(VK2DTextureReload *reload) {
+    vk2dImageFree(reload->image);
+    free(reload->sourceFile);
+    free(reload->sourceData);
+    free(reload);
+}
+
+// Doubles the space for reloads, returns false if it can't
+static bool _vk2dRendererGrowTextureReloads() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    const uint32_t capacity = gRenderer->textureReloadCapacity == 0 ? 16 : gRenderer->textureReloadCapacity * 2;
+    _vk2dRendererLockTextureReloads();
+    VK2DTextureReload **reloads = realloc(gRenderer->textureReloads, sizeof(VK2DTextureReload*) * capacity);
+    if (reloads != NULL) {
+        gRenderer->textureReloads = reloads;
+        gRenderer->textureReloadCapacity = capacity;
+    }
+    _vk2dRendererUnlockTextureReloads();
+    return reloads != NULL;
+}
+
+// Starts reloading the texture in a slot, on the worker thread if there is one
+static void _vk2dRendererQueueTextureReload(VK2DTextureDescriptorInfo *info) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VK2DTextureReload *reload = calloc(1, sizeof(VK2DTextureReload));
+    if (reload == NULL || (gRenderer->textureReloadCount == gRenderer->textureReloadCapacity &&
+                           !_vk2dRendererGrowTextureReloads())) {
+        free(reload);
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to queue a reload for evicted texture %i.", SDL_GetAtomicInt(&info->tex->descriptorIndex));
+        return;
+    }
+
+    // The texture may be freed while the worker is decoding it so the reload has its own copy of the source
+    VK2DTexture tex = info->tex;
+    reload->tex = tex;
+    if (tex->sourceFile != NULL) {
+        reload->sourceFile = (char*)_vk2dCopyBuffer(tex->sourceFile, strlen(tex->sourceFile) + 1);
+    } else {
+        reload->sourceData = _vk2dCopyBuffer(tex->sourceData, tex->sourceSize);
+        reload->sourceSize = tex->sourceSize;
+    }
+    info->reload = reload;
+
+    if (gRenderer->limits.supportsMultiThreadLoading) {
+        SDL_SetAtomicInt(&reload->state, VK2D_TEXTURE_RELOAD_QUEUED);
+        SDL_AddAtomicInt(&gRenderer->textureReloadsQueued, 1);
+    } else {
+        reload->image = _vk2dTextureReloadImage(reload->sourceFile, reload->sourceData, reload->sourceSize, true);
+        SDL_SetAtomicInt(&reload->state, VK2D_TEXTURE_RELOAD_DONE);
+    }
+    _vk2dRendererLockTextureReloads();
+    gRenderer->textureReloads[gRenderer->textureReloadCount++] = reload;
+    _vk2dRendererUnlockTextureReloads();
+}
+
+void _vk2dRendererRunTextureReload() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (SDL_GetAtomicInt(&gRenderer->textureReloadsQueued) == 0)
+        return;
+
+    VK2DTextureReload *reload = NULL;
+    SDL_LockMutex(gRenderer->ld->loadListMutex);
+    for (uint32_t i = 0; i < gRenderer->textureReloadCount && reload == NULL; i++)
+        if (SDL_CompareAndSwapAtomicInt(&gRenderer->textureReloads[i]->state, VK2D_TEXTURE_RELOAD_QUEUED, VK2D_TEXTURE_RELOAD_LOADING))
+            reload = gRenderer->textureReloads[i];
+    if (reload != NULL)
+        SDL_AddAtomicInt(&gRenderer->textureReloadsQueued, -1);
+    SDL_UnlockMutex(gRenderer->ld->loadListMutex);
+
+    if (reload != NULL) {
+        VK2D_TRACE_BEGIN(zone, "Worker thread texture reload");
+        reload->image = _vk2dTextureReloadImage(reload->sourceFile, reload->sourceData, reload->sourceSize, false);
+        SDL_SetAtomicInt(&reload->state, VK2D_TEXTURE_RELOAD_DONE);
+        VK2D_TRACE_END(zone);
+    }
+}
+
+void _vk2dRendererRestoreTextures() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || (gRenderer->texturesPendingReload == 0 && gRenderer->textureReloadCount == 0))
+        return;
+
+    // Evicted textures drawn last frame start reloading, decoding and uploading happens off the frame if it can
+    for (int i = 0; i < gRenderer->options.maxTextures && gRenderer->texturesPendingReload > 0; i++) {
+        VK2DTextureDescriptorInfo *info = &gRenderer->textureArray[i];
+        if (!info->reloadQueued || info->reload != NULL)
+            continue;
+        if (info->active && info->evicted && info->tex != NULL) {
+            _vk2dRendererQueueTextureReload(info);
+        } else {
+            info->reloadQueued = false;
+            gRenderer->texturesPendingReload--;
+        }
+        if (vk2dStatusFatal())
+            return;
+    }
+
+    // Finished reloads are swapped in, the rest are checked again next frame
+    for (uint32_t i = 0; i < gRenderer->textureReloadCount;) {
+        VK2DTextureReload *reload = gRenderer->textureReloads[i];
+        if (SDL_GetAtomicInt(&reload->state) != VK2D_TEXTURE_RELOAD_DONE) {
+            i++;
+            continue;
+        }
+
+        if (reload->tex != NULL) {
+            const int index = SDL_GetAtomicInt(&reload->tex->descriptorIndex);
+            VK2DTextureDescriptorInfo *info = &gRenderer->textureArray[index];
+            if (reload->image != NULL) {
+                // Only the frames that sampled the evicted slot have to finish before it can be rewritten
+                vk2dLogicalDeviceWaitTimeline(gRenderer->ld, _vk2dRendererFrameTimelineValue(info->lastUsedFrame), true);
+                _vk2dTextureRestore(reload->tex, reload->image);
+                reload->image = NULL;
+            } else {
+                vk2dRaise(VK2D_STATUS_BAD_FORMAT, "Failed to reload evicted texture %i.", index);
+            }
+            info->reload = NULL;
+            info->reloadQueued = false;
+            gRenderer->texturesPendingReload--;
+        }
+
+        _vk2dRendererLockTextureReloads();
+        gRenderer->textureReloads[i] = gRenderer->textureReloads[--gRenderer->textureReloadCount];
+        _vk2dRendererUnlockTextureReloads();
+        _vk2dRendererFreeTextureReload(reload);
+    }
+}
+
+void _vk2dRendererDestroyTextureReloads() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+
+    // Reloads the worker hasn't started are cancelled, one it's working on has to finish first
+    _vk2dRendererLockTextureReloads();
+    for (uint32_t i = 0; i < gRenderer->textureReloadCount; i++)
+        if (SDL_CompareAndSwapAtomicInt(&gRenderer->textureReloads[i]->state, VK2D_TEXTURE_RELOAD_QUEUED, VK2D_TEXTURE_RELOAD_DONE))
+            SDL_AddAtomicInt(&gRenderer->textureReloadsQueued, -1);
+    _vk2dRendererUnlockTextureReloads();
+    for (uint32_t i = 0; i < gRenderer->textureReloadCount; i++) {
+        while (SDL_GetAtomicInt(&gRenderer->textureReloads[i]->state) != VK2D_TEXTURE_RELOAD_DONE)
+            SDL_Delay(1);
+        _vk2dRendererFreeTextureReload(gRenderer->textureReloads[i]);
+    }
+    free(gRenderer->textureReloads);
+    gRenderer->textureReloads = NULL;
+    gRenderer->textureReloadCount = 0;
+    gRenderer->textureReloadCapacity = 0;
+}
+
+void _vk2dRendererEvictTextures() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || gRenderer->options.vramEvictionThreshold <= 0 || gRenderer->defragPassPending)
+        return;
+
+    VkDeviceSize usage = 0;
+    VkDeviceSize budget = 0;
+    vmaGetHeapBudgets(gRenderer->vma, gRenderer->vmaBudgets);
+    for (int i = 0; i < gRenderer->pd->mem.memoryHeapCount; i++) {
+        if ((gRenderer->pd->mem.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) continue;
+        budget += gRenderer->vmaBudgets[i].budget;
+        usage += gRenderer->vmaBudgets[i].usage;
+    }
+    const VkDeviceSize limit = (VkDeviceSize)((double)budget * gRenderer->options.vramEvictionThreshold);
+
+    while (usage > limit) {
+        // Find the least recently used texture that no frame in flight could still be sampling
+        int lru = -1;
+        for (int i = 0; i < gRenderer->options.maxTextures; i++) {
+            VK2DTextureDescriptorInfo *info = &gRenderer->textureArray[i];
+            if (!info->active || info->evicted || info->tex == NULL || !_vk2dTextureIsReloadable(info->tex))
+                continue;
+            if (info->lastUsedFrame + gRenderer->options.framesInFlight >= gRenderer->frameCount)
+                continue;
+            if (lru == -1 || info->lastUsedFrame < gRenderer->textureArray[lru].lastUsedFrame)
+                lru = i;
+        }
+
+        if (lru == -1)
+            break;
+        const VkDeviceSize freed = _vk2dTextureEvict(gRenderer->textureArray[lru].tex);
+        usage = freed < usage ? usage - freed : 0;
+    }
+}
+
+// Finds the image using an allocation in the texture array, and whether or not it can be moved right now
+static VK2DImage _vk2dRendererDefragFindImage(VmaAllocation mem, bool *movable) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VK2DImage image = NULL;
+    *movable = true;
+    for (int i = 0; i < gRenderer->options.maxTextures; i++) {
+        VK2DTextureDescriptorInfo *info = &gRenderer->textureArray[i];
+        if (!info->active || info->tex == NULL || info->tex->img == NULL || info->tex->img->mem != mem)
+            continue;
+        image = info->tex->img;
+
+        // Render targets are left alone, as are textures a frame in flight might still be sampling
+        // since their descriptor can't be rewritten until that frame is done
+        if (info->tex->isTarget || info->evicted || (image->usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0 ||
+            info->lastUsedFrame + gRenderer->options.framesInFlight >= gRenderer->frameCount)
+            *movable = false;
+    }
+    return image;
+}
+
+static void _vk2dRendererDefragImageBarrier(VkCommandBuffer buf, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .srcAccessMask = srcAccess,
+            .dstAccessMask = dstAccess,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .subresourceRange.levelCount = 1,
+            .subresourceRange.layerCount = 1,
+    };
+    vkCmdPipelineBarrier(buf, srcStage, dstStage, 0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+}
+
+// Creates the new image for a move and records the copy, returns false if the move can't be made
+static bool _vk2dRendererDefragMoveImage(VkCommandBuffer buf, VmaDefragmentationMove *move, VK2DImage image, VK2DDefragMove *out) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VkImage newImage;
+    VkImageView newView;
+    VkImageCreateInfo imageCreateInfo = vk2dInitImageCreateInfo(image->width, image->height, image->format, image->usage, 1, VK_SAMPLE_COUNT_1_BIT);
+    if (vkCreateImage(gRenderer->ld->dev, &imageCreateInfo, VK_NULL_HANDLE, &newImage) != VK_SUCCESS)
+        return false;
+    if (vmaBindImageMemory(gRenderer->vma, move->dstTmpAllocation, newImage) != VK_SUCCESS) {
+        vkDestroyImage(gRenderer->ld->dev, newImage, VK_NULL_HANDLE);
+        return false;
+    }
+    VkImageViewCreateInfo imageViewCreateInfo = vk2dInitImageViewCreateInfo(newImage, image->format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    if (vkCreateImageView(gRenderer->ld->dev, &imageViewCreateInfo, VK_NULL_HANDLE, &newView) != VK_SUCCESS) {
+        vkDestroyImage(gRenderer->ld->dev, newImage, VK_NULL_HANDLE);
+        return false;
+    }
+
+    // Copy the old image into the new one and leave both ready to be sampled/destroyed
+    VkImageCopy region = {
+            .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .extent = {image->width, image->height, 1},
+    };
+    _vk2dRendererDefragImageBarrier(buf, image->img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    _vk2dRendererDefragImageBarrier(buf, newImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyImage(buf, image->img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    _vk2dRendererDefragImageBarrier(buf, newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    out->image = image;
+    out->oldImage = image->img;
+    out->oldView = image->view;
+    image->img = newImage;
+    image->view = newView;
+
+    // Point every texture array slot using this image at the new view
+    for (int i = 0; i < gRenderer->options.maxTextures; i++) {
+        VK2DTextureDescriptorInfo *info = &gRenderer->textureArray[i];
+        if (!info->active || info->tex == NULL || info->tex->img != image)
+            continue;
+        VkDescriptorImageInfo imageInfo = {
+                .imageView = newView,
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+        VkWriteDescriptorSet write = {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .dstArrayElement = i,
+                .pImageInfo = &imageInfo,
+                .dstBinding = 2,
+                .dstSet = gRenderer->texArrayDescriptorSet,
+                .descriptorCount = 1,
+        };
+        vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+    }
+    return true;
+}
+
+// Creates the new buffer for a move and records the copy, returns false if the move can't be made
+static bool _vk2dRendererDefragMoveBuffer(VkCommandBuffer buf, VmaDefragmentationMove *move, VK2DBuffer buffer, VK2DDefragMove *out) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if ((buffer->usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) == 0)
+        return false;
+    VkBuffer newBuffer;
+    VkBufferCreateInfo bufferCreateInfo = vk2dInitBufferCreateInfo(buffer->size, buffer->usage, gRenderer->ld->queueFamilies, gRenderer->ld->queueFamilyCount);
+    if (vkCreateBuffer(gRenderer->ld->dev, &bufferCreateInfo, VK_NULL_HANDLE, &newBuffer) != VK_SUCCESS)
+        return false;
+    if (vmaBindBufferMemory(gRenderer->vma, move->dstTmpAllocation, newBuffer) != VK_SUCCESS) {
+        vkDestroyBuffer(gRenderer->ld->dev, newBuffer, VK_NULL_HANDLE);
+        return false;
+    }
+    VkBufferCopy region = {.size = buffer->size};
+    vkCmdCopyBuffer(buf, buffer->buf, newBuffer, 1, &region);
+
+    out->buffer = buffer;
+    out->oldBuffer = buffer->buf;
+    buffer->buf = newBuffer;
+    return true;
+}
+
+// Destroys the old handles from the pending pass and ends it
+static void _vk2dRendererDefragEndPass() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    for (int i = 0; i < gRenderer->defragPass.moveCount; i++) {
+        if (gRenderer->defragPass.pMoves[i].operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+            continue;
+        vkDestroyImageView(gRenderer->ld->dev, gRenderer->defragMoves[i].oldView, VK_NULL_HANDLE);
+        vkDestroyImage(gRenderer->ld->dev, gRenderer->defragMoves[i].oldImage, VK_NULL_HANDLE);
+        vkDestroyBuffer(gRenderer->ld->dev, gRenderer->defragMoves[i].oldBuffer, VK_NULL_HANDLE);
+    }
+    VkResult result = vmaEndDefragmentationPass(gRenderer->vma, gRenderer->defragContext, &gRenderer->defragPass);
+    vkFreeCommandBuffers(gRenderer->ld->dev, gRenderer->ld->pool, 1, &gRenderer->defragCommandBuffer);
+    free(gRenderer->defragMoves);
+    gRenderer->defragMoves = NULL;
+    gRenderer->defragCommandBuffer = VK_NULL_HANDLE;
+    gRenderer->defragPassPending = false;
+
+    if (result == VK_SUCCESS) {
+        VmaDefragmentationStats stats;
+        vmaEndDefragmentation(gRenderer->vma, gRenderer->defragContext, &stats);
+        gRenderer->defragContext = NULL;
+        vk2dLogInfo("Defragmentation complete, moved %i allocations (%0.2fmb) and freed %0.2fmb.", stats.allocationsMoved,
+                    (float)stats.bytesMoved / 1048576.0f, (float)stats.bytesFreed / 1048576.0f);
+    }
+}
+
+bool _vk2dRendererDefragmentStep(float budgetMs) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return false;
+
+    // The old handles of a pass can only be destroyed once every frame that could use them is done
+    if (gRenderer->defragPassPending) {
+        if (gRenderer->frameCount < gRenderer->defragPassFrame + gRenderer->options.framesInFlight ||
+            !vk2dLogicalDeviceTimelineReached(gRenderer->ld, gRenderer->defragPassValue, true))
+            return false;
+        _vk2dRendererDefragEndPass();
+        return gRenderer->defragContext == NULL;
+    }
+
+    if (gRenderer->defragContext == NULL) {
+        VmaDefragmentationInfo defragInfo = {
+                .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_FAST_BIT,
+        };
+        VkResult result = vmaBeginDefragmentation(gRenderer->vma, &defragInfo, &gRenderer->defragContext);
+        if (result != VK_SUCCESS) {
+            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin defragmentation, Vulkan error %i.", result);
+            gRenderer->defragContext = NULL;
+            return false;
+        }
+    }
+
+    VkResult result = vmaBeginDefragmentationPass(gRenderer->vma, gRenderer->defragContext, &gRenderer->defragPass);
+    if (result == VK_SUCCESS) {
+        VmaDefragmentationStats stats;
+        vmaEndDefragmentation(gRenderer->vma, gRenderer->defragContext, &stats);
+        gRenderer->defragContext = NULL;
+        return true;
+    }
+
+    // Record copies for every move we own until we run out of time, the rest are left for later passes
+    const uint64_t start = SDL_GetPerformanceCounter();
+    const double frequency = (double)SDL_GetPerformanceFrequency();
+    gRenderer->defragMoves = calloc(gRenderer->defragPass.moveCount, sizeof(VK2DDefragMove));
+    gRenderer->defragCommandBuffer = vk2dLogicalDeviceGetSingleUseBuffer(gRenderer->ld, true);
+    for (int i = 0; i < gRenderer->defragPass.moveCount; i++) {
+        VmaDefragmentationMove *move = &gRenderer->defragPass.pMoves[i];
+        bool moved = false;
+        const double elapsed = ((double)(SDL_GetPerformanceCounter() - start) / frequency) * 1000;
+        if (gRenderer->defragMoves != NULL && (budgetMs <= 0 || elapsed < budgetMs)) {
+            bool movable;
+            VK2DImage image = _vk2dRendererDefragFindImage(move->srcAllocation, &movable);
+            VmaAllocationInfo allocationInfo;
+            vmaGetAllocationInfo(gRenderer->vma, move->srcAllocation, &allocationInfo);
+            if (image != NULL)
+                moved = movable && _vk2dRendererDefragMoveImage(gRenderer->defragCommandBuffer, move, image, &gRenderer->defragMoves[i]);
+            else if (allocationInfo.pUserData != NULL)
+                moved = _vk2dRendererDefragMoveBuffer(gRenderer->defragCommandBuffer, move, allocationInfo.pUserData, &gRenderer->defragMoves[i]);
+        }
+        if (!moved)
+            move->operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+    }
+
+    // Make the copies visible to anything submitted after this
+    VkMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(gRenderer->defragCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+    vkEndCommandBuffer(gRenderer->defragCommandBuffer);
+    const uint64_t passValue = vk2dLogicalDeviceNextTimelineValue(gRenderer->ld, true);
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .signalSemaphoreValueCount = 1,
+            .pSignalSemaphoreValues = &passValue
+    };
+    VkSubmitInfo submitInfo = vk2dInitSubmitInfo(&gRenderer->defragCommandBuffer, 1, &gRenderer->ld->timeline, 1, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+    submitInfo.pNext = &timelineSubmitInfo;
+    result = vkQueueSubmit(gRenderer->ld->queue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to submit defragmentation copies, Vulkan error %i.", result);
+        return false;
+    }
+    gRenderer->defragPassPending = true;
+    gRenderer->defragPassFrame = gRenderer->frameCount;
+    gRenderer->defragPassValue = passValue;
+    gRenderer->defragPassFrameValue = 0;
+    for (int i = 0; i < gRenderer->options.framesInFlight; i++)
+        if (gRenderer->frames[i].timelineValue > gRenderer->defragPassFrameValue)
+            gRenderer->defragPassFrameValue = gRenderer->frames[i].timelineValue;
+    return false;
+}
+
+// Waits until neither the pending pass' copies nor any frame recorded before it can be using the old handles
+static void _vk2dRendererDefragWaitPass() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    vk2dLogicalDeviceWaitTimeline(gRenderer->ld, gRenderer->defragPassFrameValue, true);
+    vk2dLogicalDeviceWaitTimeline(gRenderer->ld, gRenderer->defragPassValue, true);
+}
+
+void _vk2dRendererDefragmentRelease(VmaAllocation mem) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (gRenderer == NULL || !gRenderer->defragPassPending)
+        return;
+
+    // VMA doesn't allow freeing an allocation in the middle of a pass, so finish it early
+    for (int i = 0; i < gRenderer->defragPass.moveCount; i++) {
+        if (gRenderer->defragPass.pMoves[i].srcAllocation == mem) {
+            _vk2dRendererDefragWaitPass();
+            _vk2dRendererDefragEndPass();
+            return;
+        }
+    }
+}
+
+void _vk2dRendererDestroyDefragmentation() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (gRenderer->defragPassPending) {
+        _vk2dRendererDefragWaitPass();
+        _vk2dRendererDefragEndPass();
+    }
+    if (gRenderer->defragContext != NULL) {
+        vmaEndDefragmentation(gRenderer->vma, gRenderer->defragContext, VK_NULL_HANDLE);
+        gRenderer->defragContext = NULL;
+    }
+}
+
+static void _vk2dRendererBeginPassBuffer(VkCommandBuffer buf, VkRenderPass pass, VkFramebuffer framebuffer) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+
+    // Without render passes the secondary buffers only need to know the attachment formats
+    const VkFormat colourFormat = gRenderer->surfaceFormat.format;
+    VkCommandBufferInheritanceRenderingInfoKHR renderingInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &colourFormat,
+            .depthAttachmentFormat = gRenderer->depthBufferFormat,
+            .rasterizationSamples = (VkSampleCountFlagBits)gRenderer->config.msaa
+    };
+    VkCommandBufferInheritanceInfo inheritanceInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = gRenderer->dynamicRendering ? &renderingInfo : NULL,
+            .renderPass = pass,
+            .subpass = 0,
+            .framebuffer = framebuffer
+    };
+    VkCommandBufferBeginInfo beginInfo = vk2dInitCommandBufferBeginInfo(
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+            &inheritanceInfo);
+    VkResult result = vkBeginCommandBuffer(buf, &beginInfo);
+    if (result != VK_SUCCESS)
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to begin frame graph pass, Vulkan error %i.", result);
+}
+
+void _vk2dRendererBeginFrameGraph(const vec4 clearColour) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+
+    frame->graphPassCount = 0;
+    gRenderer->screenClearColour[0] = clearColour[0];
+    gRenderer->screenClearColour[1] = clearColour[1];
+    gRenderer->screenClearColour[2] = clearColour[2];
+    gRenderer->screenClearColour[3] = clearColour[3];
+    _vk2dRendererBeginPassBuffer(frame->screenPassBuffer, gRenderer->renderPass, _vk2dRendererGetScreenFramebuffer());
+    gRenderer->drawBuffer = frame->screenPassBuffer;
+}
+
+void _vk2dRendererFrameGraphSetTarget(VK2DTexture target, const VK2DTargetOps *ops) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+
+    // Screen draws all go into the one screen pass, so any clears happen inside of it
+    if (target == VK2D_TARGET_SCREEN) {
+        gRenderer->drawBuffer = frame->screenPassBuffer;
+        if (ops != NULL)
+            _vk2dRendererClearTarget(ops);
+        return;
+    }
+
+    // Going back to the last texture target after drawing to the screen picks up where that pass left off
+    if (frame->graphPassCount > 0 && frame->graphPasses[frame->graphPassCount - 1].target == target) {
+        gRenderer->drawBuffer = frame->graphPasses[frame->graphPassCount - 1].buffer;
+        if (ops != NULL)
+            _vk2dRendererClearTarget(ops);
+        return;
+    }
+
+    // Passes and their command buffers are kept around for later frames
+    if (frame->graphPassCount == frame->graphPassCapacity) {
+        VK2DFrameGraphPass *newPasses = realloc(frame->graphPasses, sizeof(VK2DFrameGraphPass) * (frame->graphPassCapacity + VK2D_DEFAULT_ARRAY_EXTENSION));
+        if (newPasses == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate frame graph passes.");
+            return;
+        }
+        for (uint32_t i = frame->graphPassCapacity; i < frame->graphPassCapacity + VK2D_DEFAULT_ARRAY_EXTENSION; i++)
+            newPasses[i].buffer = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, false);
+        frame->graphPasses = newPasses;
+        frame->graphPassCapacity += VK2D_DEFAULT_ARRAY_EXTENSION;
+    }
+
+    VK2DFrameGraphPass *pass = &frame->graphPasses[frame->graphPassCount++];
+    const VK2DTargetOps defaultOps = {0};
+    pass->target = target;
+    pass->ops = ops != NULL ? *ops : defaultOps;
+    _vk2dRendererBeginPassBuffer(pass->buffer, gRenderer->externalTargetRenderPass, target->fbo);
+    gRenderer->drawBuffer = pass->buffer;
+}
+
+void _vk2dRendererEndFrameGraph() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+    VkCommandBuffer buf = frame->commandBuffer;
+
+    for (uint32_t i = 0; i < frame->graphPassCount; i++)
+        vkEndCommandBuffer(frame->graphPasses[i].buffer);
+    VkResult result = vkEndCommandBuffer(frame->screenPassBuffer);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to end frame graph pass, Vulkan error %i.", result);
+        return;
+    }
+
+    // Offscreen passes go first in the order they were recorded, each target goes back to being readable in the
+    // same barrier that readies the next one
+    for (uint32_t i = 0; i < frame->graphPassCount; i++) {
+        VK2DTexture target = frame->graphPasses[i].target;
+        if (i == 0)
+            _vk2dTransitionImageLayout(target->img->img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        else
+            _vk2dTransitionTargetSwap(frame->graphPasses[i - 1].target->img->img, target->img->img);
+
+        VkRect2D rect = {0};
+        rect.extent.width = target->img->width;
+        rect.extent.height = target->img->height;
+        const VK2DTargetOps *ops = &frame->graphPasses[i].ops;
+        VkClearValue clear[2] = {0};
+        clear[0].color.float32[0] = ops->clearColour[0];
+        clear[0].color.float32[1] = ops->clearColour[1];
+        clear[0].color.float32[2] = ops->clearColour[2];
+        clear[0].color.float32[3] = ops->clearColour[3];
+        clear[1].depthStencil.depth = 1;
+        VkRenderPassBeginInfo renderPassBeginInfo = vk2dInitRenderPassBeginInfo(_vk2dRendererGetTargetRenderPass(false, ops), target->fbo, rect, clear, 2);
+
+        const int32_t scope = _vk2dRendererBeginGPUScope(buf, "Target pass", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        if (gRenderer->dynamicRendering)
+            _vk2dRendererBeginRendering(buf, target, NULL, ops, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR);
+        else
+            vkCmdBeginRenderPass(buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        vkCmdExecuteCommands(buf, 1, &frame->graphPasses[i].buffer);
+        if (gRenderer->dynamicRendering)
+            gRenderer->ld->endRendering(buf);
+        else
+            vkCmdEndRenderPass(buf);
+        _vk2dRendererEndGPUScope(buf, scope);
+        gRenderer->frameStats.renderPassBegins++;
+    }
+    if (frame->graphPassCount > 0)
+        _vk2dTransitionImageLayout(frame->graphPasses[frame->graphPassCount - 1].target->img->img, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // The swapchain image is only loaded and stored once a frame
+    VkRect2D rect = {0};
+    rect.extent.width = gRenderer->surfaceWidth;
+    rect.extent.height = gRenderer->surfaceHeight;
+    VkClearValue clearValues[2] = {0};
+    clearValues[0].color.float32[0] = gRenderer->screenClearColour[0];
+    clearValues[0].color.float32[1] = gRenderer->screenClearColour[1];
+    clearValues[0].color.float32[2] = gRenderer->screenClearColour[2];
+    clearValues[0].color.float32[3] = gRenderer->screenClearColour[3];
+    clearValues[1].depthStencil.depth = 1;
+    VkRenderPassBeginInfo renderPassBeginInfo = vk2dInitRenderPassBeginInfo(gRenderer->renderPass, _vk2dRendererGetScreenFramebuffer(), rect, clearValues, 2);
+
+    const int32_t scope = _vk2dRendererBeginGPUScope(buf, "Screen pass", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    if (gRenderer->dynamicRendering)
+        _vk2dRendererBeginRendering(buf, VK2D_TARGET_SCREEN, gRenderer->screenClearColour, NULL, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR);
+    else
+        vkCmdBeginRenderPass(buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(buf, 1, &frame->screenPassBuffer);
+    if (gRenderer->dynamicRendering)
+        gRenderer->ld->endRendering(buf);
+    else
+        vkCmdEndRenderPass(buf);
+    _vk2dRendererEndGPUScope(buf, scope);
+    gRenderer->frameStats.renderPassBegins++;
+    gRenderer->drawBuffer = buf;
+}
+
+void _vk2dRendererPaceFrame() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+
+    // Don't start a frame until the last one is on screen so frames never queue up ahead of the display
+    if (gRenderer->options.lowLatencyPacing && gRenderer->ld->waitForPresent != NULL && gRenderer->presentId > 0) {
+        VK2D_TRACE_BEGIN(presentZone, "Wait for present");
+        VkResult result = gRenderer->ld->waitForPresent(gRenderer->ld->dev, gRenderer->swapchain, gRenderer->presentId, VK2D_PRESENT_WAIT_TIMEOUT);
+        VK2D_TRACE_END(presentZone);
+
+        // Timeouts and out of date swapchains are left for acquire to deal with
+        if (result == VK_ERROR_DEVICE_LOST) {
+            vk2dRaise(VK2D_STATUS_DEVICE_LOST, "Vulkan device lost.");
+            return;
+        }
+    }
+
+    if (gRenderer->frameLimit <= 0) {
+        gRenderer->nextFrameDeadline = 0;
+        return;
+    }
+
+    const uint64_t frequency = SDL_GetPerformanceFrequency();
+    const uint64_t period = (uint64_t)((double)frequency / gRenderer->frameLimit);
+    const uint64_t spin = (frequency * VK2D_FRAME_LIMITER_SPIN_MS) / 1000;
+    const uint64_t deadline = gRenderer->nextFrameDeadline;
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    // On the first frame or after a long one start a new schedule instead of rushing to catch up
+    if (deadline == 0 || now > deadline + period) {
+        gRenderer->nextFrameDeadline = now + period;
+        return;
+    }
+
+    // Sleep most of the way since it's cheap but imprecise, then spin the rest
+    VK2D_TRACE_BEGIN(limiterZone, "Frame limiter");
+    while (now + spin < deadline) {
+        SDL_DelayNS(((deadline - spin - now) * SDL_NS_PER_SECOND) / frequency);
+        now = SDL_GetPerformanceCounter();
+    }
+    while (now < deadline)
+        now = SDL_GetPerformanceCounter();
+    VK2D_TRACE_END(limiterZone);
+    gRenderer->nextFrameDeadline = deadline + period;
+}
+
+void _vk2dRendererBeginProfilerFrame() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || !gRenderer->gpuProfiling)
+        return;
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+    VK2DGPUScope *scopes = frame->gpuScopes;
+    const uint32_t scopeCount = frame->gpuScopeCount;
+
+    // This frame's fence has already been waited on so its queries are all available
+    if (scopeCount > 0) {
+        uint64_t timestamps[VK2D_MAX_GPU_SCOPES * 2] = {0};
+        vkGetQueryPoolResults(gRenderer->ld->dev, frame->gpuQueryPool, 0, scopeCount * 2, sizeof(timestamps),
+                              timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        gRenderer->gpuTimingCount = 0;
+        uint64_t frameStart = UINT64_MAX;
+        uint64_t frameEnd = 0;
+        for (uint32_t i = 0; i < scopeCount; i++) {
+            if (!scopes[i].ended)
+                continue;
+            VK2DGPUTiming *timing = &gRenderer->gpuTimings[gRenderer->gpuTimingCount++];
+            timing->name = scopes[i].name;
+            timing->depth = scopes[i].depth;
+            timing->ms = ((double)(timestamps[(i * 2) + 1] - timestamps[i * 2]) * gRenderer->gpuTimestampPeriod) / 1000000.0;
+            frameStart = timestamps[i * 2] < frameStart ? timestamps[i * 2] : frameStart;
+            frameEnd = timestamps[(i * 2) + 1] > frameEnd ? timestamps[(i * 2) + 1] : frameEnd;
+        }
+
+        // These timestamps belong to the last frame that used this slot
+        const uint64_t timedFrame = gRenderer->frameCount - gRenderer->options.framesInFlight;
+        VK2DFrameTime *frameTime = &gRenderer->frameTimes[timedFrame % gRenderer->options.frameTimeHistory];
+        if (frameTime->frame == timedFrame && frameEnd > frameStart)
+            frameTime->gpu = ((double)(frameEnd - frameStart) * gRenderer->gpuTimestampPeriod) / 1000000.0;
+    }
+
+    frame->gpuScopeCount = 0;
+    gRenderer->gpuScopeDepth = 0;
+    gRenderer->gpuPassScope = -1;
+    gRenderer->gpuComputeScope = -1;
+
+    // The descriptor buffer's command buffer is submitted first so the reset goes there, unless
+    // it runs on the async compute queue in which case the graphics command buffer owns the pool
+    if (gRenderer->ld->computeQueue != VK_NULL_HANDLE)
+        vkCmdResetQueryPool(frame->commandBuffer, frame->gpuQueryPool, 0, VK2D_MAX_GPU_SCOPES * 2);
+    else
+        vkCmdResetQueryPool(frame->dbCommandBuffer, frame->gpuQueryPool, 0, VK2D_MAX_GPU_SCOPES * 2);
+}
+
+int32_t _vk2dRendererBeginGPUScope(VkCommandBuffer buf, const char *name, VkPipelineStageFlagBits stage) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || !gRenderer->gpuProfiling)
+        return -1;
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+    if (frame->gpuScopeCount >= VK2D_MAX_GPU_SCOPES)
+        return -1;
+
+    // Work on the async compute queue is not timed since the query pool lives on the graphics queue
+    if (gRenderer->ld->computeQueue != VK_NULL_HANDLE && (buf == frame->dbCommandBuffer || buf == frame->computeCommandBuffer))
+        return -1;
+
+    VK2DGPUScope *scope = &frame->gpuScopes[frame->gpuScopeCount];
+    scope->name = name;
+    scope->depth = gRenderer->gpuScopeDepth;
+    scope->ended = false;
+    vkCmdWriteTimestamp(buf, stage, frame->gpuQueryPool, frame->gpuScopeCount * 2);
+    return (int32_t)frame->gpuScopeCount++;
+}
+
+void _vk2dRendererEndGPUScope(VkCommandBuffer buf, int32_t scope) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || !gRenderer->gpuProfiling || scope < 0)
+        return;
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+    vkCmdWriteTimestamp(buf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame->gpuQueryPool, (scope * 2) + 1);
+    frame->gpuScopes[scope].ended = true;
+}
+
 // This is called when a render-target texture is created to make the renderer aware of it
 void _vk2dRendererAddTarget(VK2DTexture tex) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
@@ -156,7 +931,38 @@ void _vk2dRendererRemoveTarget(VK2DTexture tex) {
 			gRenderer->targets[i] = NULL;
 }
 
-// This is used when changing the render target to make sure the texture is either ready to be drawn itself or rendered to
+// Fills out a barrier for one of the two target transitions and adds its stages to the given masks
+static void _vk2dFillTargetBarrier(VkImageMemoryBarrier *barrier, VkImage img, VkImageLayout old, VkImageLayout new, VkPipelineStageFlags *sourceStage, VkPipelineStageFlags *destinationStage) {
+	memset(barrier, 0, sizeof(VkImageMemoryBarrier));
+	barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier->oldLayout = old;
+	barrier->newLayout = new;
+	barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier->image = img;
+	barrier->subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier->subresourceRange.baseMipLevel = 0;
+	barrier->subresourceRange.levelCount = 1;
+	barrier->subresourceRange.baseArrayLayer = 0;
+	barrier->subresourceRange.layerCount = 1;
+
+	if (old == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+		barrier->srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barrier->dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		*sourceStage |= VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		*destinationStage |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	} else if (new == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+		barrier->srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier->dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+		*sourceStage |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		*destinationStage |= VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	} else {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Unsupported image transition.");
+	}
+}
+
 void _vk2dTransitionImageLayout(VkImage img, VkImageLayout old, VkImageLayout new) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (vk2dStatusFatal())
@@ -164,39 +970,242 @@ void _vk2dTransitionImageLayout(VkImage img, VkImageLayout old, VkImageLayout ne
 
 	VkPipelineStageFlags sourceStage = 0;
 	VkPipelineStageFlags destinationStage = 0;
+	VkImageMemoryBarrier barrier;
+	_vk2dFillTargetBarrier(&barrier, img, old, new, &sourceStage, &destinationStage);
+
+	vkCmdPipelineBarrier(
+			gRenderer->frames[gRenderer->currentFrame].commandBuffer,
+			sourceStage, destinationStage,
+			0,
+			0, VK_NULL_HANDLE,
+			0, VK_NULL_HANDLE,
+			1, &barrier
+	);
+}
+
+void _vk2dTransitionTargetSwap(VkImage previous, VkImage next) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal())
+	    return;
+
+	VkPipelineStageFlags sourceStage = 0;
+	VkPipelineStageFlags destinationStage = 0;
+	VkImageMemoryBarrier barriers[2];
+	_vk2dFillTargetBarrier(&barriers[0], previous, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, &sourceStage, &destinationStage);
+	_vk2dFillTargetBarrier(&barriers[1], next, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, &sourceStage, &destinationStage);
+
+	vkCmdPipelineBarrier(
+			gRenderer->frames[gRenderer->currentFrame].commandBuffer,
+			sourceStage, destinationStage,
+			0,
+			0, VK_NULL_HANDLE,
+			0, VK_NULL_HANDLE,
+			2, barriers
+	);
+}
+
+// Clears rects of the current target for whichever of its colour and depth ops are VK2D_TARGET_OP_CLEAR
+static void _vk2dRendererClearRects(const VK2DTargetOps *ops, const VkClearRect *rects, uint32_t rectCount) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	VkClearAttachment clears[2] = {0};
+	uint32_t clearCount = 0;
+	if (ops->colour == VK2D_TARGET_OP_CLEAR) {
+		clears[clearCount].aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		clears[clearCount].colorAttachment = 0;
+		clears[clearCount].clearValue.color.float32[0] = ops->clearColour[0];
+		clears[clearCount].clearValue.color.float32[1] = ops->clearColour[1];
+		clears[clearCount].clearValue.color.float32[2] = ops->clearColour[2];
+		clears[clearCount].clearValue.color.float32[3] = ops->clearColour[3];
+		clearCount++;
+	}
+	if (ops->depth == VK2D_TARGET_OP_CLEAR) {
+		clears[clearCount].aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		clears[clearCount].clearValue.depthStencil.depth = 1;
+		clearCount++;
+	}
+	if (clearCount == 0 || rectCount == 0)
+		return;
+	vkCmdClearAttachments(gRenderer->drawBuffer, clearCount, clears, rectCount, rects);
+}
+
+void _vk2dRendererClearTarget(const VK2DTargetOps *ops) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal())
+	    return;
+
+	VkClearRect rect = {0};
+	rect.rect.extent.width = gRenderer->target == VK2D_TARGET_SCREEN ? gRenderer->surfaceWidth : gRenderer->target->img->width;
+	rect.rect.extent.height = gRenderer->target == VK2D_TARGET_SCREEN ? gRenderer->surfaceHeight : gRenderer->target->img->height;
+	rect.layerCount = 1;
+	_vk2dRendererClearRects(ops, &rect, 1);
+}
+
+void _vk2dRendererClearCameras(const VK2DTargetOps *ops) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal())
+	    return;
+
+	// Cameras only place draws on the screen, texture targets are always drawn to in full
+	if (gRenderer->target != VK2D_TARGET_SCREEN) {
+		_vk2dRendererClearTarget(ops);
+		return;
+	}
+
+	// One rect per camera being drawn to, clamped to the surface since clear rects can't leave the render area
+	VkClearRect rects[VK2D_MAX_CAMERAS] = {0};
+	uint32_t rectCount = 0;
+	for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
+		VK2DCamera *camera = &gRenderer->cameras[i];
+		if (camera->state != VK2D_CAMERA_STATE_NORMAL || (gRenderer->cameraLocked != VK2D_INVALID_CAMERA && i != gRenderer->cameraLocked))
+			continue;
+		const float x1 = camera->spec.xOnScreen < 0 ? 0 : camera->spec.xOnScreen;
+		const float y1 = camera->spec.yOnScreen < 0 ? 0 : camera->spec.yOnScreen;
+		const float x2 = fminf(camera->spec.xOnScreen + camera->spec.wOnScreen, (float)gRenderer->surfaceWidth);
+		const float y2 = fminf(camera->spec.yOnScreen + camera->spec.hOnScreen, (float)gRenderer->surfaceHeight);
+		if (x2 <= x1 || y2 <= y1)
+			continue;
+		rects[rectCount].rect.offset.x = (int32_t)x1;
+		rects[rectCount].rect.offset.y = (int32_t)y1;
+		rects[rectCount].rect.extent.width = (uint32_t)(x2 - x1);
+		rects[rectCount].rect.extent.height = (uint32_t)(y2 - y1);
+		rects[rectCount].layerCount = 1;
+		rectCount++;
+	}
+	_vk2dRendererClearRects(ops, rects, rectCount);
+}
+
+// Fills out a barrier that throws away whatever was in an attachment so it can be cleared
+static void _vk2dFillDiscardBarrier(VkImageMemoryBarrier *barrier, VkImage img, VkImageLayout new, VkImageAspectFlags aspect, VkAccessFlags access) {
+	memset(barrier, 0, sizeof(VkImageMemoryBarrier));
+	barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier->oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier->newLayout = new;
+	barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier->image = img;
+	barrier->subresourceRange.aspectMask = aspect;
+	barrier->subresourceRange.levelCount = 1;
+	barrier->subresourceRange.layerCount = 1;
+	barrier->dstAccessMask = access;
+}
+
+void _vk2dRendererBeginRendering(VkCommandBuffer buf, VK2DTexture target, const vec4 clearColour, const VK2DTargetOps *ops, VkRenderingFlagsKHR flags) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal())
+	    return;
+	const bool screen = target == VK2D_TARGET_SCREEN;
+	const bool clear = screen && clearColour != NULL;
+	const bool msaa = gRenderer->config.msaa != VK2D_MSAA_1X;
+	const VK2DTargetOps defaultOps = {0};
+	if (ops == NULL || clear)
+		ops = &defaultOps;
+
+	VK2DImage colour, resolve, depth;
+	if (screen) {
+		colour = msaa ? gRenderer->msaaImage : NULL;
+		resolve = NULL;
+		depth = gRenderer->depthBuffer;
+	} else {
+		colour = msaa ? target->sampledImg : target->img;
+		resolve = msaa ? target->img : NULL;
+		depth = target->depthBuffer;
+	}
+	VkImageView swapchainView = gRenderer->swapchainImageViews[gRenderer->scImageIndex];
+
+	// Render passes used to take care of this, the screen starts every frame undefined and texture targets
+	// never keep their depth between passes
+	VkImageMemoryBarrier barriers[3];
+	uint32_t barrierCount = 0;
+	const bool clearDepth = clear || ops->depth == VK2D_TARGET_OP_CLEAR || (!screen && ops->depth == VK2D_TARGET_OP_LOAD);
+	const bool discardDepth = clear || !screen || ops->depth != VK2D_TARGET_OP_LOAD;
+	VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+	if (depth->format == VK_FORMAT_D16_UNORM_S8_UINT || depth->format == VK_FORMAT_D24_UNORM_S8_UINT || depth->format == VK_FORMAT_D32_SFLOAT_S8_UINT)
+		depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+	if (discardDepth)
+		_vk2dFillDiscardBarrier(&barriers[barrierCount++], depth->img, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthAspect, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+	if (clear) {
+		_vk2dFillDiscardBarrier(&barriers[barrierCount++], gRenderer->swapchainImages[gRenderer->scImageIndex], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+		if (msaa)
+			_vk2dFillDiscardBarrier(&barriers[barrierCount++], colour->img, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+	}
+
+	// Picking the screen back up needs the last screen pass's writes to land first
+	VkMemoryBarrier resumeBarrier = {0};
+	resumeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resumeBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	resumeBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	const uint32_t memoryBarrierCount = screen && !clear ? 1 : 0;
+
+	const VkPipelineStageFlags attachmentStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	if (barrierCount + memoryBarrierCount > 0)
+		vkCmdPipelineBarrier(
+				buf,
+				attachmentStages, attachmentStages,
+				0,
+				memoryBarrierCount, &resumeBarrier,
+				0, VK_NULL_HANDLE,
+				barrierCount, barriers
+		);
+
+	VkRenderingAttachmentInfoKHR colourAttachment = {0};
+	colourAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+	colourAttachment.imageView = colour != NULL ? colour->view : swapchainView;
+	colourAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colourAttachment.resolveMode = msaa ? VK_RESOLVE_MODE_AVERAGE_BIT : VK_RESOLVE_MODE_NONE;
+	colourAttachment.resolveImageView = msaa ? (resolve != NULL ? resolve->view : swapchainView) : VK_NULL_HANDLE;
+	colourAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colourAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	colourAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	if (clear || ops->colour == VK2D_TARGET_OP_CLEAR) {
+		const float *colour = clear ? clearColour : ops->clearColour;
+		colourAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colourAttachment.clearValue.color.float32[0] = colour[0];
+		colourAttachment.clearValue.color.float32[1] = colour[1];
+		colourAttachment.clearValue.color.float32[2] = colour[2];
+		colourAttachment.clearValue.color.float32[3] = colour[3];
+	} else if (ops->colour == VK2D_TARGET_OP_DONT_CARE) {
+		colourAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	}
+
+	VkRenderingAttachmentInfoKHR depthAttachment = {0};
+	depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+	depthAttachment.imageView = depth->view;
+	depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthAttachment.loadOp = clearDepth ? VK_ATTACHMENT_LOAD_OP_CLEAR : (discardDepth ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD);
+	depthAttachment.storeOp = !screen || ops->discardDepth ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachment.clearValue.depthStencil.depth = 1;
+
+	VkRenderingInfoKHR renderingInfo = {0};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+	renderingInfo.flags = flags;
+	renderingInfo.renderArea.extent.width = screen ? gRenderer->surfaceWidth : target->img->width;
+	renderingInfo.renderArea.extent.height = screen ? gRenderer->surfaceHeight : target->img->height;
+	renderingInfo.layerCount = 1;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments = &colourAttachment;
+	renderingInfo.pDepthAttachment = &depthAttachment;
+	gRenderer->ld->beginRendering(buf, &renderingInfo);
+}
+
+void _vk2dRendererEndRenderingFrame(VkCommandBuffer buf) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal())
+	    return;
 
 	VkImageMemoryBarrier barrier = {0};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.oldLayout = old;
-	barrier.newLayout = new;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.image = img;
+	barrier.image = gRenderer->swapchainImages[gRenderer->scImageIndex];
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
 	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
-
-	if (old == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	} else if (new == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-		sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	} else {
-        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Unsupported image transition.");
-	}
-
+	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	vkCmdPipelineBarrier(
-			gRenderer->commandBuffer[gRenderer->scImageIndex],
-			sourceStage, destinationStage,
+			buf,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
 			0,
 			0, VK_NULL_HANDLE,
 			0, VK_NULL_HANDLE,
@@ -249,14 +1258,14 @@ void _vk2dRendererFlushUBOBuffers() {
 
 	VkBuffer buffer;
 	VkDeviceSize offset;
-	vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], &gRenderer->workingUBO, sizeof(VK2DUniformBufferObject), &buffer, &offset);
+	vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, &gRenderer->workingUBO, sizeof(VK2DUniformBufferObject), &buffer, &offset);
 	VkDescriptorBufferInfo bufferInfo = {buffer, offset, sizeof(VK2DUniformBufferObject)};
 	VkWriteDescriptorSet write = {0};
 	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	write.descriptorCount = 1;
 	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	write.pBufferInfo = &bufferInfo;
-	write.dstSet = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
+	write.dstSet = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet;
 	vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
 }
 
@@ -311,7 +1320,11 @@ void _vk2dRendererGetSurfaceSize() {
 	if (result != VK_SUCCESS) {
 	    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to get surface size, Vulkan error %i.", result);
 	} else {
-        if (gRenderer->surfaceCapabilities.currentExtent.width == UINT32_MAX ||
+        if (gRenderer->window == NULL) {
+            // Headless surfaces are whatever size we say they are
+            gRenderer->surfaceWidth = gRenderer->options.headlessWidth;
+            gRenderer->surfaceHeight = gRenderer->options.headlessHeight;
+        } else if (gRenderer->surfaceCapabilities.currentExtent.width == UINT32_MAX ||
             gRenderer->surfaceCapabilities.currentExtent.height == UINT32_MAX) {
             SDL_GetWindowSizeInPixels(gRenderer->window, (void *) &gRenderer->surfaceWidth,
                                        (void *) &gRenderer->surfaceHeight);
@@ -322,11 +1335,35 @@ void _vk2dRendererGetSurfaceSize() {
     }
 }
 
+// Creates a VK_EXT_headless_surface surface for when the renderer has no window
+static bool _vk2dRendererCreateHeadlessSurface() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    PFN_vkCreateHeadlessSurfaceEXT createHeadlessSurface = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(gRenderer->vk, "vkCreateHeadlessSurfaceEXT");
+    if (createHeadlessSurface == NULL) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to load vkCreateHeadlessSurfaceEXT.");
+        return false;
+    }
+    VkHeadlessSurfaceCreateInfoEXT createInfo = {
+            .sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT
+    };
+    VkResult result = createHeadlessSurface(gRenderer->vk, &createInfo, VK_NULL_HANDLE, &gRenderer->surface);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create headless surface, Vulkan error %i.", result);
+        return false;
+    }
+    vk2dLogInfo("Running headless at %ix%i.", gRenderer->options.headlessWidth, gRenderer->options.headlessHeight);
+    return true;
+}
+
 void _vk2dRendererCreateWindowSurface() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	if (gRenderer != NULL) {
+        // Headless surfaces raise their own errors
+        if (gRenderer->window == NULL && !_vk2dRendererCreateHeadlessSurface())
+            return;
+
         // Create the surface then load up surface relevant values
-        if (SDL_Vulkan_CreateSurface(gRenderer->window, gRenderer->vk, VK_NULL_HANDLE, &gRenderer->surface)) {
+        if (gRenderer->window == NULL || SDL_Vulkan_CreateSurface(gRenderer->window, gRenderer->vk, VK_NULL_HANDLE, &gRenderer->surface)) {
             VkResult result = vkGetPhysicalDeviceSurfacePresentModesKHR(gRenderer->pd->dev, gRenderer->surface, &gRenderer->presentModeCount, VK_NULL_HANDLE);
             if (result != VK_SUCCESS) {
                 vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to get present modes, Vulkan error %i.", result);
@@ -499,13 +1536,8 @@ void _vk2dRendererCreateDescriptorBuffers() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-	gRenderer->descriptorBuffers = malloc(sizeof(VK2DDescriptorBuffer) * VK2D_MAX_FRAMES_IN_FLIGHT);
-	if (gRenderer->descriptorBuffers == NULL) {
-	    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate descriptor buffers array.");
-	    return;
-	}
-	for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
-		gRenderer->descriptorBuffers[i] = vk2dDescriptorBufferCreate(gRenderer->options.vramPageSize);
+	for (int i = 0; i < gRenderer->options.framesInFlight; i++) {
+		gRenderer->frames[i].descriptorBuffer = vk2dDescriptorBufferCreate(gRenderer->options.vramPageSize);
 	}
 
 	// Calculate max instances
@@ -520,53 +1552,19 @@ void _vk2dRendererCreateDescriptorBuffers() {
 
 void _vk2dRendererDestroyDescriptorBuffers() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-	if (gRenderer->descriptorBuffers == NULL)
-	    return;
-	for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++)
-		vk2dDescriptorBufferFree(gRenderer->descriptorBuffers[i]);
-	free(gRenderer->descriptorBuffers);
+	for (int i = 0; i < gRenderer->options.framesInFlight; i++) {
+		vk2dDescriptorBufferFree(gRenderer->frames[i].descriptorBuffer);
+		gRenderer->frames[i].descriptorBuffer = NULL;
+	}
 }
 
 
-void _vk2dRendererCreateRenderPass() {
+// Builds the single subpass render pass VK2D uses out of a colour, depth and optional resolve attachment
+static bool _vk2dRendererBuildRenderPass(VkAttachmentDescription *attachments, uint32_t attachCount, VkRenderPass *out) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (vk2dStatusFatal())
-        return;
-	uint32_t attachCount;
-	if (gRenderer->config.msaa != 1) {
-		attachCount = 3; // colour, depth, resolve
-	} else {
-		attachCount = 2; // colour, depth
-	}
 	VkAttachmentReference resolveAttachment;
-	VkAttachmentDescription attachments[3];
-	memset(attachments, 0, sizeof(VkAttachmentDescription) * attachCount);
-	attachments[0].format = gRenderer->surfaceFormat.format;
-	attachments[0].samples = (VkSampleCountFlagBits)gRenderer->config.msaa;
-	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[0].finalLayout = gRenderer->config.msaa > 1 ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-	attachments[1].format = gRenderer->depthBufferFormat;
-	attachments[1].samples = (VkSampleCountFlagBits)gRenderer->config.msaa;
-	attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-	if (gRenderer->config.msaa != 1) {
-		attachments[2].format = gRenderer->surfaceFormat.format;
-		attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
-		attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[2].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-		resolveAttachment.attachment = 2;
-		resolveAttachment.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	}
+	resolveAttachment.attachment = 2;
+	resolveAttachment.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 	// Set up subpass color attachment
 	const uint32_t colourAttachCount = 1;
@@ -589,7 +1587,7 @@ void _vk2dRendererCreateRenderPass() {
 	subpasses[0].colorAttachmentCount = colourAttachCount;
 	subpasses[0].pColorAttachments = subpassColourAttachments0;
 	subpasses[0].pDepthStencilAttachment = &subpassDepthAttachmentReference;
-	subpasses[0].pResolveAttachments = gRenderer->config.msaa > 1 ? &resolveAttachment : VK_NULL_HANDLE;
+	subpasses[0].pResolveAttachments = attachCount > 2 ? &resolveAttachment : VK_NULL_HANDLE;
 
 	// Subpass dependency
 	VkSubpassDependency subpassDependency = {0};
@@ -601,69 +1599,139 @@ void _vk2dRendererCreateRenderPass() {
 	subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
 	VkRenderPassCreateInfo renderPassCreateInfo = vk2dInitRenderPassCreateInfo(attachments, attachCount, subpasses, subpassCount, &subpassDependency, 1);
-	VkResult result = vkCreateRenderPass(gRenderer->ld->dev, &renderPassCreateInfo, VK_NULL_HANDLE, &gRenderer->renderPass);
+	VkResult result = vkCreateRenderPass(gRenderer->ld->dev, &renderPassCreateInfo, VK_NULL_HANDLE, out);
 	if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to create render pass, out of memory.");
-        return;
+        return false;
 	} else if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
         vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "Failed to create render pass, out of video memory.");
-        return;
+        return false;
 	}
+	return true;
+}
 
-	// Two more render passes for mid-frame render pass reset to swapchain and rendering to textures
-	if (gRenderer->config.msaa != 1) {
-		attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-		attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-		attachments[2].initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-		attachments[2].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-		attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-	} else {
-		attachments[0].initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-		attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+static VkAttachmentLoadOp _vk2dTargetOpToLoadOp(VK2DTargetOp op) {
+	if (op == VK2D_TARGET_OP_CLEAR)
+		return VK_ATTACHMENT_LOAD_OP_CLEAR;
+	if (op == VK2D_TARGET_OP_DONT_CARE)
+		return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	return VK_ATTACHMENT_LOAD_OP_LOAD;
+}
+
+VkFramebuffer _vk2dRendererGetScreenFramebuffer() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer->dynamicRendering)
+		return VK_NULL_HANDLE;
+	return gRenderer->framebuffers[gRenderer->scImageIndex];
+}
+
+VkRenderPass _vk2dRendererGetTargetRenderPass(bool screen, const VK2DTargetOps *ops) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (vk2dStatusFatal() || gRenderer->dynamicRendering)
+		return VK_NULL_HANDLE;
+	const VK2DTargetOps defaultOps = {0};
+	if (ops == NULL)
+		ops = &defaultOps;
+	const VK2DTargetOp colourOp = ops->colour < VK2D_TARGET_OP_MAX ? ops->colour : VK2D_TARGET_OP_LOAD;
+	VK2DTargetOp depthOp = ops->depth < VK2D_TARGET_OP_MAX ? ops->depth : VK2D_TARGET_OP_LOAD;
+
+	// Texture target depth starts every pass undefined so there is nothing to load and no reason to store it
+	if (!screen && depthOp == VK2D_TARGET_OP_LOAD)
+		depthOp = VK2D_TARGET_OP_CLEAR;
+	const bool discardDepth = !screen || ops->discardDepth;
+	VkRenderPass *pass = &gRenderer->targetRenderPasses[screen ? 1 : 0][colourOp][depthOp][discardDepth ? 1 : 0];
+	if (*pass != VK_NULL_HANDLE)
+		return *pass;
+
+	// These all have to stay compatible with the default passes, only load and store ops differ
+	const bool msaa = gRenderer->config.msaa != 1;
+	const uint32_t attachCount = msaa ? 3 : 2; // colour, depth, resolve
+	VkAttachmentDescription attachments[3];
+	memset(attachments, 0, sizeof(VkAttachmentDescription) * attachCount);
+	attachments[0].format = gRenderer->surfaceFormat.format;
+	attachments[0].samples = (VkSampleCountFlagBits)gRenderer->config.msaa;
+	attachments[0].loadOp = _vk2dTargetOpToLoadOp(colourOp);
+	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[0].initialLayout = screen && !msaa ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	attachments[0].finalLayout = attachments[0].initialLayout;
+	attachments[1].format = gRenderer->depthBufferFormat;
+	attachments[1].samples = (VkSampleCountFlagBits)gRenderer->config.msaa;
+	attachments[1].loadOp = _vk2dTargetOpToLoadOp(depthOp);
+	attachments[1].storeOp = discardDepth ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].initialLayout = screen ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	if (msaa) {
+		// The resolve overwrites every pixel anyway, so texture targets only load it when asked to keep their colour
+		attachments[2].format = gRenderer->surfaceFormat.format;
+		attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[2].loadOp = screen || colourOp == VK2D_TARGET_OP_LOAD ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[2].initialLayout = screen ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachments[2].finalLayout = attachments[2].initialLayout;
 	}
-	result = vkCreateRenderPass(gRenderer->ld->dev, &renderPassCreateInfo, VK_NULL_HANDLE, &gRenderer->midFrameSwapRenderPass);
-    if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
-        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to create render pass, out of memory.");
-        return;
-    } else if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
-        vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "Failed to create render pass, out of video memory.");
+
+	if (!_vk2dRendererBuildRenderPass(attachments, attachCount, pass))
+		*pass = VK_NULL_HANDLE;
+	return *pass;
+}
+
+void _vk2dRendererCreateRenderPass() {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
         return;
-    }
 
+	// Dynamic rendering describes attachments when rendering begins instead
+	gRenderer->renderPass = VK_NULL_HANDLE;
+	gRenderer->midFrameSwapRenderPass = VK_NULL_HANDLE;
+	gRenderer->externalTargetRenderPass = VK_NULL_HANDLE;
+	memset(gRenderer->targetRenderPasses, 0, sizeof(gRenderer->targetRenderPasses));
+	if (gRenderer->dynamicRendering)
+		return;
+	uint32_t attachCount;
 	if (gRenderer->config.msaa != 1) {
-		attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-		attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		attachments[2].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[2].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		attachCount = 3; // colour, depth, resolve
 	} else {
-		attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-		attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachCount = 2; // colour, depth
 	}
-	result = vkCreateRenderPass(gRenderer->ld->dev, &renderPassCreateInfo, VK_NULL_HANDLE, &gRenderer->externalTargetRenderPass);
-    if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
-        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to create render pass, out of memory.");
-        return;
-    } else if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
-        vk2dRaise(VK2D_STATUS_OUT_OF_VRAM, "Failed to create render pass, out of video memory.");
-        return;
-    }
+	VkAttachmentDescription attachments[3];
+	memset(attachments, 0, sizeof(VkAttachmentDescription) * attachCount);
+	attachments[0].format = gRenderer->surfaceFormat.format;
+	attachments[0].samples = (VkSampleCountFlagBits)gRenderer->config.msaa;
+	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[0].finalLayout = gRenderer->config.msaa > 1 ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	attachments[1].format = gRenderer->depthBufferFormat;
+	attachments[1].samples = (VkSampleCountFlagBits)gRenderer->config.msaa;
+	attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	if (gRenderer->config.msaa != 1) {
+		attachments[2].format = gRenderer->surfaceFormat.format;
+		attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+		attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachments[2].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	}
+	if (!_vk2dRendererBuildRenderPass(attachments, attachCount, &gRenderer->renderPass))
+		return;
+
+	// The default passes for mid-frame switching back to the swapchain and rendering to textures, the rest
+	// are made the first time a set of target ops needs them
+	gRenderer->midFrameSwapRenderPass = _vk2dRendererGetTargetRenderPass(true, NULL);
+	gRenderer->externalTargetRenderPass = _vk2dRendererGetTargetRenderPass(false, NULL);
+	if (vk2dStatusFatal())
+		return;
 
     vk2dLogInfo("Render pass initialized...");
 }
@@ -671,8 +1739,13 @@ void _vk2dRendererCreateRenderPass() {
 void _vk2dRendererDestroyRenderPass() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	vkDestroyRenderPass(gRenderer->ld->dev, gRenderer->renderPass, VK_NULL_HANDLE);
-	vkDestroyRenderPass(gRenderer->ld->dev, gRenderer->externalTargetRenderPass, VK_NULL_HANDLE);
-	vkDestroyRenderPass(gRenderer->ld->dev, gRenderer->midFrameSwapRenderPass, VK_NULL_HANDLE);
+	VkRenderPass *passes = &gRenderer->targetRenderPasses[0][0][0][0];
+	for (uint32_t i = 0; i < sizeof(gRenderer->targetRenderPasses) / sizeof(VkRenderPass); i++) {
+		vkDestroyRenderPass(gRenderer->ld->dev, passes[i], VK_NULL_HANDLE);
+		passes[i] = VK_NULL_HANDLE;
+	}
+	gRenderer->midFrameSwapRenderPass = VK_NULL_HANDLE;
+	gRenderer->externalTargetRenderPass = VK_NULL_HANDLE;
 }
 
 void _vk2dRendererCreateDescriptorSetLayouts() {
@@ -823,6 +1896,7 @@ void _vk2dRendererCreatePipelines() {
 
 	// Texture pipeline
     VkDescriptorSetLayout instancedLayout[] = {gRenderer->dslBufferVP, gRenderer->dslSampler, gRenderer->dslTextureArray, gRenderer->dslBufferSBO};
+    VkDescriptorSetLayout shadowsLayout[] = {gRenderer->dslBufferVP, gRenderer->dslBufferSBO};
 
 	// Polygon pipelines
 	gRenderer->primFillPipe = vk2dPipelineCreate(
@@ -867,7 +1941,7 @@ void _vk2dRendererCreatePipelines() {
 			shaderModelFrag,
 			shaderModelFragSize,
             instancedLayout,
-			3,
+			4,
 			&modelVertexInfo,
 			true,
 			gRenderer->config.msaa,
@@ -882,7 +1956,7 @@ void _vk2dRendererCreatePipelines() {
 			shaderModelFrag,
 			shaderModelFragSize,
             instancedLayout,
-			3,
+			4,
 			&modelVertexInfo,
 			false,
 			gRenderer->config.msaa,
@@ -913,8 +1987,8 @@ void _vk2dRendererCreatePipelines() {
             shaderShadowsVertSize,
             shaderShadowsFrag,
             shaderShadowsFragSize,
-            instancedLayout,
-            1,
+            shadowsLayout,
+            2,
             &shadowsVertexInfo,
             true,
             gRenderer->config.msaa,
@@ -961,6 +2035,9 @@ void _vk2dRendererCreateFrameBuffer() {
     if (vk2dStatusFatal())
         return;
 	uint32_t i;
+	gRenderer->framebuffers = NULL;
+	if (gRenderer->dynamicRendering)
+		return;
 	gRenderer->framebuffers = malloc(sizeof(VkFramebuffer) * gRenderer->swapchainImageCount);
 
 	if (gRenderer->framebuffers) {
@@ -1075,6 +2152,68 @@ void _vk2dRendererDestroySpriteBatching() {
     free(gRenderer->drawCommands);
 }
 
+void _vk2dRendererCreateProfiler() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    gRenderer->gpuPassScope = -1;
+    gRenderer->gpuComputeScope = -1;
+    if (vk2dStatusFatal())
+        return;
+
+    // Frame times are always kept, GPU times are filled in if the profiler is on
+    gRenderer->frameTimes = calloc(gRenderer->options.frameTimeHistory, sizeof(VK2DFrameTime));
+    if (gRenderer->frameTimes == NULL) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate frame time history.");
+        return;
+    }
+
+    if (!gRenderer->options.enableGPUProfiler)
+        return;
+    if (!gRenderer->pd->props.limits.timestampComputeAndGraphics) {
+        vk2dLogWarn("Device does not support timestamps on the graphics queue, GPU profiler disabled.");
+        return;
+    }
+
+    gRenderer->gpuTimestampPeriod = gRenderer->pd->props.limits.timestampPeriod;
+    gRenderer->gpuTimings = calloc(VK2D_MAX_GPU_SCOPES, sizeof(VK2DGPUTiming));
+    if (gRenderer->gpuTimings == NULL) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate GPU profiler.");
+        return;
+    }
+    gRenderer->gpuProfiling = true;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = VK2D_MAX_GPU_SCOPES * 2,
+    };
+    for (int i = 0; i < gRenderer->options.framesInFlight; i++) {
+        VK2DFrameContext *frame = &gRenderer->frames[i];
+        frame->gpuScopes = calloc(VK2D_MAX_GPU_SCOPES, sizeof(VK2DGPUScope));
+        if (frame->gpuScopes == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate GPU profiler.");
+            return;
+        }
+        VkResult result = vkCreateQueryPool(gRenderer->ld->dev, &queryPoolCreateInfo, VK_NULL_HANDLE, &frame->gpuQueryPool);
+        if (result != VK_SUCCESS)
+            vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create timestamp query pool, Vulkan error %i.", result);
+    }
+}
+
+void _vk2dRendererDestroyProfiler() {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    for (int i = 0; i < gRenderer->options.framesInFlight; i++) {
+        VK2DFrameContext *frame = &gRenderer->frames[i];
+        vkDestroyQueryPool(gRenderer->ld->dev, frame->gpuQueryPool, VK_NULL_HANDLE);
+        free(frame->gpuScopes);
+        frame->gpuQueryPool = VK_NULL_HANDLE;
+        frame->gpuScopes = NULL;
+    }
+    free(gRenderer->gpuTimings);
+    free(gRenderer->frameTimes);
+    gRenderer->gpuProfiling = false;
+    gRenderer->frameTimes = NULL;
+}
+
 void _vk2dRendererCreateDescriptorPool(bool preserveDescCons) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
@@ -1084,10 +2223,10 @@ void _vk2dRendererCreateDescriptorPool(bool preserveDescCons) {
 		gRenderer->descConSamplersOff = vk2dDescConCreate(gRenderer->ld, gRenderer->dslTexture, VK2D_NO_LOCATION, 2, VK2D_NO_LOCATION);
 		gRenderer->descConVP = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferVP, 0, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
 		gRenderer->descConUser = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferUser, 3, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
-		for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
-            gRenderer->descConCompute[i] = vk2dDescConCreate(gRenderer->ld, gRenderer->dslSpriteBatch, VK2D_NO_LOCATION, VK2D_NO_LOCATION, 0);
-            gRenderer->descConShaders[i] = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferUser, 3, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
-            gRenderer->descConSBO[i] = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferSBO, VK2D_NO_LOCATION, VK2D_NO_LOCATION, 3);
+		for (int i = 0; i < gRenderer->options.framesInFlight; i++) {
+            gRenderer->frames[i].descConCompute = vk2dDescConCreate(gRenderer->ld, gRenderer->dslSpriteBatch, VK2D_NO_LOCATION, VK2D_NO_LOCATION, 0);
+            gRenderer->frames[i].descConShaders = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferUser, 3, VK2D_NO_LOCATION, VK2D_NO_LOCATION);
+            gRenderer->frames[i].descConSBO = vk2dDescConCreate(gRenderer->ld, gRenderer->dslBufferSBO, VK2D_NO_LOCATION, VK2D_NO_LOCATION, 3);
         }
 
 		// And the one sampler set
@@ -1148,9 +2287,17 @@ void _vk2dRendererCreateDescriptorPool(bool preserveDescCons) {
             vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate texture info for %i potential textures.", gRenderer->options.maxTextures);
         }
 
+        // Evicted textures are pointed at this until they're reloaded
+        gRenderer->evictedImage = NULL;
+        gRenderer->texturesPendingReload = 0;
+        if (gRenderer->options.vramEvictionThreshold > 0) {
+            const uint8_t transparent[4] = {0};
+            gRenderer->evictedImage = vk2dImageFromPixels(gRenderer->ld, transparent, 1, 1, true);
+        }
+
         // Make the viewproj descriptor sets
-        for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++)
-            gRenderer->uboDescriptorSets[i] = vk2dDescConGetSet(gRenderer->descConVP);
+        for (int i = 0; i < gRenderer->options.framesInFlight; i++)
+            gRenderer->frames[i].uboDescriptorSet = vk2dDescConGetSet(gRenderer->descConVP);
 	} else {
         vk2dLogInfo("Descriptor controllers preserved...");
 	}
@@ -1163,13 +2310,15 @@ void _vk2dRendererDestroyDescriptorPool(bool preserveDescCons) {
 		vk2dDescConFree(gRenderer->descConSamplersOff);
 		vk2dDescConFree(gRenderer->descConVP);
 		vk2dDescConFree(gRenderer->descConUser);
-        for (int i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
-            vk2dDescConFree(gRenderer->descConCompute[i]);
-            vk2dDescConFree(gRenderer->descConShaders[i]);
-            vk2dDescConFree(gRenderer->descConSBO[i]);
+        for (int i = 0; i < gRenderer->options.framesInFlight; i++) {
+            vk2dDescConFree(gRenderer->frames[i].descConCompute);
+            vk2dDescConFree(gRenderer->frames[i].descConShaders);
+            vk2dDescConFree(gRenderer->frames[i].descConSBO);
         }
         vkDestroyDescriptorPool(gRenderer->ld->dev, gRenderer->samplerPool, VK_NULL_HANDLE);
         vkDestroyDescriptorPool(gRenderer->ld->dev, gRenderer->texArrayPool, VK_NULL_HANDLE);
+        _vk2dRendererDestroyTextureReloads();
+        vk2dImageFree(gRenderer->evictedImage);
         free(gRenderer->textureArray);
     }
 }
@@ -1180,22 +2329,38 @@ void _vk2dRendererCreateSynchronization() {
         return;
 	uint32_t i;
 	VkSemaphoreCreateInfo semaphoreCreateInfo = vk2dInitSemaphoreCreateInfo(0);
-	VkFenceCreateInfo fenceCreateInfo = vk2dInitFenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT);
-	gRenderer->imageAvailableSemaphores = calloc(1, sizeof(VkSemaphore) * VK2D_MAX_FRAMES_IN_FLIGHT);
 	gRenderer->renderFinishedSemaphores = calloc(1, sizeof(VkSemaphore) * gRenderer->swapchainImageCount);
-	gRenderer->inFlightFences = calloc(1, sizeof(VkFence) * VK2D_MAX_FRAMES_IN_FLIGHT);
-	gRenderer->imagesInFlight = calloc(1, sizeof(VkFence) * gRenderer->swapchainImageCount);
-	gRenderer->commandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
-    gRenderer->dbCommandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
-    gRenderer->computeCommandBuffer = calloc(1, sizeof(VkCommandBuffer) * gRenderer->swapchainImageCount);
-
-    if (gRenderer->imageAvailableSemaphores != NULL && gRenderer->renderFinishedSemaphores != NULL
-		&& gRenderer->inFlightFences != NULL && gRenderer->imagesInFlight != NULL) {
-		for (i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
-			VkResult r3 = vkCreateFence(gRenderer->ld->dev, &fenceCreateInfo, VK_NULL_HANDLE, &gRenderer->inFlightFences[i]);
-            VkResult r1 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &gRenderer->imageAvailableSemaphores[i]);
-			if (r3 != VK_SUCCESS || r1 != VK_SUCCESS)
-			    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create synchronization objects, Vulkan error %i/%i.", r1, r3);
+	gRenderer->imagesInFlight = calloc(gRenderer->swapchainImageCount, sizeof(uint64_t));
+
+    if (gRenderer->renderFinishedSemaphores != NULL && gRenderer->imagesInFlight != NULL) {
+		for (i = 0; i < gRenderer->options.framesInFlight; i++) {
+			VK2DFrameContext *frame = &gRenderer->frames[i];
+            VkResult r1 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &frame->imageAvailableSemaphore);
+			if (r1 != VK_SUCCESS)
+			    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create synchronization objects, Vulkan error %i.", r1);
+			frame->timelineValue = 0;
+            frame->commandBuffer = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
+			frame->computeFinishedSemaphore = VK_NULL_HANDLE;
+			if (gRenderer->ld->computeQueue != VK_NULL_HANDLE) {
+				// Descriptor buffer copies and sprite batch compute go to the async compute queue
+				VkCommandBuffer computeBuffers[2];
+				VkCommandBufferAllocateInfo allocInfo = vk2dInitCommandBufferAllocateInfo(gRenderer->ld->computePool, 2);
+				VkResult r3 = vkAllocateCommandBuffers(gRenderer->ld->dev, &allocInfo, computeBuffers);
+				VkResult r4 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &frame->computeFinishedSemaphore);
+				if (r3 != VK_SUCCESS || r4 != VK_SUCCESS)
+					vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create async compute objects, Vulkan error %i.", r3 != VK_SUCCESS ? r3 : r4);
+				frame->dbCommandBuffer = computeBuffers[0];
+				frame->computeCommandBuffer = computeBuffers[1];
+			} else {
+				frame->dbCommandBuffer = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
+				frame->computeCommandBuffer = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
+			}
+
+			// Frame graph passes are allocated as they're needed
+			frame->screenPassBuffer = gRenderer->options.enableFrameGraph ? vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, false) : VK_NULL_HANDLE;
+			frame->graphPasses = NULL;
+			frame->graphPassCount = 0;
+			frame->graphPassCapacity = 0;
 		}
         for (i = 0; i < gRenderer->swapchainImageCount; i++) {
             VkResult r2 = vkCreateSemaphore(gRenderer->ld->dev, &semaphoreCreateInfo, VK_NULL_HANDLE, &gRenderer->renderFinishedSemaphores[i]);
@@ -1206,16 +2371,6 @@ void _vk2dRendererCreateSynchronization() {
 	    vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate synchronization objects.");
 	}
 
-	if (gRenderer->commandBuffer != NULL && gRenderer->dbCommandBuffer != NULL) {
-		for (i = 0; i < gRenderer->swapchainImageCount; i++) {
-			gRenderer->commandBuffer[i] = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
-            gRenderer->dbCommandBuffer[i] = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
-            gRenderer->computeCommandBuffer[i] = vk2dLogicalDeviceGetCommandBuffer(gRenderer->ld, true);
-        }
-	} else {
-        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to allocate synchronization objects.");
-	}
-
 	if (!vk2dStatusFatal())
         vk2dLogInfo("Synchronization initialized...");
 }
@@ -1224,23 +2379,43 @@ void _vk2dRendererDestroySynchronization() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	uint32_t i;
 
-	if (gRenderer->renderFinishedSemaphores != NULL && gRenderer->imageAvailableSemaphores != NULL && gRenderer->inFlightFences != NULL) {
-        for (i = 0; i < VK2D_MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroySemaphore(gRenderer->ld->dev, gRenderer->imageAvailableSemaphores[i], VK_NULL_HANDLE);
-            vkDestroyFence(gRenderer->ld->dev, gRenderer->inFlightFences[i], VK_NULL_HANDLE);
-        }
+	for (i = 0; i < gRenderer->options.framesInFlight; i++) {
+		VK2DFrameContext *frame = &gRenderer->frames[i];
+		vkDestroySemaphore(gRenderer->ld->dev, frame->imageAvailableSemaphore, VK_NULL_HANDLE);
+		vkDestroySemaphore(gRenderer->ld->dev, frame->computeFinishedSemaphore, VK_NULL_HANDLE);
+		if (frame->commandBuffer != VK_NULL_HANDLE) {
+			vk2dLogicalDeviceFreeCommandBuffer(gRenderer->ld, frame->commandBuffer);
+			if (gRenderer->ld->computeQueue != VK_NULL_HANDLE) {
+				VkCommandBuffer computeBuffers[] = {frame->dbCommandBuffer, frame->computeCommandBuffer};
+				vkFreeCommandBuffers(gRenderer->ld->dev, gRenderer->ld->computePool, 2, computeBuffers);
+			} else {
+				vk2dLogicalDeviceFreeCommandBuffer(gRenderer->ld, frame->dbCommandBuffer);
+				vk2dLogicalDeviceFreeCommandBuffer(gRenderer->ld, frame->computeCommandBuffer);
+			}
+		}
+		if (frame->screenPassBuffer != VK_NULL_HANDLE)
+			vk2dLogicalDeviceFreeCommandBuffer(gRenderer->ld, frame->screenPassBuffer);
+		for (uint32_t j = 0; j < frame->graphPassCapacity; j++)
+			vk2dLogicalDeviceFreeCommandBuffer(gRenderer->ld, frame->graphPasses[j].buffer);
+		free(frame->graphPasses);
+		frame->graphPasses = NULL;
+		frame->graphPassCount = 0;
+		frame->graphPassCapacity = 0;
+		frame->screenPassBuffer = VK_NULL_HANDLE;
+		frame->imageAvailableSemaphore = VK_NULL_HANDLE;
+		frame->computeFinishedSemaphore = VK_NULL_HANDLE;
+		frame->commandBuffer = VK_NULL_HANDLE;
+		frame->dbCommandBuffer = VK_NULL_HANDLE;
+		frame->computeCommandBuffer = VK_NULL_HANDLE;
+	}
 
+	if (gRenderer->renderFinishedSemaphores != NULL) {
         for (i = 0; i < gRenderer->swapchainImageCount; i++) {
             vkDestroySemaphore(gRenderer->ld->dev, gRenderer->renderFinishedSemaphores[i], VK_NULL_HANDLE);
         }
     }
 	free(gRenderer->imagesInFlight);
-	free(gRenderer->inFlightFences);
-	free(gRenderer->imageAvailableSemaphores);
 	free(gRenderer->renderFinishedSemaphores);
-    free(gRenderer->commandBuffer);
-    free(gRenderer->dbCommandBuffer);
-    free(gRenderer->computeCommandBuffer);
 }
 
 void _vk2dRendererCreateSampler() {
@@ -1337,6 +2512,9 @@ void _vk2dRendererRefreshTargets() {
 
 			// Framebuffer
 			vkDestroyFramebuffer(gRenderer->ld->dev, gRenderer->targets[i]->fbo, VK_NULL_HANDLE);
+			gRenderer->targets[i]->fbo = VK_NULL_HANDLE;
+			if (gRenderer->dynamicRendering)
+				continue;
 			const int attachCount = gRenderer->config.msaa > 1 ? 3 : 2;
 			VkImageView attachments[3];
 			if (gRenderer->config.msaa > 1) {
@@ -1376,23 +2554,14 @@ void nkFree(nk_handle handle, void *old) {
 }
 
 void _vk2dRendererInitNuklear() {
-	static const size_t MAX_VERTEX_BUFFER = 512 * 1024;
-	static const size_t MAX_ELEMENT_BUFFER = 128 * 1024;
 	VK2DRenderer vk2d = vk2dRendererGetPointer();
 
 	if (vk2d->options.enableNuklear) {
-        VkDevice device = vk2d->ld->dev;
-        VkPhysicalDevice physical_device = vk2d->pd->dev;
-        const uint32_t graphics_queue_family_index
-                = vk2d->pd->QueueFamily.graphicsFamily;
-        VkImageView *image_views = vk2d->swapchainImageViews;
-        const uint32_t image_views_len = vk2d->swapchainImageCount;
-        const int COLOR_FORMAT = vk2d->surfaceFormat.format;
-        static const int INIT_STATE = NK_SDL_DEFAULT;
-        struct nk_context *ctx = nk_sdl_init(vk2d->window, device,
-                                             physical_device, graphics_queue_family_index, image_views,
-                                             image_views_len, COLOR_FORMAT, INIT_STATE, MAX_VERTEX_BUFFER,
-                                             MAX_ELEMENT_BUFFER);
+        // Nuklear draws inside the screen pass so its pipeline is built against the renderer's
+        struct nk_context *ctx = nk_sdl_init(vk2d->window, vk2d->ld->dev, vk2d->renderPass,
+                                             (VkSampleCountFlagBits)vk2d->config.msaa, vk2d->surfaceFormat.format,
+                                             vk2d->depthBufferFormat, vk2d->options.framesInFlight,
+                                             vk2d->dslSampler, vk2d->dslTextureArray);
         vk2d->gui = malloc(sizeof(*vk2d->gui));
         vk2d->gui->fonts = NULL;
         vk2d->gui->fontsCount = 0;
@@ -1403,7 +2572,10 @@ void _vk2dRendererInitNuklear() {
 
 		struct nk_font *fnt = nk_font_atlas_add_default(vk2d->gui->atlas, 16, NULL);
 
-		nk_sdl_font_stash_end(vk2d->ld->queue);
+		const void *pixels = nk_sdl_font_stash_bake(&imgWidth, &imgHeight);
+		vk2d->gui->atlasImage = vk2dImageFromPixels(vk2d->ld, pixels, imgWidth, imgHeight, true);
+		vk2d->gui->atlasTexture = vk2d->gui->atlasImage != NULL ? vk2dTextureLoadFromImage(vk2d->gui->atlasImage) : NULL;
+		nk_sdl_font_stash_end(vk2d->gui->atlasTexture != NULL ? vk2dTextureGetID(vk2d->gui->atlasTexture) : 0);
 
         nk_style_set_font(ctx, &fnt->handle);
 
@@ -1418,6 +2590,8 @@ void _vk2dRendererQuitNuklear() {
 	if (gRenderer->options.enableNuklear) {
         nk_sdl_shutdown();
         assert(gRenderer->gui != NULL);
+        vk2dTextureFree(gRenderer->gui->atlasTexture);
+        vk2dImageFree(gRenderer->gui->atlasImage);
         struct VK2DFontHandle *tmp, *font;
         HASH_ITER(hh, gRenderer->gui->fonts, font, tmp) {
             HASH_DEL(gRenderer->gui->fonts, font);
@@ -1435,13 +2609,51 @@ void _vk2dRendererResetNuklear() {
     if (gRenderer->options.enableNuklear) {
         if (vk2dStatusFatal())
             return;
-        nk_sdl_resize(gRenderer->swapchainImageViews,
-                      gRenderer->swapchainImageCount,
+        nk_sdl_resize(gRenderer->renderPass,
+                      (VkSampleCountFlagBits)gRenderer->config.msaa,
                       gRenderer->surfaceWidth,
                       gRenderer->surfaceHeight);
     }
 }
 
+void _vk2dRendererDrawNuklear(VkCommandBuffer buf) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VK2DFrameContext *frame = &gRenderer->frames[gRenderer->currentFrame];
+    const void *vertices;
+    const void *elements;
+    nk_size verticesSize, elementsSize;
+    float projection[16];
+    nk_sdl_convert(NK_ANTI_ALIASING_ON, &vertices, &verticesSize, &elements, &elementsSize, projection);
+    if (elementsSize == 0)
+        return;
+
+    // Nuklear's draw list is arbitrary indexed triangles with per-vertex colour and a scissor rect per
+    // command, which the sprite batch's one-quad-per-instance records can't express, so it keeps its own
+    // pipeline. It samples the same texture array as everything else though, its texture handles are
+    // texture IDs and every texture it draws is touched so it takes part in residency tracking.
+
+    // Everything goes through this frame's descriptor buffer, so each piece has to fit in a page
+    if (verticesSize >= gRenderer->options.vramPageSize || elementsSize >= gRenderer->options.vramPageSize) {
+        vk2dLogWarn("Nuklear needs %i bytes of vertices and %i bytes of indices but the descriptor buffer page size is %i, the GUI will not be drawn this frame.", (int)verticesSize, (int)elementsSize, (int)gRenderer->options.vramPageSize);
+        return;
+    }
+
+    VkBuffer vertexBuffer, indexBuffer, uniformBuffer;
+    VkDeviceSize vertexOffset, indexOffset, uniformOffset;
+    vk2dDescriptorBufferCopyData(frame->descriptorBuffer, (void*)vertices, verticesSize, &vertexBuffer, &vertexOffset);
+    vk2dDescriptorBufferCopyData(frame->descriptorBuffer, (void*)elements, elementsSize, &indexBuffer, &indexOffset);
+    vk2dDescriptorBufferCopyData(frame->descriptorBuffer, projection, sizeof(projection), &uniformBuffer, &uniformOffset);
+    if (vertexBuffer == VK_NULL_HANDLE || indexBuffer == VK_NULL_HANDLE || uniformBuffer == VK_NULL_HANDLE)
+        return;
+
+    const int32_t scope = _vk2dRendererBeginGPUScope(buf, "Nuklear", VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    gRenderer->frameStats.drawCalls += nk_sdl_render(buf, gRenderer->currentFrame, vertexBuffer, vertexOffset, indexBuffer, indexOffset, uniformBuffer, uniformOffset, gRenderer->samplerSet, gRenderer->texArrayDescriptorSet, _vk2dRendererTouchTexture);
+    gRenderer->frameStats.pipelineBinds++;
+    gRenderer->frameStats.descriptorSetBinds++;
+    _vk2dRendererEndGPUScope(buf, scope);
+    _vk2dRendererResetBoundPointers();
+}
+
 // If the window is resized or minimized or whatever
 void _vk2dRendererResetSwapchain() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
@@ -1450,11 +2662,14 @@ void _vk2dRendererResetSwapchain() {
 
 	// Hang while minimized
 	SDL_WindowFlags flags;
-	flags = SDL_GetWindowFlags(gRenderer->window);
+	flags = gRenderer->window != NULL ? SDL_GetWindowFlags(gRenderer->window) : 0;
 	while (flags & SDL_WINDOW_MINIMIZED) {
 		flags = SDL_GetWindowFlags(gRenderer->window);
 		SDL_PumpEvents();
 	}
+
+	// Present IDs start over with the new swapchain
+	gRenderer->presentId = 0;
 	VkResult result = vkDeviceWaitIdle(gRenderer->ld->dev);
     if (result == VK_ERROR_OUT_OF_HOST_MEMORY) {
         vk2dRaise(VK2D_STATUS_OUT_OF_RAM,"Out of memory.");
@@ -1508,7 +2723,7 @@ void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+    VkCommandBuffer buf = gRenderer->drawBuffer;
 
     // Account for various coordinate-based qualms
     originX *= -xscale;
@@ -1546,10 +2761,12 @@ void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon
     uint64_t hash = _vk2dHashSets(sets, setCount);
     if (gRenderer->prevPipe != vk2dPipelineGetPipe(pipe, gRenderer->blendMode)) {
         vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(pipe, gRenderer->blendMode));
+        gRenderer->frameStats.pipelineBinds++;
         gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
     }
     if (gRenderer->prevSetHash != hash) {
         vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+        gRenderer->frameStats.descriptorSetBinds++;
         gRenderer->prevSetHash = hash;
     }
     if (poly != NULL && gRenderer->prevVBO != poly->vertices->buf) {
@@ -1596,13 +2813,14 @@ void _vk2dRendererDrawRaw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon
         vkCmdDraw(buf, poly->vertexCount, 1, 0, 0);
     else // The only time this would be the case is for textures, where the shader provides the vertices
         vkCmdDraw(buf, 6, 1, 0, 0);
+    gRenderer->frameStats.drawCalls++;
 }
 
 void _vk2dRendererDrawRawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTexture tex, VK2DPipeline pipe, float x, float y, float xscale, float yscale, float rot, float originX, float originY, float lineWidth, float xInTex, float yInTex, float texWidth, float texHeight, VK2DCameraIndex cam) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+    VkCommandBuffer buf = gRenderer->drawBuffer;
 
     // Account for various coordinate-based qualms
     originX *= -xscale;
@@ -1645,10 +2863,12 @@ void _vk2dRendererDrawRawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTe
     uint64_t hash = _vk2dHashSets(sets, setCount);
     if (gRenderer->prevPipe != vk2dPipelineGetPipe(pipe, gRenderer->blendMode)) {
         vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(pipe, gRenderer->blendMode));
+        gRenderer->frameStats.pipelineBinds++;
         gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
     }
     if (gRenderer->prevSetHash != hash) {
         vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+        gRenderer->frameStats.descriptorSetBinds++;
         gRenderer->prevSetHash = hash;
     }
 
@@ -1687,36 +2907,37 @@ void _vk2dRendererDrawRawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTe
         vkCmdSetLineWidth(buf, 1);
     vkCmdPushConstants(buf, pipe->layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(VK2DShaderPushBuffer), &push);
     vkCmdDraw(buf, 6, 1, 0, 0);
+    gRenderer->frameStats.drawCalls++;
 }
 
-void _vk2dRendererDrawRawShadows(VkDescriptorSet set, VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object, vec4 colour, vec2 lightSource, VK2DCameraIndex cam) {
+void _vk2dRendererDrawRawShadows(VkDescriptorSet *sets, vec4 colour, vec2 lightSource, float radius, VkBuffer *buffers, VkDeviceSize *offsets, uint32_t edgeCount, VK2DCameraIndex cam) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-    VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+    VkCommandBuffer buf = gRenderer->drawBuffer;
     VK2DPipeline pipe = gRenderer->shadowsPipe;
-    VK2DShadowObjectInfo *objInfo = &shadowEnvironment->objectInfos[object];
 
-    // Push constants
+    // Push constants, each edge's model comes from the object buffer
     VK2DShadowsPushBuffer push = {0};
     push.lightSource[0] = lightSource[0];
     push.lightSource[1] = lightSource[1];
+    push.radius = radius > 0 ? radius : 0;
     push.colour[0] = colour[0];
     push.colour[1] = colour[1];
     push.colour[2] = colour[2];
     push.colour[3] = colour[3];
     push.cameraIndex = cam == VK2D_INVALID_CAMERA ? 0 : cam;
-    memcpy(push.model, objInfo->model, sizeof(mat4));
     // Check if we actually need to bind things
     if (gRenderer->prevPipe != vk2dPipelineGetPipe(pipe, gRenderer->blendMode)) {
         vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(pipe, gRenderer->blendMode));
+        gRenderer->frameStats.pipelineBinds++;
         gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
     }
     gRenderer->prevSetHash = 0;
-    VkDeviceSize offsets = shadowEnvironment->vbo->offset;
-    vkCmdBindVertexBuffers(buf, 0, 1, &shadowEnvironment->vbo->buf, &offsets);
+    vkCmdBindVertexBuffers(buf, 0, 2, buffers, offsets);
     gRenderer->prevVBO = NULL;
-    vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->shadowsPipe->layout, 0, 1, &set, 0, VK_NULL_HANDLE);
+    vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->shadowsPipe->layout, 0, 2, sets, 0, VK_NULL_HANDLE);
+    gRenderer->frameStats.descriptorSetBinds++;
 
     // Dynamic state that can't be optimized further and the draw call
     cam = cam == VK2D_INVALID_CAMERA ? VK2D_DEFAULT_CAMERA : cam; // Account for invalid camera
@@ -1748,19 +2969,22 @@ void _vk2dRendererDrawRawShadows(VkDescriptorSet set, VK2DShadowEnvironment shad
     vkCmdSetViewport(buf, 0, 1, &viewport);
     vkCmdSetScissor(buf, 0, 1, &scissor);
     vkCmdPushConstants(buf, pipe->layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(VK2DShadowsPushBuffer), &push);
-    vkCmdDraw(buf, objInfo->vertexCount, 1, objInfo->startingVertex, 0);
+    vkCmdDraw(buf, 6, edgeCount, 0, 0);
+    gRenderer->frameStats.drawCalls++;
 }
 
 void _vk2dRendererDrawRawInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2DDrawInstance *instances, int count, VK2DCameraIndex cam) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-	VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
+	VkCommandBuffer buf = gRenderer->drawBuffer;
 
 	// We don't do any binding saving for instanced drawing
 	_vk2dRendererResetBoundPointers();
 	vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(gRenderer->instancedPipe, gRenderer->blendMode));
+	gRenderer->frameStats.pipelineBinds++;
 	vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, gRenderer->instancedPipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+	gRenderer->frameStats.descriptorSetBinds++;
 
 	// Dynamic state that can't be optimized further and the draw call
 	cam = cam == VK2D_INVALID_CAMERA ? VK2D_DEFAULT_CAMERA : cam; // Account for invalid camera
@@ -1792,22 +3016,18 @@ void _vk2dRendererDrawRawInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2
 	// Make vertex buffer
 	VkBuffer buffer;
 	VkDeviceSize offset;
-	vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], instances, count * sizeof(VK2DDrawInstance), &buffer, &offset);
+	vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, instances, count * sizeof(VK2DDrawInstance), &buffer, &offset);
 
 	vkCmdBindVertexBuffers(buf, 0, 1, &buffer, &offset);
 	vkCmdSetViewport(buf, 0, 1, &viewport);
 	vkCmdSetScissor(buf, 0, 1, &scissor);
 	vkCmdSetLineWidth(buf, 1);
 	vkCmdDraw(buf, 6, count, 0, 0);
+	gRenderer->frameStats.drawCalls++;
 }
 
 // Same as above but for 3D rendering
-void _vk2dRendererDrawRaw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ, VK2DCameraIndex cam, float lineWidth) {
-	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (vk2dStatusFatal())
-        return;
-	VkCommandBuffer buf = gRenderer->commandBuffer[gRenderer->scImageIndex];
-
+void _vk2dRendererModelMatrix(mat4 model, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ) {
 	// Account for various coordinate-based qualms
 	originX *= xscale;
 	originY *= yscale;
@@ -1816,16 +3036,25 @@ void _vk2dRendererDrawRaw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel
 	//originY -= yInTex;
 	rot *= -1;
 
-	// Push constants
-	VK2D3DPushBuffer push = {0};
-	identityMatrix(push.model);
+	memset(model, 0, sizeof(mat4));
+	identityMatrix(model);
 	vec3 originTranslation = {-originX, -originY, -originZ};
 	vec3 origin2 = {originX + x, originY + y, originZ + z};
 	vec3 scale = {xscale, yscale, zscale};
-	translateMatrix(push.model, origin2);
-	rotateMatrix(push.model, axis, rot);
-	translateMatrix(push.model, originTranslation);
-	scaleMatrix(push.model, scale);
+	translateMatrix(model, origin2);
+	rotateMatrix(model, axis, rot);
+	translateMatrix(model, originTranslation);
+	scaleMatrix(model, scale);
+}
+
+void _vk2dRendererDrawRaw3DInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, int count, VK2DCameraIndex cam, float lineWidth) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal() || count <= 0)
+        return;
+	VkCommandBuffer buf = gRenderer->drawBuffer;
+
+	// Push constants, the model matrices come from the storage buffer in sets[3]
+	VK2D3DPushBuffer push = {0};
 	push.colourMod[0] = gRenderer->colourBlend[0];
 	push.colourMod[1] = gRenderer->colourBlend[1];
 	push.colourMod[2] = gRenderer->colourBlend[2];
@@ -1837,10 +3066,12 @@ void _vk2dRendererDrawRaw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel
 	uint64_t hash = _vk2dHashSets(sets, setCount);
 	if (gRenderer->prevPipe != vk2dPipelineGetPipe(pipe, gRenderer->blendMode)) {
 		vkCmdBindPipeline(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, vk2dPipelineGetPipe(pipe, gRenderer->blendMode));
+		gRenderer->frameStats.pipelineBinds++;
 		gRenderer->prevPipe = vk2dPipelineGetPipe(pipe, gRenderer->blendMode);
 	}
 	if (gRenderer->prevSetHash != hash) {
 		vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe->layout, 0, setCount, sets, 0, VK_NULL_HANDLE);
+		gRenderer->frameStats.descriptorSetBinds++;
 		gRenderer->prevSetHash = hash;
 	}
 	VkDeviceSize offsets[] = {model->vertexOffset};
@@ -1882,19 +3113,59 @@ void _vk2dRendererDrawRaw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel
 	else
 		vkCmdSetLineWidth(buf, 1);
 	vkCmdPushConstants(buf, pipe->layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(VK2D3DPushBuffer), &push);
-	vkCmdDrawIndexed(buf, model->indexCount, 1, 0, 0, 0);
+	vkCmdDrawIndexed(buf, model->indexCount, count, 0, 0, 0);
+	gRenderer->frameStats.drawCalls++;
 }
 
 // Same as _vk2dRendererDraw below but specifically for 3D rendering
 void _vk2dRendererDraw3D(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, float x, float y, float z, float xscale, float yscale, float zscale, float rot, vec3 axis, float originX, float originY, float originZ, float lineWidth) {
+	// A single draw is just an instanced draw of one
+	mat4 transform;
+	_vk2dRendererModelMatrix(transform, x, y, z, xscale, yscale, zscale, rot, axis, originX, originY, originZ);
+	_vk2dRendererDraw3DInstanced(sets, setCount, model, pipe, (const mat4 *)&transform, 1, lineWidth);
+}
+
+// Same as _vk2dRendererDraw3D but for any number of copies of the model
+void _vk2dRendererDraw3DInstanced(VkDescriptorSet *sets, uint32_t setCount, VK2DModel model, VK2DPipeline pipe, const mat4 *transforms, int count, float lineWidth) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-	// Only render to 3D cameras
-	for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
-		if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type != VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
-			sets[0] = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
-			_vk2dRendererDrawRaw3D(sets, setCount, model, pipe, x, y, z, xscale, yscale, zscale, rot, axis, originX, originY, originZ, i, lineWidth);
+
+	// Transforms go through the descriptor buffer so they have to be split into pieces smaller than a page
+	const int maxTransforms = (gRenderer->options.vramPageSize - 1) / sizeof(mat4);
+	for (int start = 0; start < count && !vk2dStatusFatal(); start += maxTransforms) {
+		const int chunk = count - start < maxTransforms ? count - start : maxTransforms;
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, (void*)&transforms[start], chunk * sizeof(mat4), &buffer, &offset);
+		if (buffer == VK_NULL_HANDLE)
+			return;
+
+		// The vertex shader finds each copy's transform by gl_InstanceIndex
+		sets[3] = vk2dDescConGetSet(gRenderer->frames[gRenderer->currentFrame].descConSBO);
+		if (sets[3] == VK_NULL_HANDLE)
+			return;
+		VkDescriptorBufferInfo transformsInfo = {
+				.buffer = buffer,
+				.offset = offset,
+				.range = chunk * sizeof(mat4)
+		};
+		VkWriteDescriptorSet write = {
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = sets[3],
+				.dstBinding = 3,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pBufferInfo = &transformsInfo
+		};
+		vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+
+		// Only render to 3D cameras
+		for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
+			if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type != VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
+				sets[0] = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet;
+				_vk2dRendererDrawRaw3DInstanced(sets, setCount, model, pipe, chunk, i, lineWidth);
+			}
 		}
 	}
 }
@@ -1911,7 +3182,7 @@ void _vk2dRendererDraw(VkDescriptorSet *sets, uint32_t setCount, VK2DPolygon pol
         // Only render to 2D cameras
         for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
             if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
-                sets[0] = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
+                sets[0] = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet;
                 _vk2dRendererDrawRaw(sets, setCount, poly, pipe, x, y, xscale, yscale, rot, originX, originY, lineWidth, xInTex, yInTex, texWidth, texHeight, i);
             }
         }
@@ -1929,42 +3200,115 @@ void _vk2dRendererDrawShader(VkDescriptorSet *sets, uint32_t setCount, VK2DTextu
         // Only render to 2D cameras
         for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
             if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
-                sets[0] = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
+                sets[0] = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet;
                 _vk2dRendererDrawRawShader(sets, setCount, tex, pipe, x, y, xscale, yscale, rot, originX, originY, lineWidth, xInTex, yInTex, texWidth, texHeight, i);
             }
         }
     }
 }
 
+// Whether or not a light's radius reaches into a camera's view, lights without a radius reach everywhere
+static bool _vk2dRendererCameraSeesLight(VK2DCameraIndex cam, vec2 lightSource, float radius) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (radius <= 0 || cam == VK2D_INVALID_CAMERA)
+        return true;
+
+    // Box around the camera's view, rotated views are bounded by a bigger box
+    const VK2DCameraSpec *spec = &gRenderer->cameras[cam].spec;
+    const float halfW = (spec->w / spec->zoom) * 0.5f;
+    const float halfH = (spec->h / spec->zoom) * 0.5f;
+    const float extentX = (fabsf(cosf(spec->rot)) * halfW) + (fabsf(sinf(spec->rot)) * halfH);
+    const float extentY = (fabsf(sinf(spec->rot)) * halfW) + (fabsf(cosf(spec->rot)) * halfH);
+    const float centreX = spec->x + (spec->w * 0.5f);
+    const float centreY = spec->y + (spec->h * 0.5f);
+    return fabsf(lightSource[0] - centreX) <= extentX + radius && fabsf(lightSource[1] - centreY) <= extentY + radius;
+}
+
 // This is the upper level internal draw function for shadows that draws to each camera and not just with a scissor/viewport
-void _vk2dRendererDrawShadows(VK2DShadowEnvironment shadowEnvironment, vec4 colour, vec2 lightSource) {
+void _vk2dRendererDrawShadows(VkDescriptorSet objectSet, vec4 colour, vec2 lightSource, float radius, VkBuffer *buffers, VkDeviceSize *offsets, uint32_t edgeCount) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
-    VkDescriptorSet set;
+    VkDescriptorSet sets[2] = {VK_NULL_HANDLE, objectSet};
     if (gRenderer->target != VK2D_TARGET_SCREEN && !gRenderer->enableTextureCameraUBO) {
-        set = gRenderer->targetUBOSet;
-        for (int so = 0; so < shadowEnvironment->objectCount; so++) {
-            if (shadowEnvironment->objectInfos[so].enabled)
-                _vk2dRendererDrawRawShadows(set, shadowEnvironment, so,
-			colour, lightSource, VK2D_INVALID_CAMERA);
-        }
+        sets[0] = gRenderer->targetUBOSet;
+        _vk2dRendererDrawRawShadows(sets, colour, lightSource, radius, buffers, offsets, edgeCount, VK2D_INVALID_CAMERA);
     } else {
         // Only render to 2D cameras
         for (int i = 0; i < VK2D_MAX_CAMERAS; i++) {
-            if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA)) {
-                set = gRenderer->uboDescriptorSets[gRenderer->currentFrame];
-                // Iterate through each shadow object
-                for (int so = 0; so < shadowEnvironment->objectCount; so++) {
-                    if (shadowEnvironment->objectInfos[so].enabled)
-                        _vk2dRendererDrawRawShadows(set, shadowEnvironment,
-				so, colour, lightSource, i);
-                }
+            if (gRenderer->cameras[i].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[i].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (i == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA) && _vk2dRendererCameraSeesLight(i, lightSource, radius)) {
+                sets[0] = gRenderer->frames[gRenderer->currentFrame].uboDescriptorSet;
+                _vk2dRendererDrawRawShadows(sets, colour, lightSource, radius, buffers, offsets, edgeCount, i);
             }
         }
     }
 }
 
+void _vk2dRendererDrawShadowLights(VK2DShadowEnvironment shadowEnvironment, const VK2DShadowLight *lights, int count) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (vk2dStatusFatal())
+        return;
+    _vk2dShadowEnvironmentBake(shadowEnvironment);
+    if (shadowEnvironment->vbo == NULL || shadowEnvironment->objectBuffer == NULL)
+        return;
+
+    // Keeps the next upload from writing to these buffers until the GPU is done with this frame
+    shadowEnvironment->vboRing[shadowEnvironment->vboCurrent].lastUsedFrame = gRenderer->frameCount;
+    shadowEnvironment->objectRing[shadowEnvironment->objectCurrent].lastUsedFrame = gRenderer->frameCount;
+
+    // Every light reads the objects' models and enabled flags from the same storage buffer
+    VkDescriptorSet objectSet = vk2dDescConGetSet(gRenderer->frames[gRenderer->currentFrame].descConSBO);
+    if (objectSet == VK_NULL_HANDLE)
+        return;
+    VkDescriptorBufferInfo objectBufferInfo = {
+            .buffer = shadowEnvironment->objectBuffer->buf,
+            .offset = shadowEnvironment->objectBuffer->offset,
+            .range = VK_WHOLE_SIZE
+    };
+    VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = objectSet,
+            .dstBinding = 3,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &objectBufferInfo
+    };
+    vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+
+    // Culled edges go through the descriptor buffer so they have to be split into pieces smaller than a page
+    const uint32_t maxEdges = (gRenderer->options.vramPageSize - 1) / sizeof(vec4);
+    for (int i = 0; i < count && !vk2dStatusFatal(); i++) {
+        vec4 colour;
+        vec2 lightSource = {lights[i].position[0], lights[i].position[1]};
+        memcpy(colour, lights[i].colour, sizeof(vec4));
+        if (lights[i].radius <= 0) {
+            VkBuffer buffers[2] = {shadowEnvironment->vbo->buf, shadowEnvironment->vbo->buf};
+            VkDeviceSize offsets[2] = {shadowEnvironment->vbo->offset, shadowEnvironment->vbo->offset + (sizeof(vec4) * shadowEnvironment->bakedEdgeCount)};
+            _vk2dRendererDrawShadows(objectSet, colour, lightSource, 0, buffers, offsets, shadowEnvironment->bakedEdgeCount);
+            continue;
+        }
+
+        // Casters outside a camera's view can still throw shadows into it, so cameras only cull whole lights
+        bool visible = gRenderer->target != VK2D_TARGET_SCREEN && !gRenderer->enableTextureCameraUBO;
+        for (int cam = 0; cam < VK2D_MAX_CAMERAS && !visible; cam++)
+            visible = gRenderer->cameras[cam].state == VK2D_CAMERA_STATE_NORMAL && gRenderer->cameras[cam].spec.type == VK2D_CAMERA_TYPE_DEFAULT && (cam == gRenderer->cameraLocked || gRenderer->cameraLocked == VK2D_INVALID_CAMERA) && _vk2dRendererCameraSeesLight(cam, lightSource, lights[i].radius);
+        if (!visible)
+            continue;
+
+        const uint32_t edgeCount = _vk2dShadowEnvironmentCullLight(shadowEnvironment, lightSource[0], lightSource[1], lights[i].radius);
+        for (uint32_t start = 0; start < edgeCount; start += maxEdges) {
+            const uint32_t chunk = edgeCount - start < maxEdges ? edgeCount - start : maxEdges;
+            VkBuffer buffers[2];
+            VkDeviceSize offsets[2];
+            vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, &shadowEnvironment->lightEdges[start], chunk * sizeof(vec4), &buffers[0], &offsets[0]);
+            vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, &shadowEnvironment->lightObjects[start], chunk * sizeof(uint32_t), &buffers[1], &offsets[1]);
+            if (buffers[0] == VK_NULL_HANDLE || buffers[1] == VK_NULL_HANDLE)
+                return;
+            _vk2dRendererDrawShadows(objectSet, colour, lightSource, lights[i].radius, buffers, offsets, chunk);
+        }
+    }
+}
+
 static void _vk2dRendererAddDrawCommandInternal(VK2DDrawCommand *command) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     memcpy(&gRenderer->drawCommands[gRenderer->drawCommandCount++], command, sizeof(struct VK2DDrawCommand));
@@ -1974,6 +3318,7 @@ void _vk2dRendererAddDrawCommand(VK2DDrawCommand *command) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (vk2dStatusFatal())
         return;
+    _vk2dRendererTouchTexture(command->textureIndex);
     _vk2dRendererAddDrawCommandInternal(command);
 }
 
@@ -1984,11 +3329,14 @@ void _vk2dRendererResetBatch() {
     gRenderer->drawCommandCount = 0;
 }
 
-void _vk2dRendererFlushBatchIfNeeded(VK2DPipeline pipe) {
+void _vk2dRendererFlushBatchIfNeeded(VK2DPipeline pipe, VK2DFlushReason reason) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
-    if (vk2dPipelineGetID(pipe, gRenderer->blendMode) != gRenderer->currentBatchPipelineID || gRenderer->drawCommandCount >= gRenderer->limits.maxInstancedDraws) {
-        vk2dRendererFlushSpriteBatch();
-        gRenderer->currentBatchPipelineID = vk2dPipelineGetID(pipe, 0);
+    const int32_t id = vk2dPipelineGetID(pipe, gRenderer->blendMode);
+    if (id != gRenderer->currentBatchPipelineID || gRenderer->drawCommandCount >= gRenderer->limits.maxInstancedDraws) {
+        _vk2dRendererFlushSpriteBatch(gRenderer->drawCommandCount >= gRenderer->limits.maxInstancedDraws ? VK2D_FLUSH_REASON_OVERFLOW : reason);
+
+        // The ID has the blend mode in it so the next draw in the same blend mode doesn't flush again
+        gRenderer->currentBatchPipelineID = id;
         gRenderer->currentBatchPipeline = pipe;
     }
 }
@@ -6,7 +6,9 @@
 #include "VK2D/Opaque.h"
 #include "VK2D/Constants.h"
 #include "VK2D/Renderer.h"
+#include "VK2D/RendererMeta.h"
 #include "VK2D/Logger.h"
+#include <math.h>
 
 // From Math.h
 void identityMatrix(float m[]);
@@ -14,19 +16,141 @@ void scaleMatrix(float m[], float v[]);
 void translateMatrix(float m[], float v[]);
 void rotateMatrix(float m[], float w[], float r);
 
+// Adds an object to a grid bucket, objects may be in a bucket more than once if several of its cells hash to it
+static void _vk2dShadowGridCellAdd(VK2DShadowGridCell *cell, VK2DShadowObject object) {
+    if (cell->count == cell->size) {
+        VK2DShadowObject *newList = realloc(cell->objects, (cell->size + VK2D_DEFAULT_ARRAY_EXTENSION) * sizeof(VK2DShadowObject));
+        if (newList == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend shadow grid cell.");
+            return;
+        }
+        cell->objects = newList;
+        cell->size += VK2D_DEFAULT_ARRAY_EXTENSION;
+    }
+    cell->objects[cell->count++] = object;
+}
+
+// Removes one occurrence of an object from a grid bucket
+static void _vk2dShadowGridCellRemove(VK2DShadowGridCell *cell, VK2DShadowObject object) {
+    for (int i = 0; i < cell->count; i++) {
+        if (cell->objects[i] == object) {
+            cell->objects[i] = cell->objects[--cell->count];
+            return;
+        }
+    }
+}
+
+static VK2DShadowGridCell *_vk2dShadowEnvironmentGetCell(VK2DShadowEnvironment shadowEnvironment, int x, int y) {
+    const uint32_t hash = ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u);
+    return &shadowEnvironment->grid[hash % VK2D_SHADOW_GRID_BUCKETS];
+}
+
+static void _vk2dShadowEnvironmentGridRemove(VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object) {
+    VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[object];
+    if (!info->inGrid)
+        return;
+    if (info->large) {
+        _vk2dShadowGridCellRemove(&shadowEnvironment->gridLarge, object);
+    } else {
+        for (int y = info->cells[1]; y <= info->cells[3]; y++)
+            for (int x = info->cells[0]; x <= info->cells[2]; x++)
+                _vk2dShadowGridCellRemove(_vk2dShadowEnvironmentGetCell(shadowEnvironment, x, y), object);
+    }
+    info->inGrid = false;
+}
+
+// Recalculates an object's world bounds and moves it to the cells they now cover, if they changed
+static void _vk2dShadowEnvironmentGridUpdate(VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object) {
+    VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[object];
+    if (info->edgeCount == 0)
+        return;
+
+    // The model is affine so the corners of the local bounds are enough to bound the object
+    const float *m = info->model;
+    const float *local = info->localBounds;
+    const float corners[4][2] = {{local[0], local[1]}, {local[2], local[1]}, {local[0], local[3]}, {local[2], local[3]}};
+    for (int i = 0; i < 4; i++) {
+        const float x = (m[0] * corners[i][0]) + (m[4] * corners[i][1]) + m[12];
+        const float y = (m[1] * corners[i][0]) + (m[5] * corners[i][1]) + m[13];
+        info->bounds[0] = i == 0 || x < info->bounds[0] ? x : info->bounds[0];
+        info->bounds[1] = i == 0 || y < info->bounds[1] ? y : info->bounds[1];
+        info->bounds[2] = i == 0 || x > info->bounds[2] ? x : info->bounds[2];
+        info->bounds[3] = i == 0 || y > info->bounds[3] ? y : info->bounds[3];
+    }
+
+    int cells[4];
+    for (int i = 0; i < 4; i++)
+        cells[i] = (int)floorf(info->bounds[i] / VK2D_SHADOW_GRID_CELL_SIZE);
+    const bool large = (int64_t)(cells[2] - cells[0] + 1) * (cells[3] - cells[1] + 1) > VK2D_SHADOW_GRID_MAX_CELLS;
+    if (info->inGrid && info->large == large && (large || memcmp(cells, info->cells, sizeof(cells)) == 0))
+        return;
+
+    _vk2dShadowEnvironmentGridRemove(shadowEnvironment, object);
+    memcpy(info->cells, cells, sizeof(cells));
+    info->large = large;
+    info->inGrid = true;
+    if (large) {
+        _vk2dShadowGridCellAdd(&shadowEnvironment->gridLarge, object);
+    } else {
+        for (int y = cells[1]; y <= cells[3]; y++)
+            for (int x = cells[0]; x <= cells[2]; x++)
+                _vk2dShadowGridCellAdd(_vk2dShadowEnvironmentGetCell(shadowEnvironment, x, y), object);
+    }
+}
+
+// Adds every object in a bucket that overlaps the area to the query results
+static int _vk2dShadowEnvironmentQueryCell(VK2DShadowEnvironment shadowEnvironment, VK2DShadowGridCell *cell, const float *area, int count) {
+    for (int i = 0; i < cell->count; i++) {
+        VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[cell->objects[i]];
+        if (info->queryId == shadowEnvironment->queryId)
+            continue;
+        info->queryId = shadowEnvironment->queryId;
+        if (info->enabled && info->bounds[0] <= area[2] && info->bounds[2] >= area[0] && info->bounds[1] <= area[3] && info->bounds[3] >= area[1])
+            shadowEnvironment->queryResults[count++] = cell->objects[i];
+    }
+    return count;
+}
+
 VK2DShadowEnvironment vk2dShadowEnvironmentCreate() {
     VK2DShadowEnvironment se = malloc(sizeof(struct VK2DShadowEnvironment_t));
+    VK2DShadowGridCell *grid = calloc(VK2D_SHADOW_GRID_BUCKETS, sizeof(VK2DShadowGridCell));
 
-    if (se) {
-        se->vboVertexSize = 0;
+    if (se && grid) {
+        se->flushedEdgeCount = 0;
         se->vbo = NULL;
-        se->vertices = NULL;
-        se->verticesSize = 0;
-        se->verticesCount = 0;
+        se->bakedEdgeCount = 0;
+        se->objectBuffer = NULL;
+        se->lightEdges = NULL;
+        se->lightObjects = NULL;
+        se->lightEdgesSize = 0;
+        se->vboRing = NULL;
+        se->vboRingCount = 0;
+        se->vboCurrent = 0;
+        se->objectRing = NULL;
+        se->objectRingCount = 0;
+        se->objectCurrent = 0;
+        se->flushed = false;
+        se->edgesDirty = true;
+        se->objectsDirty = true;
+        se->flushedEdges = NULL;
+        se->flushedEdgesSize = 0;
+        se->edges = NULL;
+        se->edgesSize = 0;
+        se->edgesCount = 0;
         se->objectCount = 0;
         se->objectInfos = NULL;
+        se->grid = grid;
+        se->gridLarge.objects = NULL;
+        se->gridLarge.count = 0;
+        se->gridLarge.size = 0;
+        se->queryResults = NULL;
+        se->queryResultsSize = 0;
+        se->queryId = 0;
         vk2dShadowEnvironmentAddObject(se);
     } else {
+        free(se);
+        free(grid);
+        se = NULL;
         vk2dLogInfo("Failed to create shadow environment.");
     }
 
@@ -35,9 +159,22 @@ VK2DShadowEnvironment vk2dShadowEnvironmentCreate() {
 
 void vk2dShadowEnvironmentFree(VK2DShadowEnvironment shadowEnvironment) {
     if (shadowEnvironment != NULL) {
-        free(shadowEnvironment->vertices);
-        vk2dBufferFree(shadowEnvironment->vbo);
+        free(shadowEnvironment->edges);
+        free(shadowEnvironment->flushedEdges);
+        free(shadowEnvironment->lightEdges);
+        free(shadowEnvironment->lightObjects);
+        for (int i = 0; i < shadowEnvironment->vboRingCount; i++)
+            vk2dBufferFree(shadowEnvironment->vboRing[i].buffer);
+        free(shadowEnvironment->vboRing);
+        for (int i = 0; i < shadowEnvironment->objectRingCount; i++)
+            vk2dBufferFree(shadowEnvironment->objectRing[i].buffer);
+        free(shadowEnvironment->objectRing);
         free(shadowEnvironment->objectInfos);
+        for (int i = 0; i < VK2D_SHADOW_GRID_BUCKETS; i++)
+            free(shadowEnvironment->grid[i].objects);
+        free(shadowEnvironment->grid);
+        free(shadowEnvironment->gridLarge.objects);
+        free(shadowEnvironment->queryResults);
         free(shadowEnvironment);
     }
 }
@@ -46,7 +183,7 @@ VK2DShadowObject vk2dShadowEnvironmentAddObject(VK2DShadowEnvironment shadowEnvi
     VK2DShadowObject so = VK2D_INVALID_SHADOW_OBJECT;
 
     // In case the user doesn't use the default one
-    if (shadowEnvironment->verticesCount == 0 && shadowEnvironment->objectCount > 0 && shadowEnvironment->objectInfos[0].vertexCount == 0)
+    if (shadowEnvironment->edgesCount == 0 && shadowEnvironment->objectCount > 0 && shadowEnvironment->objectInfos[0].edgeCount == 0)
         return 0;
 
     // Reallocate object array
@@ -57,9 +194,12 @@ VK2DShadowObject vk2dShadowEnvironmentAddObject(VK2DShadowEnvironment shadowEnvi
         shadowEnvironment->objectCount++;
         shadowEnvironment->objectInfos = newMem;
         VK2DShadowObjectInfo *soi = &shadowEnvironment->objectInfos[shadowEnvironment->objectCount - 1];
-        soi->vertexCount = 0;
-        soi->startingVertex = shadowEnvironment->verticesCount;
+        soi->edgeCount = 0;
+        soi->startingEdge = shadowEnvironment->edgesCount;
         soi->enabled = true;
+        soi->inGrid = false;
+        soi->large = false;
+        soi->queryId = 0;
         memset(soi->model, 0, sizeof(mat4));
         identityMatrix(soi->model);
     } else {
@@ -74,6 +214,8 @@ void vk2dShadowEnvironmentObjectSetPos(VK2DShadowEnvironment shadowEnvironment,
     memset(shadowEnvironment->objectInfos[object].model, 0, sizeof(mat4));
     identityMatrix(shadowEnvironment->objectInfos[object].model);
     translateMatrix(shadowEnvironment->objectInfos[object].model, origin);
+    _vk2dShadowEnvironmentGridUpdate(shadowEnvironment, object);
+    shadowEnvironment->objectsDirty = true;
 }
 
 void vk2dShadowEnvironmentObjectUpdate(VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object, float x, float y, float scaleX, float scaleY, float rotation, float originX, float originY) {
@@ -96,9 +238,13 @@ void vk2dShadowEnvironmentObjectUpdate(VK2DShadowEnvironment shadowEnvironment,
         vec3 scale = {scaleX, scaleY, 1};
         scaleMatrix(shadowEnvironment->objectInfos[object].model, scale);
     }
+    _vk2dShadowEnvironmentGridUpdate(shadowEnvironment, object);
+    shadowEnvironment->objectsDirty = true;
 }
 
 void vk2dShadowEnvironmentObjectSetStatus(VK2DShadowEnvironment shadowEnvironment, VK2DShadowObject object, bool enabled) {
+    if (shadowEnvironment->objectInfos[object].enabled != enabled)
+        shadowEnvironment->objectsDirty = true;
     shadowEnvironment->objectInfos[object].enabled = enabled;
 }
 
@@ -110,51 +256,256 @@ void vk2dShadowEnvironmentAddEdge(VK2DShadowEnvironment shadowEnvironment, float
     bool failedToExtendList = false;
 
     // Extend list
-    if (shadowEnvironment->verticesCount == shadowEnvironment->verticesSize) {
-        vec3* newList = realloc(shadowEnvironment->vertices, (shadowEnvironment->verticesSize + (VK2D_DEFAULT_ARRAY_EXTENSION * 6)) * sizeof(vec3));
+    if (shadowEnvironment->edgesCount == shadowEnvironment->edgesSize) {
+        vec4* newList = realloc(shadowEnvironment->edges, (shadowEnvironment->edgesSize + VK2D_DEFAULT_ARRAY_EXTENSION) * sizeof(vec4));
 
         if (newList) {
-            shadowEnvironment->vertices = newList;
-            shadowEnvironment->verticesSize += VK2D_DEFAULT_ARRAY_EXTENSION * 6;
+            shadowEnvironment->edges = newList;
+            shadowEnvironment->edgesSize += VK2D_DEFAULT_ARRAY_EXTENSION;
         } else {
             failedToExtendList = true;
             vk2dLogInfo("Failed to extend shadow list");
         }
     }
 
-    // Add the new 6 vertices for this edge
+    // Edges stay as their two end points, shadows.vert builds the quad for each one
     if (!failedToExtendList) {
-        vec3 vert[6] = {
-                {x2, y2, 0},
-                {x2, y2, 0}, // Projected - 1
-                {x1, y1, 0},
-                {x1, y1, 0}, // Projected - 3
-                {x1, y1, 0}, // Projected - 4
-                {x2, y2, 0},
-        };
+        vec4 *edge = &shadowEnvironment->edges[shadowEnvironment->edgesCount];
+        (*edge)[0] = x1;
+        (*edge)[1] = y1;
+        (*edge)[2] = x2;
+        (*edge)[3] = y2;
+        shadowEnvironment->edgesCount++;
 
-        memcpy(&shadowEnvironment->vertices[shadowEnvironment->verticesCount], vert, sizeof(vec3) * 6);
-        shadowEnvironment->verticesCount += 6;
-        shadowEnvironment->objectInfos[shadowEnvironment->objectCount - 1].vertexCount += 6;
+        // Objects only go in the grid once they are flushed or moved, so only the local bounds are kept up to date
+        VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[shadowEnvironment->objectCount - 1];
+        const bool first = info->edgeCount == 0;
+        info->localBounds[0] = first || fminf(x1, x2) < info->localBounds[0] ? fminf(x1, x2) : info->localBounds[0];
+        info->localBounds[1] = first || fminf(y1, y2) < info->localBounds[1] ? fminf(y1, y2) : info->localBounds[1];
+        info->localBounds[2] = first || fmaxf(x1, x2) > info->localBounds[2] ? fmaxf(x1, x2) : info->localBounds[2];
+        info->localBounds[3] = first || fmaxf(y1, y2) > info->localBounds[3] ? fmaxf(y1, y2) : info->localBounds[3];
+        info->edgeCount++;
     }
 }
 
 void vk2dShadowEnvironmentResetEdges(VK2DShadowEnvironment shadowEnvironment) {
-    shadowEnvironment->verticesCount = 0;
+    shadowEnvironment->edgesCount = 0;
+    for (int i = 0; i < VK2D_SHADOW_GRID_BUCKETS; i++)
+        shadowEnvironment->grid[i].count = 0;
+    shadowEnvironment->gridLarge.count = 0;
     free(shadowEnvironment->objectInfos);
     shadowEnvironment->objectInfos = NULL;
     shadowEnvironment->objectCount = 0;
     vk2dShadowEnvironmentAddObject(shadowEnvironment);
+
+    // The uploaded edges point at objects that no longer exist, so nothing is drawn until the next flush
+    shadowEnvironment->flushedEdgeCount = 0;
+    shadowEnvironment->edgesDirty = true;
+    shadowEnvironment->objectsDirty = true;
+}
+
+// Finds a buffer in a ring the GPU is no longer reading from, adding one if they're all in flight
+static VK2DShadowVBO *_vk2dShadowEnvironmentGetFreeVBO(VK2DShadowVBO **ring, int *ringCount, int *current) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    for (int i = 1; i <= *ringCount; i++) {
+        const int index = (*current + i) % *ringCount;
+        VK2DShadowVBO *slot = &(*ring)[index];
+        if (slot->lastUsedFrame == 0 || slot->lastUsedFrame + gRenderer->options.framesInFlight < gRenderer->frameCount) {
+            *current = index;
+            return slot;
+        }
+    }
+
+    VK2DShadowVBO *newRing = realloc(*ring, sizeof(VK2DShadowVBO) * (*ringCount + 1));
+    if (newRing == NULL) {
+        vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to extend shadow VBO ring.");
+        return NULL;
+    }
+    *ring = newRing;
+    *current = (*ringCount)++;
+    VK2DShadowVBO *slot = &(*ring)[*current];
+    slot->buffer = NULL;
+    slot->lastUsedFrame = 0;
+    return slot;
+}
+
+// Maps a free buffer from a ring with room for at least size bytes, returns NULL if it couldn't
+static VK2DShadowVBO *_vk2dShadowEnvironmentMapFreeVBO(VK2DShadowVBO **ring, int *ringCount, int *current, VkDeviceSize size, VkBufferUsageFlags usage, void **location) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VK2DShadowVBO *slot = _vk2dShadowEnvironmentGetFreeVBO(ring, ringCount, current);
+    if (slot == NULL)
+        return NULL;
+
+    // Buffers only grow, with some headroom so edges or objects being added over time don't reallocate every upload
+    if (slot->buffer == NULL || slot->buffer->size < size) {
+        vk2dBufferFree(slot->buffer);
+        slot->buffer = vk2dBufferCreate(
+                vk2dRendererGetDevice(),
+                size + (size / 2),
+                usage,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (slot->buffer == NULL)
+            return NULL;
+    }
+
+    VkResult result = vmaMapMemory(gRenderer->vma, slot->buffer->mem, location);
+    if (result != VK_SUCCESS) {
+        vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
+        return NULL;
+    }
+    return slot;
 }
 
 void vk2dShadowEnvironmentFlushVBO(VK2DShadowEnvironment shadowEnvironment) {
-    vk2dRendererWait();
-    vk2dBufferFree(shadowEnvironment->vbo);
-    shadowEnvironment->vboVertexSize = shadowEnvironment->verticesCount;
-    shadowEnvironment->vbo = vk2dBufferLoad(
-            vk2dRendererGetDevice(),
-            sizeof(vec3) * shadowEnvironment->verticesCount,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            shadowEnvironment->vertices, true
-    );
-}
\ No newline at end of file
+    // Only a copy is taken here, the GPU gets the edges the next time the environment is drawn
+    if (shadowEnvironment->edgesCount > shadowEnvironment->flushedEdgesSize) {
+        vec4 *newList = realloc(shadowEnvironment->flushedEdges, shadowEnvironment->edgesCount * sizeof(vec4));
+        if (newList == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to flush %i shadow edges.", shadowEnvironment->edgesCount);
+            return;
+        }
+        shadowEnvironment->flushedEdges = newList;
+        shadowEnvironment->flushedEdgesSize = shadowEnvironment->edgesCount;
+    }
+    if (shadowEnvironment->edgesCount > 0)
+        memcpy(shadowEnvironment->flushedEdges, shadowEnvironment->edges, shadowEnvironment->edgesCount * sizeof(vec4));
+    shadowEnvironment->flushedEdgeCount = shadowEnvironment->edgesCount;
+    for (int i = 0; i < shadowEnvironment->objectCount; i++)
+        _vk2dShadowEnvironmentGridUpdate(shadowEnvironment, i);
+    shadowEnvironment->flushed = true;
+    shadowEnvironment->edgesDirty = true;
+    shadowEnvironment->objectsDirty = true;
+}
+
+void _vk2dShadowEnvironmentBake(VK2DShadowEnvironment shadowEnvironment) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (gRenderer == NULL || vk2dStatusFatal())
+        return;
+
+    // Edges stay in object space so they are only uploaded when they are flushed, each one is followed
+    // by the object it belongs to so shadows.vert can look up that object's model
+    if (shadowEnvironment->edgesDirty) {
+        shadowEnvironment->vbo = NULL;
+        shadowEnvironment->bakedEdgeCount = 0;
+        shadowEnvironment->edgesDirty = false;
+        const int edgeCount = shadowEnvironment->flushedEdgeCount;
+        const VkDeviceSize edgesSize = sizeof(vec4) * edgeCount;
+        void *location;
+        VK2DShadowVBO *slot = NULL;
+        if (edgeCount > 0)
+            slot = _vk2dShadowEnvironmentMapFreeVBO(&shadowEnvironment->vboRing, &shadowEnvironment->vboRingCount, &shadowEnvironment->vboCurrent, edgesSize + (sizeof(uint32_t) * edgeCount), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &location);
+        if (slot != NULL) {
+            memcpy(location, shadowEnvironment->flushedEdges, edgesSize);
+            uint32_t *objects = (void*)((char*)location + edgesSize);
+            for (int i = 0; i < shadowEnvironment->objectCount; i++) {
+                const VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[i];
+                for (int j = info->startingEdge; j < info->startingEdge + info->edgeCount && j < edgeCount; j++)
+                    objects[j] = i;
+            }
+            vmaUnmapMemory(gRenderer->vma, slot->buffer->mem);
+            shadowEnvironment->vbo = slot->buffer;
+            shadowEnvironment->bakedEdgeCount = edgeCount;
+        }
+    }
+
+    // Moving or toggling objects only rewrites their models and enabled flags, the edges are left alone
+    if (shadowEnvironment->objectsDirty) {
+        shadowEnvironment->objectBuffer = NULL;
+        shadowEnvironment->objectsDirty = false;
+        void *location;
+        VK2DShadowVBO *slot = _vk2dShadowEnvironmentMapFreeVBO(&shadowEnvironment->objectRing, &shadowEnvironment->objectRingCount, &shadowEnvironment->objectCurrent, sizeof(VK2DShadowObjectGPU) * shadowEnvironment->objectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &location);
+        if (slot != NULL) {
+            VK2DShadowObjectGPU *objects = location;
+            for (int i = 0; i < shadowEnvironment->objectCount; i++) {
+                const VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[i];
+                memcpy(objects[i].model, info->model, sizeof(mat4));
+
+                // Objects that got more edges after the last flush only have some of them in the VBO
+                objects[i].enabled = info->enabled && info->startingEdge + info->edgeCount <= shadowEnvironment->bakedEdgeCount;
+            }
+            vmaUnmapMemory(gRenderer->vma, slot->buffer->mem);
+            shadowEnvironment->objectBuffer = slot->buffer;
+        }
+    }
+}
+
+int _vk2dShadowEnvironmentCullLight(VK2DShadowEnvironment shadowEnvironment, float x, float y, float radius) {
+    if (shadowEnvironment->bakedEdgeCount > shadowEnvironment->lightEdgesSize) {
+        vec4 *newEdges = realloc(shadowEnvironment->lightEdges, shadowEnvironment->bakedEdgeCount * sizeof(vec4));
+        if (newEdges != NULL)
+            shadowEnvironment->lightEdges = newEdges;
+        uint32_t *newObjects = realloc(shadowEnvironment->lightObjects, shadowEnvironment->bakedEdgeCount * sizeof(uint32_t));
+        if (newObjects != NULL)
+            shadowEnvironment->lightObjects = newObjects;
+        if (newEdges == NULL || newObjects == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to cull %i shadow edges.", shadowEnvironment->bakedEdgeCount);
+            return 0;
+        }
+        shadowEnvironment->lightEdgesSize = shadowEnvironment->bakedEdgeCount;
+    }
+
+    // Only objects the grid puts near the light are checked, then an edge is kept if the closest point on it
+    // to the light is within the radius. Only these edges are moved into world space, and only for this check
+    const int objectCount = _vk2dShadowEnvironmentQuery(shadowEnvironment, x - radius, y - radius, x + radius, y + radius);
+    const float radiusSquared = radius * radius;
+    int count = 0;
+    for (int object = 0; object < objectCount; object++) {
+        const VK2DShadowObject so = shadowEnvironment->queryResults[object];
+        const VK2DShadowObjectInfo *info = &shadowEnvironment->objectInfos[so];
+        if (info->startingEdge + info->edgeCount > shadowEnvironment->bakedEdgeCount)
+            continue;
+        const float *m = info->model;
+        for (int i = info->startingEdge; i < info->startingEdge + info->edgeCount; i++) {
+            const float *edge = shadowEnvironment->flushedEdges[i];
+            const float x1 = (m[0] * edge[0]) + (m[4] * edge[1]) + m[12];
+            const float y1 = (m[1] * edge[0]) + (m[5] * edge[1]) + m[13];
+            const float dx = (m[0] * edge[2]) + (m[4] * edge[3]) + m[12] - x1;
+            const float dy = (m[1] * edge[2]) + (m[5] * edge[3]) + m[13] - y1;
+            const float lengthSquared = (dx * dx) + (dy * dy);
+            float t = lengthSquared > 0 ? (((x - x1) * dx) + ((y - y1) * dy)) / lengthSquared : 0;
+            t = t < 0 ? 0 : (t > 1 ? 1 : t);
+            const float cx = x1 + (t * dx) - x;
+            const float cy = y1 + (t * dy) - y;
+            if ((cx * cx) + (cy * cy) > radiusSquared)
+                continue;
+            memcpy(shadowEnvironment->lightEdges[count], edge, sizeof(vec4));
+            shadowEnvironment->lightObjects[count++] = so;
+        }
+    }
+    return count;
+}
+
+int _vk2dShadowEnvironmentQuery(VK2DShadowEnvironment shadowEnvironment, float left, float top, float right, float bottom) {
+    if (shadowEnvironment->objectCount > shadowEnvironment->queryResultsSize) {
+        VK2DShadowObject *newResults = realloc(shadowEnvironment->queryResults, shadowEnvironment->objectCount * sizeof(VK2DShadowObject));
+        if (newResults == NULL) {
+            vk2dRaise(VK2D_STATUS_OUT_OF_RAM, "Failed to query %i shadow objects.", shadowEnvironment->objectCount);
+            return 0;
+        }
+        shadowEnvironment->queryResults = newResults;
+        shadowEnvironment->queryResultsSize = shadowEnvironment->objectCount;
+    }
+
+    // Query IDs wrapping around would make objects look like they were already found
+    if (++shadowEnvironment->queryId == 0) {
+        for (int i = 0; i < shadowEnvironment->objectCount; i++)
+            shadowEnvironment->objectInfos[i].queryId = 0;
+        shadowEnvironment->queryId = 1;
+    }
+
+    const float area[4] = {left, top, right, bottom};
+    int cells[4];
+    for (int i = 0; i < 4; i++)
+        cells[i] = (int)floorf(area[i] / VK2D_SHADOW_GRID_CELL_SIZE);
+    int count = _vk2dShadowEnvironmentQueryCell(shadowEnvironment, &shadowEnvironment->gridLarge, area, 0);
+    if ((int64_t)(cells[2] - cells[0] + 1) * (cells[3] - cells[1] + 1) > VK2D_SHADOW_GRID_BUCKETS) {
+        // Visiting more cells than there are buckets would only visit the same buckets again
+        for (int i = 0; i < VK2D_SHADOW_GRID_BUCKETS; i++)
+            count = _vk2dShadowEnvironmentQueryCell(shadowEnvironment, &shadowEnvironment->grid[i], area, count);
+    } else {
+        for (int y = cells[1]; y <= cells[3]; y++)
+            for (int x = cells[0]; x <= cells[2]; x++)
+                count = _vk2dShadowEnvironmentQueryCell(shadowEnvironment, _vk2dShadowEnvironmentGetCell(shadowEnvironment, x, y), area, count);
+    }
+    return count;
+}
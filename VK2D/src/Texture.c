@@ -1,11 +1,13 @@
 /// \file Texture.c
 /// \author Paolo Mazzon
 #include <malloc.h>
+#include <string.h>
 #include "VK2D/Texture.h"
 #include "VK2D/Buffer.h"
 #include "VK2D/DescriptorControl.h"
 #include "VK2D/Image.h"
 #include "VK2D/Initializers.h"
+#include "VK2D/LogicalDevice.h"
 #include "VK2D/Opaque.h"
 #include "VK2D/Renderer.h"
 #include "VK2D/Util.h"
@@ -13,6 +15,24 @@
 #include "VK2D/stb_image.h"
 #include "VK2D/Logger.h"
 
+static void _vk2dTextureWriteDescriptor(VkImageView view, int spot) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    VkDescriptorImageInfo imageInfo = {
+            .imageView = view,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .dstArrayElement = spot,
+            .pImageInfo = &imageInfo,
+            .dstBinding = 2,
+            .dstSet = gRenderer->texArrayDescriptorSet,
+            .descriptorCount = 1,
+    };
+    vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+}
+
 static void _vk2dTextureAddToTextureArray(VK2DTexture tex) {
     VK2DRenderer gRenderer = vk2dRendererGetPointer();
     if (tex == NULL || vk2dStatusFatal())
@@ -32,22 +52,14 @@ static void _vk2dTextureAddToTextureArray(VK2DTexture tex) {
     } else {
         SDL_SetAtomicInt(&tex->descriptorIndex, spot);
         gRenderer->textureArray[spot].active = true;
+        gRenderer->textureArray[spot].evicted = false;
+        gRenderer->textureArray[spot].reloadQueued = false;
+        gRenderer->textureArray[spot].reload = NULL;
+        gRenderer->textureArray[spot].tex = tex;
+        gRenderer->textureArray[spot].lastUsedFrame = gRenderer->frameCount;
 
         // Write the descriptor set
-        VkDescriptorImageInfo imageInfo = {
-                .imageView = tex->img->view,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-        };
-        VkWriteDescriptorSet write = {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                .dstArrayElement = spot,
-                .pImageInfo = &imageInfo,
-                .dstBinding = 2,
-                .dstSet = gRenderer->texArrayDescriptorSet,
-                .descriptorCount = 1,
-        };
-        vkUpdateDescriptorSets(gRenderer->ld->dev, 1, &write, 0, VK_NULL_HANDLE);
+        _vk2dTextureWriteDescriptor(tex->img->view, spot);
     }
 }
 
@@ -102,7 +114,7 @@ VK2DTexture vk2dTextureFrom(const void *data, int size) {
 	if (tex == NULL)
         vk2dLogInfo("Failed to load texture from data of size %i.", size);
 	else
-        _vk2dTextureAddToTextureArray(tex);
+        _vk2dTextureKeepSource(tex, NULL, data, size);
 	return tex;
 }
 
@@ -112,10 +124,9 @@ VK2DTexture vk2dTextureLoad(const char *filename) {
     void *data = _vk2dLoadFile(filename, &size);
 	if (data != NULL) {
         tex = _vk2dTextureFromInternal(data, size, true);
-        _vk2dTextureAddToTextureArray(tex);
+        if (tex != NULL)
+            _vk2dTextureKeepSource(tex, filename, NULL, 0);
         free(data);
-    } else {
-
     }
 	return tex;
 }
@@ -125,7 +136,7 @@ void _vk2dImageTransitionImageLayout(VK2DLogicalDevice dev, VkImage image, VkIma
 void _vk2dRendererAddTarget(VK2DTexture tex);
 void _vk2dRendererRemoveTarget(VK2DTexture tex);
 VK2DTexture vk2dTextureCreate(float w, float h) {
-	VK2DTexture out = malloc(sizeof(struct VK2DTexture_t));
+	VK2DTexture out = calloc(1, sizeof(struct VK2DTexture_t));
 	VK2DRenderer renderer = vk2dRendererGetPointer();
 	VK2DLogicalDevice dev = vk2dRendererGetDevice();
 
@@ -151,14 +162,16 @@ VK2DTexture vk2dTextureCreate(float w, float h) {
 	_vk2dCameraUpdateUBO(&ubo, &cam, 0);
 
 	if (out != NULL) {
-		out->img = vk2dImageCreate(dev, w, h, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
+		out->img = vk2dImageCreate(dev, w, h, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 1);
 		out->sampledImg = vk2dImageCreate(dev, w, h, VK_FORMAT_B8G8R8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, (VkSampleCountFlagBits)renderer->config.msaa);
 		out->depthBuffer = vk2dImageCreate(dev, w, h, renderer->depthBufferFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, (VkSampleCountFlagBits)renderer->config.msaa);
 		_vk2dImageTransitionImageLayout(dev, out->img->img, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true);
 		_vk2dImageTransitionImageLayout(dev, out->sampledImg->img, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true);
 		//_vk2dImageTransitionImageLayout(dev, out->depthBuffer->img, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
-		// Set up FBO
+		// Set up FBO, dynamic rendering doesn't use one
+		out->isTarget = true;
+		out->fbo = VK_NULL_HANDLE;
 		const int attachCount = renderer->config.msaa > 1 ? 3 : 2;
 		VkImageView attachments[3];
 		if (renderer->config.msaa > 1) {
@@ -171,7 +184,7 @@ VK2DTexture vk2dTextureCreate(float w, float h) {
 		}
 
 		VkFramebufferCreateInfo framebufferCreateInfo = vk2dInitFramebufferCreateInfo(renderer->externalTargetRenderPass, w, h, attachments, attachCount);
-		VkResult result = vkCreateFramebuffer(dev->dev, &framebufferCreateInfo, VK_NULL_HANDLE, &out->fbo);
+		VkResult result = renderer->dynamicRendering ? VK_SUCCESS : vkCreateFramebuffer(dev->dev, &framebufferCreateInfo, VK_NULL_HANDLE, &out->fbo);
 		if (result != VK_SUCCESS) {
 		    vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to create framebuffer for texture of size %.2fx%.2f, Vulkan error %i", w, h, result);
 		}
@@ -198,17 +211,94 @@ float vk2dTextureHeight(VK2DTexture tex) {
 }
 
 bool vk2dTextureIsTarget(VK2DTexture tex) {
-	return tex->fbo != VK_NULL_HANDLE;
+	return tex->isTarget;
 }
 
 VK2DImage vk2dTextureGetImage(VK2DTexture tex) {
 	return tex->img;
 }
 
+// Moves a texture's image between shader read and transfer source for readback
+static void _vk2dTextureReadBarrier(VkCommandBuffer buf, VkImage image, bool toTransfer) {
+	VkImageMemoryBarrier barrier = {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = toTransfer ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT,
+			.dstAccessMask = toTransfer ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_SHADER_READ_BIT,
+			.oldLayout = toTransfer ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			.newLayout = toTransfer ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = image,
+			.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+	};
+	vkCmdPipelineBarrier(
+			buf,
+			toTransfer ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT,
+			toTransfer ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, 1, &barrier);
+}
+
+bool vk2dTextureRead(VK2DTexture tex, void *pixels) {
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	if (gRenderer == NULL || vk2dStatusFatal() || tex == NULL)
+		return false;
+	if (gRenderer->procedStartFrame) {
+		vk2dLogWarn("vk2dTextureRead cannot be called between vk2dRendererStartFrame and vk2dRendererEndFrame.");
+		return false;
+	}
+	if (tex->img->img == VK_NULL_HANDLE || (tex->img->usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0) {
+		vk2dLogWarn("Texture %i cannot be read back.", vk2dTextureGetID(tex));
+		return false;
+	}
+
+	// Copy the image into a host-visible buffer
+	const uint32_t w = tex->img->width;
+	const uint32_t h = tex->img->height;
+	VK2DBuffer stage = vk2dBufferCreate(gRenderer->ld, (VkDeviceSize)w * h * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+										VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	if (stage == NULL)
+		return false;
+	VkCommandBuffer buf = vk2dLogicalDeviceGetSingleUseBuffer(gRenderer->ld, true);
+	if (buf == VK_NULL_HANDLE) {
+		vk2dBufferFree(stage);
+		return false;
+	}
+	VkBufferImageCopy region = {
+			.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+			.imageExtent = {w, h, 1}
+	};
+	_vk2dTextureReadBarrier(buf, tex->img->img, true);
+	vkCmdCopyImageToBuffer(buf, tex->img->img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stage->buf, 1, &region);
+	_vk2dTextureReadBarrier(buf, tex->img->img, false);
+	vk2dLogicalDeviceSubmitSingleBuffer(gRenderer->ld, buf, true);
+
+	// Copy it out to the user, swizzling targets from BGRA to RGBA
+	void *data;
+	VkResult result = vmaMapMemory(gRenderer->vma, stage->mem, &data);
+	if (result != VK_SUCCESS) {
+		vk2dRaise(VK2D_STATUS_VULKAN_ERROR, "Failed to map memory, VMA error %i.", result);
+		vk2dBufferFree(stage);
+		return false;
+	}
+	memcpy(pixels, data, (size_t)w * h * 4);
+	vmaUnmapMemory(gRenderer->vma, stage->mem);
+	vk2dBufferFree(stage);
+	if (tex->img->format == VK_FORMAT_B8G8R8A8_SRGB) {
+		uint8_t *bytes = pixels;
+		for (size_t i = 0; i < (size_t)w * h * 4; i += 4) {
+			const uint8_t b = bytes[i];
+			bytes[i] = bytes[i + 2];
+			bytes[i + 2] = b;
+		}
+	}
+	return !vk2dStatusFatal();
+}
+
 void vk2dTextureFree(VK2DTexture tex) {
 	if (tex != NULL) {
-		if (tex->fbo != VK_NULL_HANDLE) {
-			vkDestroyFramebuffer(tex->img->dev->dev, tex->fbo, VK_NULL_HANDLE);
+		if (tex->isTarget) {
+			if (tex->fbo != VK_NULL_HANDLE)
+				vkDestroyFramebuffer(tex->img->dev->dev, tex->fbo, VK_NULL_HANDLE);
 			vk2dImageFree(tex->img);
 			vk2dBufferFree(tex->ubo);
 			vk2dImageFree(tex->sampledImg);
@@ -220,6 +310,16 @@ void vk2dTextureFree(VK2DTexture tex) {
         VK2DRenderer renderer = vk2dRendererGetPointer();
 		int val = SDL_GetAtomicInt(&tex->descriptorIndex);
 		renderer->textureArray[val].active = false;
+		if (renderer->textureArray[val].reloadQueued)
+			renderer->texturesPendingReload--;
+		if (renderer->textureArray[val].reload != NULL)
+			renderer->textureArray[val].reload->tex = NULL;
+		renderer->textureArray[val].evicted = false;
+		renderer->textureArray[val].reloadQueued = false;
+		renderer->textureArray[val].reload = NULL;
+		renderer->textureArray[val].tex = NULL;
+		free(tex->sourceFile);
+		free(tex->sourceData);
 		free(tex);
 	}
 }
@@ -228,3 +328,79 @@ uint32_t vk2dTextureGetID(VK2DTexture tex) {
     uint32_t val = SDL_GetAtomicInt(&tex->descriptorIndex);
     return val;
 }
+
+void _vk2dTextureKeepSource(VK2DTexture tex, const char *filename, const void *data, int size) {
+    if (tex == NULL || vk2dRendererGetPointer()->options.vramEvictionThreshold <= 0)
+        return;
+
+    // The user's buffer may not outlive the texture so keep our own copy in case it gets evicted
+    if (filename != NULL) {
+        tex->sourceFile = (char*)_vk2dCopyBuffer(filename, strlen(filename) + 1);
+    } else if (data != NULL) {
+        tex->sourceData = _vk2dCopyBuffer(data, size);
+        tex->sourceSize = tex->sourceData != NULL ? size : 0;
+    }
+}
+
+bool _vk2dTextureIsReloadable(VK2DTexture tex) {
+    return tex->imgHandled && (tex->sourceFile != NULL || tex->sourceData != NULL);
+}
+
+VkDeviceSize _vk2dTextureEvict(VK2DTexture tex) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (tex == NULL || vk2dStatusFatal() || !_vk2dTextureIsReloadable(tex) || gRenderer->evictedImage == NULL)
+        return 0;
+
+    // Draws sample a transparent image until the texture is reloaded, the slot isn't in use by any
+    // frame in flight so it can be rewritten before the image goes away. The image struct itself is
+    // kept around so the texture's dimensions are still available.
+    const int index = SDL_GetAtomicInt(&tex->descriptorIndex);
+    _vk2dTextureWriteDescriptor(gRenderer->evictedImage->view, index);
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(gRenderer->vma, tex->img->mem, &allocationInfo);
+    vkDestroyImageView(gRenderer->ld->dev, tex->img->view, VK_NULL_HANDLE);
+    vmaDestroyImage(gRenderer->vma, tex->img->img, tex->img->mem);
+    tex->img->view = VK_NULL_HANDLE;
+    tex->img->img = VK_NULL_HANDLE;
+    tex->img->mem = VK_NULL_HANDLE;
+    gRenderer->textureArray[index].evicted = true;
+    vk2dLogDebug("Evicted texture %i (%0.2fkb) from VRAM.", index, (float)allocationInfo.size / 1024.0f);
+
+    return allocationInfo.size;
+}
+
+VK2DImage _vk2dTextureReloadImage(const char *sourceFile, const void *sourceData, int sourceSize, bool mainThread) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    uint32_t size = sourceSize;
+    void *data = (void*)sourceData;
+    if (sourceFile != NULL)
+        data = _vk2dLoadFile(sourceFile, &size);
+
+    int x, y, channels;
+    VK2DImage image = NULL;
+    void *pixels = data != NULL ? stbi_load_from_memory(data, size, &x, &y, &channels, 4) : NULL;
+    if (pixels != NULL) {
+        image = vk2dImageFromPixels(gRenderer->ld, pixels, x, y, mainThread);
+        stbi_image_free(pixels);
+    }
+
+    if (sourceFile != NULL)
+        free(data);
+    return image;
+}
+
+void _vk2dTextureRestore(VK2DTexture tex, VK2DImage image) {
+    VK2DRenderer gRenderer = vk2dRendererGetPointer();
+    if (tex == NULL || image == NULL)
+        return;
+
+    // Move the new Vulkan handles into the texture's existing image
+    tex->img->img = image->img;
+    tex->img->view = image->view;
+    tex->img->mem = image->mem;
+    free(image);
+
+    const int index = SDL_GetAtomicInt(&tex->descriptorIndex);
+    _vk2dTextureWriteDescriptor(tex->img->view, index);
+    gRenderer->textureArray[index].evicted = false;
+}
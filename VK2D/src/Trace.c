@@ -0,0 +1,136 @@
+/// \file Trace.c
+/// \author Paolo Mazzon
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL3/SDL.h>
+
+#include "VK2D/Trace.h"
+#include "VK2D/Renderer.h"
+#include "VK2D/Validation.h"
+#include "VK2D/Logger.h"
+#include "VK2D/Constants.h"
+
+#if defined(VK2D_ENABLE_TRACING) && !defined(VK2D_TRACY)
+
+// A finished zone as it will appear in the trace file
+typedef struct VK2DTraceEvent {
+    const char *name;
+    SDL_ThreadID thread;
+    uint64_t start;
+    uint64_t end;
+} VK2DTraceEvent;
+
+static SDL_Mutex *gTraceMutex;
+static VK2DTraceEvent *gTraceEvents;
+static uint32_t gTraceEventCount;
+static uint32_t gTraceEventCapacity;
+static uint64_t gTraceStart;
+static bool gTraceFullWarned;
+
+void _vk2dTraceInit() {
+    gTraceMutex = SDL_CreateMutex();
+    gTraceEvents = NULL;
+    gTraceEventCount = 0;
+    gTraceEventCapacity = 0;
+    gTraceStart = SDL_GetPerformanceCounter();
+    gTraceFullWarned = false;
+}
+
+void _vk2dTraceQuit() {
+    SDL_DestroyMutex(gTraceMutex);
+    free(gTraceEvents);
+    gTraceMutex = NULL;
+    gTraceEvents = NULL;
+    gTraceEventCount = 0;
+    gTraceEventCapacity = 0;
+}
+
+VK2DTraceZone _vk2dTraceBegin(const char *name) {
+    VK2DTraceZone zone = {name, SDL_GetPerformanceCounter()};
+    return zone;
+}
+
+void _vk2dTraceEnd(VK2DTraceZone zone) {
+    const uint64_t end = SDL_GetPerformanceCounter();
+    if (gTraceMutex == NULL)
+        return;
+    SDL_LockMutex(gTraceMutex);
+
+    // Grow the event list, once we hit the cap further zones are dropped
+    if (gTraceEventCount == gTraceEventCapacity && gTraceEventCapacity < VK2D_MAX_TRACE_EVENTS) {
+        uint32_t newCapacity = gTraceEventCapacity == 0 ? 1024 : gTraceEventCapacity * 2;
+        newCapacity = newCapacity > VK2D_MAX_TRACE_EVENTS ? VK2D_MAX_TRACE_EVENTS : newCapacity;
+        VK2DTraceEvent *newEvents = realloc(gTraceEvents, sizeof(VK2DTraceEvent) * newCapacity);
+        if (newEvents != NULL) {
+            gTraceEvents = newEvents;
+            gTraceEventCapacity = newCapacity;
+        }
+    }
+
+    if (gTraceEventCount < gTraceEventCapacity) {
+        VK2DTraceEvent *event = &gTraceEvents[gTraceEventCount++];
+        event->name = zone.name;
+        event->thread = SDL_GetCurrentThreadID();
+        event->start = zone.start;
+        event->end = end;
+    } else if (!gTraceFullWarned) {
+        gTraceFullWarned = true;
+        vk2dLogWarn("Trace event buffer is full, further zones will not be recorded.");
+    }
+
+    SDL_UnlockMutex(gTraceMutex);
+}
+
+bool vk2dRendererWriteTrace(const char *filename) {
+    if (gTraceMutex == NULL)
+        return false;
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        vk2dRaise(VK2D_STATUS_FILE_NOT_FOUND, "Failed to open \"%s\" to write trace.", filename);
+        return false;
+    }
+
+    // Chrome wants timestamps in microseconds
+    const double toMicroseconds = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+    SDL_LockMutex(gTraceMutex);
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (uint32_t i = 0; i < gTraceEventCount; i++) {
+        const VK2DTraceEvent *event = &gTraceEvents[i];
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"vk2d\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                event->name,
+                (unsigned long long)event->thread,
+                (double)(event->start - gTraceStart) * toMicroseconds,
+                (double)(event->end - event->start) * toMicroseconds,
+                i + 1 < gTraceEventCount ? "," : "");
+    }
+    fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+    SDL_UnlockMutex(gTraceMutex);
+    fclose(file);
+    return true;
+}
+
+#else
+
+void _vk2dTraceInit() {
+    // Nothing to set up without the built-in tracer
+}
+
+void _vk2dTraceQuit() {
+    // Nothing to clean up without the built-in tracer
+}
+
+VK2DTraceZone _vk2dTraceBegin(const char *name) {
+    VK2DTraceZone zone = {name, 0};
+    return zone;
+}
+
+void _vk2dTraceEnd(VK2DTraceZone zone) {
+    // Zones are not recorded without the built-in tracer
+}
+
+bool vk2dRendererWriteTrace(const char *filename) {
+    vk2dLogWarn("vk2dRendererWriteTrace requires Vulkan2D to be built with VK2D_ENABLE_TRACING and without VK2D_TRACY.");
+    return false;
+}
+
+#endif
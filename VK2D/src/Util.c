@@ -14,6 +14,8 @@
 #include "VK2D/Shader.h"
 #include "VK2D/Model.h"
 #include "VK2D/Logger.h"
+#include "VK2D/Trace.h"
+#include "VK2D/RendererMeta.h"
 
 static float gLoadStatus = 0;
 
@@ -64,15 +66,18 @@ VkPipelineVertexInputStateCreateInfo _vk2dGetInstanceVertexInputState() {
 }
 
 VkPipelineVertexInputStateCreateInfo _vk2dGetShadowsVertexInputState() {
-	static VkVertexInputBindingDescription vertexInputBindingDescription;
-	static VkVertexInputAttributeDescription vertexInputAttributeDescription[1];
+	static VkVertexInputBindingDescription vertexInputBindingDescription[2];
+	static VkVertexInputAttributeDescription vertexInputAttributeDescription[2];
 	static VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo;
 	static bool init = false;
 
 	if (!init) {
-		vertexInputBindingDescription = vk2dInitVertexInputBindingDescription(VK_VERTEX_INPUT_RATE_VERTEX, sizeof(vec3), 0);
-		vertexInputAttributeDescription[0] = vk2dInitVertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0);
-		pipelineVertexInputStateCreateInfo = vk2dInitPipelineVertexInputStateCreateInfo(&vertexInputBindingDescription, 1, vertexInputAttributeDescription, 1);
+		// One x1, y1, x2, y2 record per edge and the object it belongs to, shadows.vert expands each instance into a quad
+		vertexInputBindingDescription[0] = vk2dInitVertexInputBindingDescription(VK_VERTEX_INPUT_RATE_INSTANCE, sizeof(vec4), 0);
+		vertexInputBindingDescription[1] = vk2dInitVertexInputBindingDescription(VK_VERTEX_INPUT_RATE_INSTANCE, sizeof(uint32_t), 1);
+		vertexInputAttributeDescription[0] = vk2dInitVertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 0);
+		vertexInputAttributeDescription[1] = vk2dInitVertexInputAttributeDescription(1, 1, VK_FORMAT_R32_UINT, 0);
+		pipelineVertexInputStateCreateInfo = vk2dInitPipelineVertexInputStateCreateInfo(vertexInputBindingDescription, 2, vertexInputAttributeDescription, 2);
 		init = true;
 	}
 
@@ -176,6 +181,8 @@ int _vk2dWorkerThread(void *data) {
     }
 	while (SDL_GetAtomicInt(&dev->quitThread) == 0) {
 		if (SDL_GetAtomicInt(&dev->loads) > 0) {
+			VK2D_TRACE_BEGIN(zone, "Worker thread asset load");
+
 			// Find an asset to load
 			VK2DAssetLoad asset = {0};
 			int spot = -1;
@@ -204,11 +211,15 @@ int _vk2dWorkerThread(void *data) {
 				*asset.Output.texture = _vk2dTextureFromInternal(fileData, size, false);
 				if (*asset.Output.texture == NULL)
                     vk2dLogInfo("Failed to load texture \"%s\".", asset.Load.filename);
+				else
+					_vk2dTextureKeepSource(*asset.Output.texture, asset.Load.filename, NULL, 0);
 				free(fileData);
 			} else if (asset.type == VK2D_ASSET_TYPE_TEXTURE_MEMORY) {
 				*asset.Output.texture = _vk2dTextureFromInternal(asset.Load.data, asset.Load.size, false);
 				if (*asset.Output.texture == NULL)
                     vk2dLogInfo("Failed to load texture from buffer.");
+				else
+					_vk2dTextureKeepSource(*asset.Output.texture, NULL, asset.Load.data, asset.Load.size);
 			} else if (asset.type == VK2D_ASSET_TYPE_MODEL_FILE) {
 				uint32_t size;
 				uint8_t *fileData = _vk2dLoadFile(asset.Load.filename, &size);
@@ -230,8 +241,12 @@ int _vk2dWorkerThread(void *data) {
 
 			loaded++;
 			gLoadStatus = (float)loaded / (float)SDL_GetAtomicInt(&dev->loadListSize);
+			VK2D_TRACE_END(zone);
 		}
 
+		// Evicted textures that are drawn again are decoded here so the frame doesn't have to
+		_vk2dRendererRunTextureReload();
+
 		// Signify the end of loading
 		if (SDL_GetAtomicInt(&dev->loads) == 0 && loaded > 0) {
 			SDL_LockMutex(dev->loadListMutex);
@@ -279,11 +294,15 @@ void vk2dAssetsLoad(VK2DAssetLoad *assets, uint32_t count) {
 				*asset.Output.texture = _vk2dTextureFromInternal(fileData, size, true);
 				if (*asset.Output.texture == NULL)
                     vk2dLogInfo("Failed to load texture \"%s\".", asset.Load.filename);
+				else
+					_vk2dTextureKeepSource(*asset.Output.texture, asset.Load.filename, NULL, 0);
 				free(fileData);
 			} else if (asset.type == VK2D_ASSET_TYPE_TEXTURE_MEMORY) {
 				*asset.Output.texture = _vk2dTextureFromInternal(asset.Load.data, asset.Load.size, true);
 				if (*asset.Output.texture == NULL)
                     vk2dLogInfo("Failed to load texture from buffer.");
+				else
+					_vk2dTextureKeepSource(*asset.Output.texture, NULL, asset.Load.data, asset.Load.size);
 			} else if (asset.type == VK2D_ASSET_TYPE_MODEL_FILE) {
 				uint32_t size;
 				uint8_t *fileData = _vk2dLoadFile(asset.Load.filename, &size);
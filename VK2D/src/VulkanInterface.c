@@ -20,24 +20,24 @@ void vk2dVulkanSubmitSingleUseBuffer(VkCommandBuffer buffer) {
 VkCommandBuffer vk2dVulkanGetDrawBuffer() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	_vk2dRendererResetBoundPointers();
-	return gRenderer->commandBuffer[gRenderer->scImageIndex];
+	return gRenderer->drawBuffer;
 }
 
 VkCommandBuffer vk2dVulkanGetComputeBuffer() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	_vk2dRendererResetBoundPointers();
-	return gRenderer->computeCommandBuffer[gRenderer->scImageIndex];
+	return gRenderer->frames[gRenderer->currentFrame].computeCommandBuffer;
 }
 
 VkCommandBuffer vk2dVulkanGetCopyBuffer() {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
 	_vk2dRendererResetBoundPointers();
-	return gRenderer->dbCommandBuffer[gRenderer->scImageIndex];
+	return gRenderer->frames[gRenderer->currentFrame].dbCommandBuffer;
 }
 
 void vk2dVulkanCopyDataIntoBuffer(void *data, VkDeviceSize size, VkBuffer *outBuffer, VkDeviceSize *bufferOffset) {
 	VK2DRenderer gRenderer = vk2dRendererGetPointer();
-	vk2dDescriptorBufferCopyData(gRenderer->descriptorBuffers[gRenderer->currentFrame], data, size, outBuffer, bufferOffset);
+	vk2dDescriptorBufferCopyData(gRenderer->frames[gRenderer->currentFrame].descriptorBuffer, data, size, outBuffer, bufferOffset);
 }
 
 int vk2dVulkanGetFrame() {
@@ -76,7 +76,8 @@ uint32_t vk2dVulkanGetSwapchainImageCount() {
 }
 
 uint32_t vk2dVulkanGetMaxFramesInFlight() {
-	return VK2D_MAX_FRAMES_IN_FLIGHT;
+	VK2DRenderer gRenderer = vk2dRendererGetPointer();
+	return gRenderer->options.framesInFlight;
 }
 
 VmaAllocator vk2dVulkanGetVMA() {
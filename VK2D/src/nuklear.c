@@ -11,9 +11,6 @@
 #ifndef NK_SDL_TEXT_MAX
 #define NK_SDL_TEXT_MAX 256
 #endif
-#ifndef NK_SDL_MAX_TEXTURES
-#define NK_SDL_MAX_TEXTURES 256
-#endif
 #ifndef NK_SDL_MAX_KEYS
 #define NK_SDL_MAX_KEYS 32
 #endif
@@ -28,50 +25,24 @@ struct nk_sdl_vertex {
     nk_byte col[4];
 };
 
-struct nk_vulkan_texture_descriptor_set {
-    VkImageView image_view;
-    VkDescriptorSet descriptor_set;
-};
-
 struct nk_sdl_device {
     struct nk_buffer cmds;
+    struct nk_buffer vertices; // host side, copied into the renderer's descriptor buffer each frame
+    struct nk_buffer elements;
     struct nk_draw_null_texture tex_null;
-    int max_vertex_buffer;
-    int max_element_buffer;
     VkDevice logical_device;
-    VkPhysicalDevice physical_device;
-    VkImageView *image_views;
-    uint32_t image_views_len;
+    VkRenderPass render_pass; // owned by the renderer, VK_NULL_HANDLE with dynamic rendering
+    VkSampleCountFlagBits samples;
     VkFormat color_format;
-    VkFramebuffer *framebuffers;
-    uint32_t framebuffers_len;
-    VkCommandBuffer *command_buffers;
-    uint32_t command_buffers_len;
-    VkFence *frameStartFences; // one per sc image
-    VkSampler sampler;
-    VkCommandPool command_pool;
-    VkSemaphore *render_completed_semaphores;
-    VkBuffer *vertex_buffers; // TODO: Change these to 1 per swapchain image as these are causing sync issues
-    VkDeviceMemory *vertex_memorys;
-    void **mapped_vertexs;
-    VkBuffer *index_buffers;
-    VkDeviceMemory *index_memorys;
-    void **mapped_indexs;
-    VkBuffer *uniform_buffers;
-    VkDeviceMemory *uniform_memorys;
-    void **mapped_uniforms;
-    VkRenderPass render_pass;
+    VkFormat depth_format;
+    uint32_t frames_len;
     VkDescriptorPool descriptor_pool;
     VkDescriptorSetLayout uniform_descriptor_set_layout;
-    VkDescriptorSet *uniform_descriptor_sets;
-    VkDescriptorSetLayout texture_descriptor_set_layout;
-    struct nk_vulkan_texture_descriptor_set *texture_descriptor_sets;
-    uint32_t texture_descriptor_sets_len;
+    VkDescriptorSet *uniform_descriptor_sets; // one per frame in flight
+    VkDescriptorSetLayout sampler_descriptor_set_layout; // owned by the renderer
+    VkDescriptorSetLayout texture_descriptor_set_layout; // owned by the renderer, the bindless texture array
     VkPipelineLayout pipeline_layout;
     VkPipeline pipeline;
-    VkImage font_image;
-    VkImageView font_image_view;
-    VkDeviceMemory font_memory;
 };
 
 static struct nk_sdl {
@@ -249,328 +220,117 @@ unsigned char nuklearshaders_nuklear_vert_spv[] = { 0x03, 0x02, 0x23, 0x07,
                                                     0x38, 0x00, 0x01, 0x00 };
 unsigned int nuklearshaders_nuklear_vert_spv_len = 1856;
 unsigned char nuklearshaders_nuklear_frag_spv[] = { 0x03, 0x02, 0x23, 0x07,
-                                                    0x00, 0x00, 0x01, 0x00, 0x0b, 0x00, 0x0d, 0x00, 0x1b, 0x00, 0x00, 0x00,
+                                                    0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00,
                                                     0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x00,
-                                                    0x0b, 0x00, 0x06, 0x00, 0x01, 0x00, 0x00, 0x00, 0x47, 0x4c, 0x53, 0x4c,
-                                                    0x2e, 0x73, 0x74, 0x64, 0x2e, 0x34, 0x35, 0x30, 0x00, 0x00, 0x00, 0x00,
-                                                    0x0e, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-                                                    0x0f, 0x00, 0x08, 0x00, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
-                                                    0x6d, 0x61, 0x69, 0x6e, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00,
-                                                    0x15, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x10, 0x00, 0x03, 0x00,
-                                                    0x04, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00,
-                                                    0x02, 0x00, 0x00, 0x00, 0xc2, 0x01, 0x00, 0x00, 0x04, 0x00, 0x09, 0x00,
-                                                    0x47, 0x4c, 0x5f, 0x41, 0x52, 0x42, 0x5f, 0x73, 0x65, 0x70, 0x61, 0x72,
-                                                    0x61, 0x74, 0x65, 0x5f, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x5f, 0x6f,
-                                                    0x62, 0x6a, 0x65, 0x63, 0x74, 0x73, 0x00, 0x00, 0x04, 0x00, 0x0a, 0x00,
-                                                    0x47, 0x4c, 0x5f, 0x47, 0x4f, 0x4f, 0x47, 0x4c, 0x45, 0x5f, 0x63, 0x70,
-                                                    0x70, 0x5f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x5f, 0x6c, 0x69, 0x6e, 0x65,
-                                                    0x5f, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x76, 0x65, 0x00, 0x00,
-                                                    0x04, 0x00, 0x08, 0x00, 0x47, 0x4c, 0x5f, 0x47, 0x4f, 0x4f, 0x47, 0x4c,
-                                                    0x45, 0x5f, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x5f, 0x64, 0x69,
-                                                    0x72, 0x65, 0x63, 0x74, 0x69, 0x76, 0x65, 0x00, 0x05, 0x00, 0x04, 0x00,
-                                                    0x04, 0x00, 0x00, 0x00, 0x6d, 0x61, 0x69, 0x6e, 0x00, 0x00, 0x00, 0x00,
-                                                    0x05, 0x00, 0x05, 0x00, 0x09, 0x00, 0x00, 0x00, 0x74, 0x65, 0x78, 0x43,
-                                                    0x6f, 0x6c, 0x6f, 0x72, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x06, 0x00,
-                                                    0x0d, 0x00, 0x00, 0x00, 0x63, 0x75, 0x72, 0x72, 0x65, 0x6e, 0x74, 0x54,
-                                                    0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x00, 0x00, 0x05, 0x00, 0x04, 0x00,
-                                                    0x11, 0x00, 0x00, 0x00, 0x66, 0x72, 0x61, 0x67, 0x55, 0x76, 0x00, 0x00,
-                                                    0x05, 0x00, 0x05, 0x00, 0x15, 0x00, 0x00, 0x00, 0x6f, 0x75, 0x74, 0x43,
-                                                    0x6f, 0x6c, 0x6f, 0x72, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x05, 0x00,
-                                                    0x17, 0x00, 0x00, 0x00, 0x66, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f,
-                                                    0x72, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x0d, 0x00, 0x00, 0x00,
-                                                    0x22, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
-                                                    0x0d, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                                    0x47, 0x00, 0x04, 0x00, 0x11, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00,
-                                                    0x01, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x15, 0x00, 0x00, 0x00,
+                                                    0x11, 0x00, 0x02, 0x00, 0xb6, 0x14, 0x00, 0x00, 0x0a, 0x00, 0x08, 0x00,
+                                                    0x53, 0x50, 0x56, 0x5f, 0x45, 0x58, 0x54, 0x5f, 0x64, 0x65, 0x73, 0x63,
+                                                    0x72, 0x69, 0x70, 0x74, 0x6f, 0x72, 0x5f, 0x69, 0x6e, 0x64, 0x65, 0x78,
+                                                    0x69, 0x6e, 0x67, 0x00, 0x0e, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                    0x01, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x08, 0x00, 0x04, 0x00, 0x00, 0x00,
+                                                    0x17, 0x00, 0x00, 0x00, 0x6d, 0x61, 0x69, 0x6e, 0x00, 0x00, 0x00, 0x00,
+                                                    0x12, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00,
+                                                    0x10, 0x00, 0x03, 0x00, 0x17, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+                                                    0x03, 0x00, 0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0xc2, 0x01, 0x00, 0x00,
+                                                    0x05, 0x00, 0x03, 0x00, 0x09, 0x00, 0x00, 0x00, 0x74, 0x65, 0x78, 0x00,
+                                                    0x05, 0x00, 0x05, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x50, 0x75, 0x73, 0x68,
+                                                    0x42, 0x75, 0x66, 0x66, 0x65, 0x72, 0x00, 0x00, 0x06, 0x00, 0x07, 0x00,
+                                                    0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x74, 0x65, 0x78, 0x74,
+                                                    0x75, 0x72, 0x65, 0x49, 0x6e, 0x64, 0x65, 0x78, 0x00, 0x00, 0x00, 0x00,
+                                                    0x05, 0x00, 0x05, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x70, 0x75, 0x73, 0x68,
+                                                    0x42, 0x75, 0x66, 0x66, 0x65, 0x72, 0x00, 0x00, 0x05, 0x00, 0x05, 0x00,
+                                                    0x0f, 0x00, 0x00, 0x00, 0x74, 0x65, 0x78, 0x53, 0x61, 0x6d, 0x70, 0x6c,
+                                                    0x65, 0x72, 0x00, 0x00, 0x05, 0x00, 0x05, 0x00, 0x12, 0x00, 0x00, 0x00,
+                                                    0x6f, 0x75, 0x74, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x00, 0x00, 0x00, 0x00,
+                                                    0x05, 0x00, 0x05, 0x00, 0x14, 0x00, 0x00, 0x00, 0x66, 0x72, 0x61, 0x67,
+                                                    0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x00, 0x00, 0x00, 0x05, 0x00, 0x04, 0x00,
+                                                    0x16, 0x00, 0x00, 0x00, 0x66, 0x72, 0x61, 0x67, 0x55, 0x76, 0x00, 0x00,
+                                                    0x05, 0x00, 0x04, 0x00, 0x17, 0x00, 0x00, 0x00, 0x6d, 0x61, 0x69, 0x6e,
+                                                    0x00, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00,
+                                                    0x22, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
+                                                    0x09, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+                                                    0x48, 0x00, 0x05, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                    0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x47, 0x00, 0x03, 0x00,
+                                                    0x0a, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
+                                                    0x0f, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                                    0x47, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00,
+                                                    0x01, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00, 0x12, 0x00, 0x00, 0x00,
                                                     0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
-                                                    0x17, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                                    0x13, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x21, 0x00, 0x03, 0x00,
-                                                    0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x16, 0x00, 0x03, 0x00,
-                                                    0x06, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x17, 0x00, 0x04, 0x00,
-                                                    0x07, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
-                                                    0x20, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-                                                    0x07, 0x00, 0x00, 0x00, 0x19, 0x00, 0x09, 0x00, 0x0a, 0x00, 0x00, 0x00,
-                                                    0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-                                                    0x00, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x0b, 0x00, 0x00, 0x00,
-                                                    0x0a, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x0c, 0x00, 0x00, 0x00,
-                                                    0x00, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00,
-                                                    0x0c, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                                    0x17, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
-                                                    0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x10, 0x00, 0x00, 0x00,
-                                                    0x01, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00,
-                                                    0x10, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
-                                                    0x20, 0x00, 0x04, 0x00, 0x14, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
-                                                    0x07, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00, 0x14, 0x00, 0x00, 0x00,
-                                                    0x15, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
-                                                    0x16, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-                                                    0x3b, 0x00, 0x04, 0x00, 0x16, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00,
-                                                    0x01, 0x00, 0x00, 0x00, 0x36, 0x00, 0x05, 0x00, 0x02, 0x00, 0x00, 0x00,
-                                                    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
-                                                    0xf8, 0x00, 0x02, 0x00, 0x05, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00,
-                                                    0x08, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
-                                                    0x3d, 0x00, 0x04, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00,
-                                                    0x0d, 0x00, 0x00, 0x00, 0x3d, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x00, 0x00,
-                                                    0x12, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x57, 0x00, 0x05, 0x00,
-                                                    0x07, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00,
-                                                    0x12, 0x00, 0x00, 0x00, 0x3e, 0x00, 0x03, 0x00, 0x09, 0x00, 0x00, 0x00,
-                                                    0x13, 0x00, 0x00, 0x00, 0x3d, 0x00, 0x04, 0x00, 0x07, 0x00, 0x00, 0x00,
-                                                    0x18, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x3d, 0x00, 0x04, 0x00,
-                                                    0x07, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
-                                                    0x85, 0x00, 0x05, 0x00, 0x07, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00,
-                                                    0x18, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x3e, 0x00, 0x03, 0x00,
-                                                    0x15, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00, 0xfd, 0x00, 0x01, 0x00,
-                                                    0x38, 0x00, 0x01, 0x00 };
-unsigned int nuklearshaders_nuklear_frag_spv_len = 860;
-
-NK_INTERN uint32_t
-nk_sdl_find_memory_index(VkPhysicalDevice physical_device, uint32_t type_filter,
-                         VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties mem_properties;
-    uint32_t i;
-
-    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
-    for (i = 0; i < mem_properties.memoryTypeCount; i++) {
-        if ((type_filter & (1 << i))
-            && (mem_properties.memoryTypes[i].propertyFlags
-                & properties)
-               == properties) {
-            return i;
-        }
-    }
-
-    assert(0);
-    return 0;
-}
-
-NK_INTERN void
-nk_sdl_create_sampler(struct nk_sdl_device *dev)
-{
-    VkResult result;
-    VkSamplerCreateInfo sampler_info;
-    memset(&sampler_info, 0, sizeof(VkSamplerCreateInfo));
-
-    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    sampler_info.pNext = NULL;
-    sampler_info.maxAnisotropy = 1.0;
-    sampler_info.magFilter = VK_FILTER_LINEAR;
-    sampler_info.minFilter = VK_FILTER_LINEAR;
-    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.mipLodBias = 0.0f;
-    sampler_info.compareEnable = VK_FALSE;
-    sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
-    sampler_info.minLod = 0.0f;
-    sampler_info.maxLod = 0.0f;
-    sampler_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
-
-    result = vkCreateSampler(dev->logical_device, &sampler_info, NULL,
-                             &dev->sampler);
-    NK_ASSERT(result == VK_SUCCESS);
-}
-
-NK_INTERN void
-nk_sdl_create_command_pool(struct nk_sdl_device *dev,
-                           uint32_t graphics_queue_family_index)
-{
-    VkResult result;
-    VkCommandPoolCreateInfo pool_info;
-    memset(&pool_info, 0, sizeof(VkCommandPoolCreateInfo));
-
-    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    pool_info.queueFamilyIndex = graphics_queue_family_index;
-    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    result = vkCreateCommandPool(dev->logical_device, &pool_info, NULL,
-                                 &dev->command_pool);
-    NK_ASSERT(result == VK_SUCCESS);
-}
-
-NK_INTERN void
-nk_sdl_create_command_buffers(struct nk_sdl_device *dev)
-{
-    VkResult result;
-    VkCommandBufferAllocateInfo allocate_info;
-    memset(&allocate_info, 0, sizeof(VkCommandBufferAllocateInfo));
-
-    dev->command_buffers = (VkCommandBuffer *)malloc(
-            dev->image_views_len * sizeof(VkCommandBuffer));
-    dev->command_buffers_len = dev->image_views_len;
-
-    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocate_info.commandPool = dev->command_pool;
-    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocate_info.commandBufferCount = dev->command_buffers_len;
-
-    result = vkAllocateCommandBuffers(dev->logical_device, &allocate_info,
-                                      dev->command_buffers);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    // create fences
-    VkFenceCreateInfo fenceCreateInfo = {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .flags = VK_FENCE_CREATE_SIGNALED_BIT
-    };
-    for (int i = 0; i < dev->image_views_len; i++)
-        vkCreateFence(dev->logical_device, &fenceCreateInfo, VK_NULL_HANDLE, &dev->frameStartFences[i]);
-}
-
-NK_INTERN void
-nk_sdl_create_semaphore(struct nk_sdl_device *dev)
-{
-    VkResult result;
-    VkSemaphoreCreateInfo semaphore_info;
-    memset(&semaphore_info, 0, sizeof(VkSemaphoreCreateInfo));
-
-    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    dev->render_completed_semaphores = malloc(sizeof(VkSemaphore) * dev->image_views_len);
-    NK_ASSERT(dev->render_completed_semaphores);
-    for (int i = 0; i < dev->image_views_len; i++) {
-        result = vkCreateSemaphore(dev->logical_device, &semaphore_info, NULL,
-                                   &dev->render_completed_semaphores[i]);
-        NK_ASSERT(result == VK_SUCCESS);
-    }
-}
-
-NK_INTERN void
-nk_sdl_create_buffer_and_memory(struct nk_sdl_device *dev, VkBuffer *buffer,
-                                VkBufferUsageFlags usage, VkDeviceMemory *memory, VkDeviceSize size)
-{
-    VkMemoryRequirements mem_reqs;
-    VkResult result;
-    VkBufferCreateInfo buffer_info;
-    VkMemoryAllocateInfo alloc_info;
-
-    memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
-    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    buffer_info.size = size;
-    buffer_info.usage = usage;
-    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    result
-            = vkCreateBuffer(dev->logical_device, &buffer_info, NULL, buffer);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    vkGetBufferMemoryRequirements(dev->logical_device, *buffer, &mem_reqs);
-
-    memset(&alloc_info, 0, sizeof(VkMemoryAllocateInfo));
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_reqs.size;
-    alloc_info.memoryTypeIndex = nk_sdl_find_memory_index(
-            dev->physical_device, mem_reqs.memoryTypeBits,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    result
-            = vkAllocateMemory(dev->logical_device, &alloc_info, NULL, memory);
-    NK_ASSERT(result == VK_SUCCESS);
-    result = vkBindBufferMemory(dev->logical_device, *buffer, *memory, 0);
-    NK_ASSERT(result == VK_SUCCESS);
-}
-
-NK_INTERN void
-nk_sdl_create_render_pass(struct nk_sdl_device *dev)
-{
-    VkAttachmentDescription attachment;
-    VkAttachmentReference color_reference;
-    VkSubpassDependency subpass_dependency;
-    VkSubpassDescription subpass_description;
-    VkRenderPassCreateInfo render_pass_info;
-    VkResult result;
-
-    memset(&attachment, 0, sizeof(VkAttachmentDescription));
-    attachment.format = dev->color_format;
-    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;//VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachment.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    memset(&color_reference, 0, sizeof(VkAttachmentReference));
-    color_reference.attachment = 0;
-    color_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    memset(&subpass_dependency, 0, sizeof(VkSubpassDependency));
-    subpass_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    subpass_dependency.srcAccessMask = 0;
-    subpass_dependency.srcStageMask
-            = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpass_dependency.dstSubpass = 0;
-    subpass_dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT
-                                       | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    subpass_dependency.dstStageMask
-            = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-
-    memset(&subpass_description, 0, sizeof(VkSubpassDescription));
-    subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass_description.colorAttachmentCount = 1;
-    subpass_description.pColorAttachments = &color_reference;
-
-    memset(&render_pass_info, 0, sizeof(VkRenderPassCreateInfo));
-    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    render_pass_info.attachmentCount = 1;
-    render_pass_info.pAttachments = &attachment;
-    render_pass_info.subpassCount = 1;
-    render_pass_info.pSubpasses = &subpass_description;
-    render_pass_info.dependencyCount = 1;
-    render_pass_info.pDependencies = &subpass_dependency;
-
-    result = vkCreateRenderPass(dev->logical_device, &render_pass_info,
-                                NULL, &dev->render_pass);
-    NK_ASSERT(result == VK_SUCCESS);
-}
-
-NK_INTERN void
-nk_sdl_create_framebuffers(struct nk_sdl_device *dev,
-                           uint32_t framebuffer_width, uint32_t framebuffer_height)
-{
-
-    VkFramebufferCreateInfo framebuffer_create_info;
-    uint32_t i;
-    VkResult result;
-
-    dev->framebuffers = (VkFramebuffer *)malloc(
-            dev->image_views_len * sizeof(VkFramebuffer));
-
-    memset(&framebuffer_create_info, 0, sizeof(VkFramebufferCreateInfo));
-    framebuffer_create_info.sType
-            = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebuffer_create_info.renderPass = dev->render_pass;
-    framebuffer_create_info.attachmentCount = 1;
-    framebuffer_create_info.width = framebuffer_width;
-    framebuffer_create_info.height = framebuffer_height;
-    framebuffer_create_info.layers = 1;
-    for (i = 0; i < dev->image_views_len; i++) {
-        framebuffer_create_info.pAttachments = &dev->image_views[i];
-        result = vkCreateFramebuffer(dev->logical_device,
-                                     &framebuffer_create_info, NULL, &dev->framebuffers[i]);
-        NK_ASSERT(result == VK_SUCCESS);
-    }
-    dev->framebuffers_len = dev->image_views_len;
-}
+                                                    0x14, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                    0x47, 0x00, 0x04, 0x00, 0x16, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00,
+                                                    0x01, 0x00, 0x00, 0x00, 0x16, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                                    0x20, 0x00, 0x00, 0x00, 0x15, 0x00, 0x04, 0x00, 0x02, 0x00, 0x00, 0x00,
+                                                    0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00, 0x04, 0x00,
+                                                    0x03, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                                    0x17, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                                    0x02, 0x00, 0x00, 0x00, 0x17, 0x00, 0x04, 0x00, 0x05, 0x00, 0x00, 0x00,
+                                                    0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x19, 0x00, 0x09, 0x00,
+                                                    0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1d, 0x00, 0x03, 0x00,
+                                                    0x07, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
+                                                    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+                                                    0x3b, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
+                                                    0x00, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x03, 0x00, 0x0a, 0x00, 0x00, 0x00,
+                                                    0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x0b, 0x00, 0x00, 0x00,
+                                                    0x09, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00,
+                                                    0x0b, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
+                                                    0x1a, 0x00, 0x02, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
+                                                    0x0e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00,
+                                                    0x3b, 0x00, 0x04, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00,
+                                                    0x00, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x10, 0x00, 0x00, 0x00,
+                                                    0x06, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x11, 0x00, 0x00, 0x00,
+                                                    0x03, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00,
+                                                    0x11, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+                                                    0x20, 0x00, 0x04, 0x00, 0x13, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                                    0x05, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00, 0x13, 0x00, 0x00, 0x00,
+                                                    0x14, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00,
+                                                    0x15, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+                                                    0x3b, 0x00, 0x04, 0x00, 0x15, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00,
+                                                    0x01, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x19, 0x00, 0x00, 0x00,
+                                                    0x09, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x2b, 0x00, 0x04, 0x00,
+                                                    0x03, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                    0x20, 0x00, 0x04, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                    0x06, 0x00, 0x00, 0x00, 0x13, 0x00, 0x02, 0x00, 0x26, 0x00, 0x00, 0x00,
+                                                    0x21, 0x00, 0x03, 0x00, 0x27, 0x00, 0x00, 0x00, 0x26, 0x00, 0x00, 0x00,
+                                                    0x36, 0x00, 0x05, 0x00, 0x26, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00,
+                                                    0x00, 0x00, 0x00, 0x00, 0x27, 0x00, 0x00, 0x00, 0xf8, 0x00, 0x02, 0x00,
+                                                    0x18, 0x00, 0x00, 0x00, 0x41, 0x00, 0x05, 0x00, 0x19, 0x00, 0x00, 0x00,
+                                                    0x1b, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00,
+                                                    0x3d, 0x00, 0x04, 0x00, 0x02, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
+                                                    0x1b, 0x00, 0x00, 0x00, 0x41, 0x00, 0x05, 0x00, 0x1d, 0x00, 0x00, 0x00,
+                                                    0x1e, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
+                                                    0x3d, 0x00, 0x04, 0x00, 0x06, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00,
+                                                    0x1e, 0x00, 0x00, 0x00, 0x3d, 0x00, 0x04, 0x00, 0x0d, 0x00, 0x00, 0x00,
+                                                    0x20, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x56, 0x00, 0x05, 0x00,
+                                                    0x10, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00,
+                                                    0x20, 0x00, 0x00, 0x00, 0x3d, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00,
+                                                    0x22, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00, 0x57, 0x00, 0x05, 0x00,
+                                                    0x05, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00,
+                                                    0x22, 0x00, 0x00, 0x00, 0x3d, 0x00, 0x04, 0x00, 0x05, 0x00, 0x00, 0x00,
+                                                    0x24, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x85, 0x00, 0x05, 0x00,
+                                                    0x05, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00,
+                                                    0x23, 0x00, 0x00, 0x00, 0x3e, 0x00, 0x03, 0x00, 0x12, 0x00, 0x00, 0x00,
+                                                    0x25, 0x00, 0x00, 0x00, 0xfd, 0x00, 0x01, 0x00, 0x38, 0x00, 0x01, 0x00 };
+unsigned int nuklearshaders_nuklear_frag_spv_len = 1096;
 
 NK_INTERN void
 nk_sdl_create_descriptor_pool(struct nk_sdl_device *dev)
 {
-    VkDescriptorPoolSize pool_sizes[2];
+    VkDescriptorPoolSize pool_size;
     VkDescriptorPoolCreateInfo pool_info;
     VkResult result;
 
-    memset(&pool_sizes, 0, sizeof(VkDescriptorPoolSize) * 2);
-    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    pool_sizes[0].descriptorCount = 3;
-    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    pool_sizes[1].descriptorCount = NK_SDL_MAX_TEXTURES;
+    // textures come from the renderer's texture array so only the
+    // projection matrices need sets of their own
+    memset(&pool_size, 0, sizeof(VkDescriptorPoolSize));
+    pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pool_size.descriptorCount = dev->frames_len;
 
     memset(&pool_info, 0, sizeof(VkDescriptorPoolCreateInfo));
     pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_info.poolSizeCount = 2;
-    pool_info.pPoolSizes = pool_sizes;
-    pool_info.maxSets = 3 + NK_SDL_MAX_TEXTURES;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+    pool_info.maxSets = dev->frames_len;
 
     result = vkCreateDescriptorPool(dev->logical_device, &pool_info, NULL,
                                     &dev->descriptor_pool);
@@ -604,12 +364,14 @@ nk_sdl_create_uniform_descriptor_set_layout(struct nk_sdl_device *dev)
 }
 
 NK_INTERN void
-nk_sdl_create_and_update_uniform_descriptor_set(struct nk_sdl_device *dev, int fif)
+nk_sdl_create_uniform_descriptor_sets(struct nk_sdl_device *dev)
 {
     VkDescriptorSetAllocateInfo allocate_info;
-    VkDescriptorBufferInfo buffer_info;
-    VkWriteDescriptorSet descriptor_write;
     VkResult result;
+    uint32_t i;
+
+    dev->uniform_descriptor_sets = (VkDescriptorSet *)malloc(
+            dev->frames_len * sizeof(VkDescriptorSet));
 
     memset(&allocate_info, 0, sizeof(VkDescriptorSetAllocateInfo));
     allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -617,18 +379,28 @@ nk_sdl_create_and_update_uniform_descriptor_set(struct nk_sdl_device *dev, int f
     allocate_info.descriptorSetCount = 1;
     allocate_info.pSetLayouts = &dev->uniform_descriptor_set_layout;
 
-    result = vkAllocateDescriptorSets(dev->logical_device, &allocate_info,
-                                      &dev->uniform_descriptor_sets[fif]);
-    NK_ASSERT(result == VK_SUCCESS);
+    for (i = 0; i < dev->frames_len; i++) {
+        result = vkAllocateDescriptorSets(dev->logical_device, &allocate_info,
+                                          &dev->uniform_descriptor_sets[i]);
+        NK_ASSERT(result == VK_SUCCESS);
+    }
+}
+
+NK_INTERN void
+nk_sdl_update_uniform_descriptor_set(struct nk_sdl_device *dev, uint32_t frame,
+                                     VkBuffer uniform_buffer, VkDeviceSize uniform_offset)
+{
+    VkDescriptorBufferInfo buffer_info;
+    VkWriteDescriptorSet descriptor_write;
 
     memset(&buffer_info, 0, sizeof(VkDescriptorBufferInfo));
-    buffer_info.buffer = dev->uniform_buffers[fif];
-    buffer_info.offset = 0;
+    buffer_info.buffer = uniform_buffer;
+    buffer_info.offset = uniform_offset;
     buffer_info.range = sizeof(struct Mat4f);
 
     memset(&descriptor_write, 0, sizeof(VkWriteDescriptorSet));
     descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptor_write.dstSet = dev->uniform_descriptor_sets[fif];
+    descriptor_write.dstSet = dev->uniform_descriptor_sets[frame];
     descriptor_write.dstBinding = 0;
     descriptor_write.dstArrayElement = 0;
     descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -639,91 +411,33 @@ nk_sdl_create_and_update_uniform_descriptor_set(struct nk_sdl_device *dev, int f
                            NULL);
 }
 
-NK_INTERN void
-nk_sdl_create_texture_descriptor_set_layout(struct nk_sdl_device *dev)
-{
-    VkDescriptorSetLayoutBinding binding;
-    VkDescriptorSetLayoutCreateInfo descriptor_set_info;
-    VkResult result;
-
-    memset(&binding, 0, sizeof(VkDescriptorSetLayoutBinding));
-    binding.binding = 0;
-    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    binding.descriptorCount = 1;
-    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    memset(&descriptor_set_info, 0,
-           sizeof(VkDescriptorSetLayoutCreateInfo));
-    descriptor_set_info.sType
-            = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    descriptor_set_info.bindingCount = 1;
-    descriptor_set_info.pBindings = &binding;
-
-    result = vkCreateDescriptorSetLayout(dev->logical_device,
-                                         &descriptor_set_info, NULL, &dev->texture_descriptor_set_layout);
-
-    NK_ASSERT(result == VK_SUCCESS);
-}
-
-NK_INTERN void
-nk_sdl_create_texture_descriptor_sets(struct nk_sdl_device *dev)
-{
-    VkDescriptorSetLayout *descriptor_set_layouts;
-    VkDescriptorSet *descriptor_sets;
-    VkDescriptorSetAllocateInfo allocate_info;
-    VkResult result;
-    int i;
-
-    descriptor_set_layouts = (VkDescriptorSetLayout *)malloc(
-            NK_SDL_MAX_TEXTURES * sizeof(VkDescriptorSetLayout));
-    descriptor_sets = (VkDescriptorSet *)malloc(
-            NK_SDL_MAX_TEXTURES * sizeof(VkDescriptorSet));
-
-    dev->texture_descriptor_sets
-            = (struct nk_vulkan_texture_descriptor_set *)malloc(
-            NK_SDL_MAX_TEXTURES
-            * sizeof(struct nk_vulkan_texture_descriptor_set));
-    dev->texture_descriptor_sets_len = 0;
-
-    for (i = 0; i < NK_SDL_MAX_TEXTURES; i++) {
-        descriptor_set_layouts[i] = dev->texture_descriptor_set_layout;
-        descriptor_sets[i]
-                = dev->texture_descriptor_sets[i].descriptor_set;
-    }
-
-    memset(&allocate_info, 0, sizeof(VkDescriptorSetAllocateInfo));
-    allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocate_info.descriptorPool = dev->descriptor_pool;
-    allocate_info.descriptorSetCount = NK_SDL_MAX_TEXTURES;
-    allocate_info.pSetLayouts = descriptor_set_layouts;
-
-    result = vkAllocateDescriptorSets(dev->logical_device, &allocate_info,
-                                      descriptor_sets);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    for (i = 0; i < NK_SDL_MAX_TEXTURES; i++) {
-        dev->texture_descriptor_sets[i].descriptor_set
-                = descriptor_sets[i];
-    }
-    free(descriptor_set_layouts);
-    free(descriptor_sets);
-}
-
 NK_INTERN void
 nk_sdl_create_pipeline_layout(struct nk_sdl_device *dev)
 {
     VkPipelineLayoutCreateInfo pipeline_layout_info;
-    VkDescriptorSetLayout descriptor_set_layouts[2];
+    VkDescriptorSetLayout descriptor_set_layouts[3];
+    VkPushConstantRange push_constant_range;
     VkResult result;
 
+    // same set numbers as the renderer's own shaders use for the sampler
+    // and texture array
     descriptor_set_layouts[0] = dev->uniform_descriptor_set_layout;
-    descriptor_set_layouts[1] = dev->texture_descriptor_set_layout;
+    descriptor_set_layouts[1] = dev->sampler_descriptor_set_layout;
+    descriptor_set_layouts[2] = dev->texture_descriptor_set_layout;
+
+    // the texture array index of the current draw command
+    memset(&push_constant_range, 0, sizeof(VkPushConstantRange));
+    push_constant_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(uint32_t);
 
     memset(&pipeline_layout_info, 0, sizeof(VkPipelineLayoutCreateInfo));
     pipeline_layout_info.sType
             = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 2;
+    pipeline_layout_info.setLayoutCount = 3;
     pipeline_layout_info.pSetLayouts = descriptor_set_layouts;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 
     result = (vkCreatePipelineLayout(dev->logical_device,
                                      &pipeline_layout_info, NULL, &dev->pipeline_layout));
@@ -773,6 +487,8 @@ nk_sdl_create_pipeline(struct nk_sdl_device *dev)
     VkPipelineColorBlendStateCreateInfo color_blend_state;
     VkPipelineViewportStateCreateInfo viewport_state;
     VkPipelineMultisampleStateCreateInfo multisample_state;
+    VkPipelineDepthStencilStateCreateInfo depth_stencil_state;
+    VkPipelineRenderingCreateInfoKHR rendering_info;
     VkDynamicState dynamic_states[2]
             = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
     VkPipelineDynamicStateCreateInfo dynamic_state;
@@ -816,7 +532,25 @@ nk_sdl_create_pipeline(struct nk_sdl_device *dev)
            sizeof(VkPipelineMultisampleStateCreateInfo));
     multisample_state.sType
             = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisample_state.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisample_state.rasterizationSamples = dev->samples;
+
+    // the renderer's screen pass has a depth attachment, the gui just ignores it
+    memset(&depth_stencil_state, 0,
+           sizeof(VkPipelineDepthStencilStateCreateInfo));
+    depth_stencil_state.sType
+            = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil_state.depthTestEnable = VK_FALSE;
+    depth_stencil_state.depthWriteEnable = VK_FALSE;
+    depth_stencil_state.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    depth_stencil_state.minDepthBounds = 0.0f;
+    depth_stencil_state.maxDepthBounds = 1.0f;
+
+    memset(&rendering_info, 0, sizeof(VkPipelineRenderingCreateInfoKHR));
+    rendering_info.sType
+            = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachmentFormats = &dev->color_format;
+    rendering_info.depthAttachmentFormat = dev->depth_format;
 
     memset(&dynamic_state, 0, sizeof(VkPipelineDynamicStateCreateInfo));
     dynamic_state.sType
@@ -870,10 +604,12 @@ nk_sdl_create_pipeline(struct nk_sdl_device *dev)
     pipeline_info.pViewportState = &viewport_state;
     pipeline_info.pRasterizationState = &rasterization_state;
     pipeline_info.pMultisampleState = &multisample_state;
+    pipeline_info.pDepthStencilState = &depth_stencil_state;
     pipeline_info.pColorBlendState = &color_blend_state;
     pipeline_info.pDynamicState = &dynamic_state;
     pipeline_info.layout = dev->pipeline_layout;
     pipeline_info.renderPass = dev->render_pass;
+    pipeline_info.pNext = dev->render_pass == VK_NULL_HANDLE ? &rendering_info : NULL;
     pipeline_info.basePipelineIndex = -1;
     pipeline_info.basePipelineHandle = NULL;
 
@@ -888,318 +624,66 @@ nk_sdl_create_pipeline(struct nk_sdl_device *dev)
 }
 
 NK_INTERN void
-nk_sdl_create_render_resources(struct nk_sdl_device *dev,
-                               uint32_t framebuffer_width, uint32_t framebuffer_height)
+nk_sdl_create_render_resources(struct nk_sdl_device *dev)
 {
-    nk_sdl_create_render_pass(dev);
-    nk_sdl_create_framebuffers(dev, framebuffer_width, framebuffer_height);
     nk_sdl_create_descriptor_pool(dev);
     nk_sdl_create_uniform_descriptor_set_layout(dev);
-    for (int i = 0; i < dev->image_views_len; i++)
-        nk_sdl_create_and_update_uniform_descriptor_set(dev, i);
-    nk_sdl_create_texture_descriptor_set_layout(dev);
-    nk_sdl_create_texture_descriptor_sets(dev);
+    nk_sdl_create_uniform_descriptor_sets(dev);
     nk_sdl_create_pipeline_layout(dev);
     nk_sdl_create_pipeline(dev);
 }
 
 NK_API void
-nk_sdl_device_create(VkDevice logical_device, VkPhysicalDevice physical_device,
-                     uint32_t graphics_queue_family_index, VkImageView *image_views,
-                     uint32_t image_views_len, VkFormat color_format,
-                     VkDeviceSize max_vertex_buffer, VkDeviceSize max_element_buffer,
-                     uint32_t framebuffer_width, uint32_t framebuffer_height)
+nk_sdl_device_create(VkDevice logical_device, VkRenderPass render_pass,
+                     VkSampleCountFlagBits samples, VkFormat color_format,
+                     VkFormat depth_format, uint32_t frames_in_flight,
+                     VkDescriptorSetLayout sampler_layout,
+                     VkDescriptorSetLayout texture_layout)
 {
     struct nk_sdl_device *dev = &sdl.vulkan;
-    dev->max_vertex_buffer = max_vertex_buffer;
-    dev->max_element_buffer = max_element_buffer;
     nk_buffer_init_default(&dev->cmds);
+    nk_buffer_init_default(&dev->vertices);
+    nk_buffer_init_default(&dev->elements);
     dev->logical_device = logical_device;
-    dev->physical_device = physical_device;
-    dev->image_views = image_views;
-    dev->image_views_len = image_views_len;
+    dev->render_pass = render_pass;
+    dev->samples = samples;
     dev->color_format = color_format;
-    dev->framebuffers = NULL;
-    dev->framebuffers_len = 0;
-    dev->vertex_buffers = malloc(image_views_len * sizeof(VkBuffer));
-    dev->vertex_memorys = malloc(image_views_len * sizeof(VkDeviceMemory));
-    dev->mapped_vertexs = malloc(image_views_len * sizeof(void*));
-    dev->index_buffers = malloc(image_views_len * sizeof(VkBuffer));
-    dev->index_memorys = malloc(image_views_len * sizeof(VkDeviceMemory));
-    dev->mapped_indexs = malloc(image_views_len * sizeof(void*));
-    dev->uniform_buffers = malloc(image_views_len * sizeof(VkBuffer));
-    dev->uniform_memorys = malloc(image_views_len * sizeof(VkDeviceMemory));
-    dev->mapped_uniforms = malloc(image_views_len * sizeof(void*));
-    dev->uniform_descriptor_sets = malloc(image_views_len * sizeof(VkDescriptorSet));
-    dev->frameStartFences = malloc(image_views_len * sizeof(VkFence));
-
-    nk_sdl_create_sampler(dev);
-    nk_sdl_create_command_pool(dev, graphics_queue_family_index);
-    nk_sdl_create_command_buffers(dev);
-    nk_sdl_create_semaphore(dev);
-
-    for (int i = 0; i < image_views_len; i++) {
-        nk_sdl_create_buffer_and_memory(dev, &dev->vertex_buffers[i],
-                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &dev->vertex_memorys[i],
-                                        max_vertex_buffer);
-        nk_sdl_create_buffer_and_memory(dev, &dev->index_buffers[i],
-                                        VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &dev->index_memorys[i],
-                                        max_element_buffer);
-        nk_sdl_create_buffer_and_memory(dev, &dev->uniform_buffers[i],
-                                        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, &dev->uniform_memorys[i],
-                                        sizeof(struct Mat4f));
-
-        vkMapMemory(dev->logical_device, dev->vertex_memorys[i], 0,
-                    max_vertex_buffer, 0, &dev->mapped_vertexs[i]);
-        vkMapMemory(dev->logical_device, dev->index_memorys[i], 0,
-                    max_element_buffer, 0, &dev->mapped_indexs[i]);
-        vkMapMemory(dev->logical_device, dev->uniform_memorys[i], 0,
-                    sizeof(struct Mat4f), 0, &dev->mapped_uniforms[i]);
-    }
+    dev->depth_format = depth_format;
+    dev->frames_len = frames_in_flight;
+    dev->sampler_descriptor_set_layout = sampler_layout;
+    dev->texture_descriptor_set_layout = texture_layout;
 
-    nk_sdl_create_render_resources(dev, framebuffer_width,
-                                   framebuffer_height);
-}
-
-NK_INTERN void
-nk_sdl_device_upload_atlas(VkQueue graphics_queue, const void *image, int width,
-                           int height)
-{
-    struct nk_sdl_device *dev = &sdl.vulkan;
-
-    VkImageCreateInfo image_info;
-    VkResult result;
-    VkMemoryRequirements mem_reqs;
-    VkMemoryAllocateInfo alloc_info;
-    VkBufferCreateInfo buffer_info;
-    uint8_t *data = 0;
-    VkCommandBufferBeginInfo begin_info;
-    VkCommandBuffer command_buffer;
-    VkImageMemoryBarrier image_memory_barrier;
-    VkBufferImageCopy buffer_copy_region;
-    VkImageMemoryBarrier image_shader_memory_barrier;
-    VkFence fence;
-    VkFenceCreateInfo fence_create;
-    VkSubmitInfo submit_info;
-    VkImageViewCreateInfo image_view_info;
-    struct {
-        VkDeviceMemory memory;
-        VkBuffer buffer;
-    } staging_buffer;
-
-    memset(&image_info, 0, sizeof(VkImageCreateInfo));
-    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    image_info.imageType = VK_IMAGE_TYPE_2D;
-    image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
-    image_info.extent.width = (uint32_t)width;
-    image_info.extent.height = (uint32_t)height;
-    image_info.extent.depth = 1;
-    image_info.mipLevels = 1;
-    image_info.arrayLayers = 1;
-    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
-    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-    image_info.usage
-            = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-    result = vkCreateImage(dev->logical_device, &image_info, NULL,
-                           &dev->font_image);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    vkGetImageMemoryRequirements(dev->logical_device, dev->font_image,
-                                 &mem_reqs);
-
-    memset(&alloc_info, 0, sizeof(VkMemoryAllocateInfo));
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_reqs.size;
-    alloc_info.memoryTypeIndex
-            = nk_sdl_find_memory_index(dev->physical_device,
-                                       mem_reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    result = vkAllocateMemory(dev->logical_device, &alloc_info, NULL,
-                              &dev->font_memory);
-    NK_ASSERT(result == VK_SUCCESS);
-    result = vkBindImageMemory(dev->logical_device, dev->font_image,
-                               dev->font_memory, 0);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    memset(&buffer_info, 0, sizeof(VkBufferCreateInfo));
-    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    buffer_info.size = alloc_info.allocationSize;
-    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    result = vkCreateBuffer(dev->logical_device, &buffer_info, NULL,
-                            &staging_buffer.buffer);
-    NK_ASSERT(result == VK_SUCCESS);
-    vkGetBufferMemoryRequirements(dev->logical_device,
-                                  staging_buffer.buffer, &mem_reqs);
-
-    alloc_info.allocationSize = mem_reqs.size;
-    alloc_info.memoryTypeIndex = nk_sdl_find_memory_index(
-            dev->physical_device, mem_reqs.memoryTypeBits,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    result = vkAllocateMemory(dev->logical_device, &alloc_info, NULL,
-                              &staging_buffer.memory);
-    NK_ASSERT(result == VK_SUCCESS);
-    result = vkBindBufferMemory(dev->logical_device, staging_buffer.buffer,
-                                staging_buffer.memory, 0);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    result = vkMapMemory(dev->logical_device, staging_buffer.memory, 0,
-                         alloc_info.allocationSize, 0, (void **)&data);
-    NK_ASSERT(result == VK_SUCCESS);
-    memcpy(data, image, width * height * 4);
-    vkUnmapMemory(dev->logical_device, staging_buffer.memory);
-
-    memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-    NK_ASSERT(dev->command_buffers_len > 0);
-    /*
-    use the same command buffer as for render as we are regenerating the
-    buffer during render anyway
-    */
-    command_buffer = dev->command_buffers[0];
-    result = vkBeginCommandBuffer(command_buffer, &begin_info);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    memset(&image_memory_barrier, 0, sizeof(VkImageMemoryBarrier));
-    image_memory_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    image_memory_barrier.image = dev->font_image;
-    image_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    image_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    image_memory_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_memory_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    image_memory_barrier.subresourceRange.aspectMask
-            = VK_IMAGE_ASPECT_COLOR_BIT;
-    image_memory_barrier.subresourceRange.levelCount = 1;
-    image_memory_barrier.subresourceRange.layerCount = 1;
-    image_memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1,
-                         &image_memory_barrier);
-
-    memset(&buffer_copy_region, 0, sizeof(VkBufferImageCopy));
-    buffer_copy_region.imageSubresource.aspectMask
-            = VK_IMAGE_ASPECT_COLOR_BIT;
-    buffer_copy_region.imageSubresource.layerCount = 1;
-    buffer_copy_region.imageExtent.width = (uint32_t)width;
-    buffer_copy_region.imageExtent.height = (uint32_t)height;
-    buffer_copy_region.imageExtent.depth = 1;
-
-    vkCmdCopyBufferToImage(command_buffer, staging_buffer.buffer,
-                           dev->font_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-                           &buffer_copy_region);
-
-    memset(&image_shader_memory_barrier, 0, sizeof(VkImageMemoryBarrier));
-    image_shader_memory_barrier.sType
-            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    image_shader_memory_barrier.image = dev->font_image;
-    image_shader_memory_barrier.srcQueueFamilyIndex
-            = VK_QUEUE_FAMILY_IGNORED;
-    image_shader_memory_barrier.dstQueueFamilyIndex
-            = VK_QUEUE_FAMILY_IGNORED;
-    image_shader_memory_barrier.oldLayout
-            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    image_shader_memory_barrier.newLayout
-            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    image_shader_memory_barrier.subresourceRange.aspectMask
-            = VK_IMAGE_ASPECT_COLOR_BIT;
-    image_shader_memory_barrier.subresourceRange.levelCount = 1;
-    image_shader_memory_barrier.subresourceRange.layerCount = 1;
-    image_shader_memory_barrier.srcAccessMask
-            = VK_ACCESS_TRANSFER_WRITE_BIT,
-            image_shader_memory_barrier.dstAccessMask
-                    = VK_ACCESS_SHADER_READ_BIT,
-
-            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1,
-                                 &image_shader_memory_barrier);
-
-    result = vkEndCommandBuffer(command_buffer);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    memset(&fence_create, 0, sizeof(VkFenceCreateInfo));
-    fence_create.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-
-    result
-            = vkCreateFence(dev->logical_device, &fence_create, NULL, &fence);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    memset(&submit_info, 0, sizeof(VkSubmitInfo));
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer;
-
-    result = vkQueueSubmit(graphics_queue, 1, &submit_info, fence);
-    NK_ASSERT(result == VK_SUCCESS);
-    result = vkWaitForFences(dev->logical_device, 1, &fence, VK_TRUE,
-                             UINT64_MAX);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    vkDestroyFence(dev->logical_device, fence, NULL);
-
-    vkFreeMemory(dev->logical_device, staging_buffer.memory, NULL);
-    vkDestroyBuffer(dev->logical_device, staging_buffer.buffer, NULL);
-
-    memset(&image_view_info, 0, sizeof(VkImageViewCreateInfo));
-    image_view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    image_view_info.image = dev->font_image;
-    image_view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    image_view_info.format = image_info.format;
-    image_view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    image_view_info.subresourceRange.layerCount = 1;
-    image_view_info.subresourceRange.levelCount = 1;
-
-    result = vkCreateImageView(dev->logical_device, &image_view_info, NULL,
-                               &dev->font_image_view);
-    NK_ASSERT(result == VK_SUCCESS);
+    nk_sdl_create_render_resources(dev);
 }
 
 NK_INTERN void
 nk_sdl_destroy_render_resources(struct nk_sdl_device *dev)
 {
-    uint32_t i;
-
     vkDestroyPipeline(dev->logical_device, dev->pipeline, NULL);
     vkDestroyPipelineLayout(dev->logical_device, dev->pipeline_layout,
                             NULL);
-    vkDestroyDescriptorSetLayout(dev->logical_device,
-                                 dev->texture_descriptor_set_layout, NULL);
     vkDestroyDescriptorSetLayout(dev->logical_device,
                                  dev->uniform_descriptor_set_layout, NULL);
     vkDestroyDescriptorPool(dev->logical_device, dev->descriptor_pool,
                             NULL);
-    for (i = 0; i < dev->framebuffers_len; i++) {
-        vkDestroyFramebuffer(dev->logical_device, dev->framebuffers[i],
-                             NULL);
-    }
-    free(dev->framebuffers);
-    dev->framebuffers_len = 0;
-    free(dev->texture_descriptor_sets);
-    dev->texture_descriptor_sets_len = 0;
-    vkDestroyRenderPass(dev->logical_device, dev->render_pass, NULL);
+    free(dev->uniform_descriptor_sets);
 }
 
 NK_API void
-nk_sdl_resize(VkImageView *imageViews, uint32_t imageViewCount, uint32_t framebuffer_width, uint32_t framebuffer_height)
+nk_sdl_resize(VkRenderPass render_pass, VkSampleCountFlagBits samples,
+              uint32_t framebuffer_width, uint32_t framebuffer_height)
 {
     struct nk_sdl_device *dev = &sdl.vulkan;
 
     SDL_GetWindowSize(sdl.win, &sdl.width, &sdl.height);
     sdl.display_width = framebuffer_width;
     sdl.display_height = framebuffer_height;
-    dev->image_views = imageViews;
-    dev->image_views_len = imageViewCount;
 
-    nk_sdl_destroy_render_resources(dev);
-    nk_sdl_create_render_resources(dev, sdl.display_width,
-                                   sdl.display_height);
+    // only the pipeline depends on the renderer's render pass
+    vkDestroyPipeline(dev->logical_device, dev->pipeline, NULL);
+    dev->render_pass = render_pass;
+    dev->samples = samples;
+    nk_sdl_create_pipeline(dev);
 }
 
 NK_API void
@@ -1211,48 +695,9 @@ nk_sdl_device_destroy(void)
 
     nk_sdl_destroy_render_resources(dev);
 
-    vkFreeCommandBuffers(dev->logical_device, dev->command_pool,
-                         dev->command_buffers_len, dev->command_buffers);
-    vkDestroyCommandPool(dev->logical_device, dev->command_pool, NULL);
-    for (int i = 0; i < dev->image_views_len; i++) {
-        vkDestroyFence(dev->logical_device, dev->frameStartFences[i], VK_NULL_HANDLE);
-        vkDestroySemaphore(dev->logical_device, dev->render_completed_semaphores[i], NULL);
-    }
-
-    for (int i = 0; i < dev->image_views_len; i++) {
-        vkUnmapMemory(dev->logical_device, dev->vertex_memorys[i]);
-        vkUnmapMemory(dev->logical_device, dev->index_memorys[i]);
-        vkUnmapMemory(dev->logical_device, dev->uniform_memorys[i]);
-
-        vkFreeMemory(dev->logical_device, dev->vertex_memorys[i], NULL);
-        vkFreeMemory(dev->logical_device, dev->index_memorys[i], NULL);
-        vkFreeMemory(dev->logical_device, dev->uniform_memorys[i], NULL);
-
-        vkDestroyBuffer(dev->logical_device, dev->vertex_buffers[i], NULL);
-        vkDestroyBuffer(dev->logical_device, dev->index_buffers[i], NULL);
-        vkDestroyBuffer(dev->logical_device, dev->uniform_buffers[i], NULL);
-    }
-
-    vkDestroySampler(dev->logical_device, dev->sampler, NULL);
-
-    vkFreeMemory(dev->logical_device, dev->font_memory, NULL);
-    vkDestroyImage(dev->logical_device, dev->font_image, NULL);
-    vkDestroyImageView(dev->logical_device, dev->font_image_view, NULL);
-
-    free(dev->command_buffers);
     nk_buffer_free(&dev->cmds);
-
-    free(dev->vertex_buffers);
-    free(dev->vertex_memorys);
-    free(dev->mapped_vertexs);
-    free(dev->index_buffers);
-    free(dev->index_memorys);
-    free(dev->mapped_indexs);
-    free(dev->uniform_buffers);
-    free(dev->uniform_memorys);
-    free(dev->mapped_uniforms);
-    free(dev->uniform_descriptor_sets);
-    free(dev->frameStartFences);
+    nk_buffer_free(&dev->vertices);
+    nk_buffer_free(&dev->elements);
 }
 
 NK_API
@@ -1273,16 +718,18 @@ nk_sdl_font_stash_begin(struct nk_font_atlas **atlas)
     *atlas = &sdl.atlas;
 }
 
+NK_API const void *
+nk_sdl_font_stash_bake(int *width, int *height)
+{
+    return nk_font_atlas_bake(&sdl.atlas, width, height, NK_FONT_ATLAS_RGBA32);
+}
+
 NK_API void
-nk_sdl_font_stash_end(VkQueue graphics_queue)
+nk_sdl_font_stash_end(uint32_t font_texture_index)
 {
     struct nk_sdl_device *dev = &sdl.vulkan;
 
-    const void *image;
-    int w, h;
-    image = nk_font_atlas_bake(&sdl.atlas, &w, &h, NK_FONT_ATLAS_RGBA32);
-    nk_sdl_device_upload_atlas(graphics_queue, image, w, h);
-    nk_font_atlas_end(&sdl.atlas, nk_handle_ptr(dev->font_image_view),
+    nk_font_atlas_end(&sdl.atlas, nk_handle_id((int)font_texture_index),
                       &dev->tex_null);
     if (sdl.atlas.default_font) {
         nk_style_set_font(&sdl.ctx, &sdl.atlas.default_font->handle);
@@ -1434,117 +881,16 @@ nk_sdl_handle_event(SDL_Event *evt)
     return 0;
 }
 
-NK_INTERN void
-update_texture_descriptor_set(struct nk_sdl_device *dev,
-                              struct nk_vulkan_texture_descriptor_set *texture_descriptor_set,
-                              VkImageView image_view)
-{
-    VkDescriptorImageInfo descriptor_image_info;
-    VkWriteDescriptorSet descriptor_write;
-
-    texture_descriptor_set->image_view = image_view;
-
-    memset(&descriptor_image_info, 0, sizeof(VkDescriptorImageInfo));
-    descriptor_image_info.sampler = dev->sampler;
-    descriptor_image_info.imageView = texture_descriptor_set->image_view;
-    descriptor_image_info.imageLayout
-            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    memset(&descriptor_write, 0, sizeof(VkWriteDescriptorSet));
-    descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptor_write.dstSet = texture_descriptor_set->descriptor_set;
-    descriptor_write.dstBinding = 0;
-    descriptor_write.dstArrayElement = 0;
-    descriptor_write.descriptorType
-            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptor_write.descriptorCount = 1;
-    descriptor_write.pImageInfo = &descriptor_image_info;
-
-    vkUpdateDescriptorSets(dev->logical_device, 1, &descriptor_write, 0,
-                           NULL);
-}
-
-NK_API
-VkSemaphore
-nk_sdl_render(VkQueue graphics_queue, uint32_t buffer_index,
-              VkSemaphore wait_semaphore, enum nk_anti_aliasing AA)
+NK_API void
+nk_sdl_convert(enum nk_anti_aliasing AA, const void **vertices,
+               nk_size *vertices_size, const void **elements,
+               nk_size *elements_size, float projection[16])
 {
     struct nk_sdl_device *dev = &sdl.vulkan;
-    struct nk_buffer vbuf, ebuf;
-
-    struct Mat4f projection = {
+    struct Mat4f ortho = {
             { 2.0f, 0.0f, 0.0f, 0.0f, 0.0f, -2.0f, 0.0f, 0.0f, 0.0f, 0.0f,
                     -1.0f, 0.0f, -1.0f, 1.0f, 0.0f, 1.0f },
     };
-
-    vkWaitForFences(dev->logical_device, 1, &dev->frameStartFences[buffer_index], VK_TRUE, UINT64_MAX);
-    vkResetFences(dev->logical_device, 1, &dev->frameStartFences[buffer_index]);
-
-    VkCommandBufferBeginInfo begin_info;
-    //VkClearValue clear_value = { { { 0.0f, 0.0f, 0.0f, 0.0f } } };
-    VkRenderPassBeginInfo render_pass_begin_nfo;
-    VkCommandBuffer command_buffer;
-    VkResult result;
-    VkViewport viewport;
-
-    VkDeviceSize doffset = 0;
-    VkImageView current_texture = NULL;
-    uint32_t index_offset = 0;
-    VkRect2D scissor;
-    uint32_t wait_semaphore_count;
-    VkSemaphore *wait_semaphores;
-    VkPipelineStageFlags wait_stage
-            = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    VkSubmitInfo submit_info;
-    uint64_t time_now;
-
-    time_now = SDL_GetTicks();
-    sdl.ctx.delta_time_seconds
-            = (float)(time_now - sdl.delta_time_milliseconds_last) / 1000.0f;
-    sdl.delta_time_milliseconds_last = time_now;
-
-    projection.m[0] /= sdl.display_width;
-    projection.m[5] /= sdl.display_height;
-
-    memcpy(dev->mapped_uniforms[buffer_index], &projection, sizeof(projection));
-
-    memset(&begin_info, 0, sizeof(VkCommandBufferBeginInfo));
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-    memset(&render_pass_begin_nfo, 0, sizeof(VkRenderPassBeginInfo));
-    render_pass_begin_nfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    render_pass_begin_nfo.renderPass = dev->render_pass;
-    render_pass_begin_nfo.renderArea.extent.width
-            = (uint32_t)sdl.display_width;
-    render_pass_begin_nfo.renderArea.extent.height
-            = (uint32_t)sdl.display_height;
-    render_pass_begin_nfo.clearValueCount = 0;
-    //render_pass_begin_nfo.pClearValues = &clear_value;
-    render_pass_begin_nfo.framebuffer = dev->framebuffers[buffer_index];
-
-    command_buffer = dev->command_buffers[buffer_index];
-
-    vkResetCommandBuffer(command_buffer, 0);
-    result = vkBeginCommandBuffer(command_buffer, &begin_info);
-    NK_ASSERT(result == VK_SUCCESS);
-    vkCmdBeginRenderPass(command_buffer, &render_pass_begin_nfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
-
-    memset(&viewport, 0, sizeof(VkViewport));
-    viewport.width = (float)sdl.width;
-    viewport.height = (float)sdl.height;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      dev->pipeline);
-    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            dev->pipeline_layout, 0, 1, &dev->uniform_descriptor_sets[buffer_index], 0, NULL);
-    // convert from command queue into draw list and draw to screen
-    const struct nk_draw_command *cmd;
-    // load draw vertices & elements directly into vertex + element
-    // buffer
-    // fill convert configuration
     struct nk_convert_config config;
     static const struct nk_draw_vertex_layout_element
             vertex_layout[]
@@ -1558,6 +904,17 @@ nk_sdl_render(VkQueue graphics_queue, uint32_t buffer_index,
                         NK_OFFSETOF(struct nk_sdl_vertex,
                                     col) },
                 { NK_VERTEX_LAYOUT_END } };
+    uint64_t time_now;
+
+    time_now = SDL_GetTicks();
+    sdl.ctx.delta_time_seconds
+            = (float)(time_now - sdl.delta_time_milliseconds_last) / 1000.0f;
+    sdl.delta_time_milliseconds_last = time_now;
+
+    ortho.m[0] /= sdl.display_width;
+    ortho.m[5] /= sdl.display_height;
+    memcpy(projection, ortho.m, sizeof(ortho.m));
+
     NK_MEMSET(&config, 0, sizeof(config));
     config.vertex_layout = vertex_layout;
     config.vertex_size = sizeof(struct nk_sdl_vertex);
@@ -1571,54 +928,73 @@ nk_sdl_render(VkQueue graphics_queue, uint32_t buffer_index,
     config.shape_AA = AA;
     config.line_AA = AA;
 
-    // setup buffers to load vertices and elements
+    // convert from command queue into draw list, the host buffers grow as
+    // needed and the renderer copies them into its own per-frame buffers
+    nk_buffer_clear(&dev->cmds);
+    nk_buffer_clear(&dev->vertices);
+    nk_buffer_clear(&dev->elements);
+    nk_convert(&sdl.ctx, &dev->cmds, &dev->vertices, &dev->elements, &config);
+    nk_clear(&sdl.ctx);
+
+    *vertices = nk_buffer_memory_const(&dev->vertices);
+    *vertices_size = dev->vertices.allocated;
+    *elements = nk_buffer_memory_const(&dev->elements);
+    *elements_size = dev->elements.allocated;
+}
+
+NK_API uint32_t
+nk_sdl_render(VkCommandBuffer command_buffer, uint32_t frame,
+              VkBuffer vertex_buffer, VkDeviceSize vertex_offset,
+              VkBuffer index_buffer, VkDeviceSize index_offset,
+              VkBuffer uniform_buffer, VkDeviceSize uniform_offset,
+              VkDescriptorSet sampler_set, VkDescriptorSet texture_set,
+              void (*use_texture)(uint32_t texture_index))
+{
+    struct nk_sdl_device *dev = &sdl.vulkan;
+    const struct nk_draw_command *cmd;
+    VkDescriptorSet descriptor_sets[3];
+    uint32_t current_texture = UINT32_MAX;
+    uint32_t element_offset = 0;
+    uint32_t draws = 0;
+    VkViewport viewport;
+    VkRect2D scissor;
 
-    nk_buffer_init_fixed(&vbuf, dev->mapped_vertexs[buffer_index],
-                         (size_t)dev->max_vertex_buffer);
-    nk_buffer_init_fixed(&ebuf, dev->mapped_indexs[buffer_index],
-                         (size_t)dev->max_element_buffer);
-    nk_convert(&sdl.ctx, &dev->cmds, &vbuf, &ebuf, &config);
+    nk_sdl_update_uniform_descriptor_set(dev, frame, uniform_buffer,
+                                         uniform_offset);
 
-    // iterate over and execute each draw command
+    memset(&viewport, 0, sizeof(VkViewport));
+    viewport.width = (float)sdl.width;
+    viewport.height = (float)sdl.height;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
 
-    vkCmdBindVertexBuffers(command_buffer, 0, 1,
-                           &dev->vertex_buffers[buffer_index], &doffset);
-    vkCmdBindIndexBuffer(command_buffer, dev->index_buffers[buffer_index], 0,
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      dev->pipeline);
+    descriptor_sets[0] = dev->uniform_descriptor_sets[frame];
+    descriptor_sets[1] = sampler_set;
+    descriptor_sets[2] = texture_set;
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            dev->pipeline_layout, 0, 3, descriptor_sets, 0, NULL);
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertex_buffer,
+                           &vertex_offset);
+    vkCmdBindIndexBuffer(command_buffer, index_buffer, index_offset,
                          VK_INDEX_TYPE_UINT16);
 
+    // iterate over and execute each draw command, texture handles are
+    // texture array indices so switching textures is only a push constant
     nk_draw_foreach(cmd, &sdl.ctx, &dev->cmds)
     {
-        if (!cmd->texture.ptr) { continue; }
-        if (cmd->texture.ptr
-            && cmd->texture.ptr != current_texture) {
-            int found = 0;
-            uint32_t i;
-            for (i = 0;
-                 i < dev->texture_descriptor_sets_len; i++) {
-                if (dev->texture_descriptor_sets[i]
-                            .image_view
-                    == cmd->texture.ptr) {
-                    found = 1;
-                    break;
-                }
-            }
+        if (!cmd->elem_count) continue;
 
-            if (!found) {
-                update_texture_descriptor_set(dev,
-                                              &dev->texture_descriptor_sets[i],
-                                              (VkImageView)cmd->texture.ptr);
-                dev->texture_descriptor_sets_len++;
-            }
-            vkCmdBindDescriptorSets(command_buffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    dev->pipeline_layout, 1, 1,
-                                    &dev->texture_descriptor_sets[i]
-                                            .descriptor_set,
-                                    0, NULL);
+        if ((uint32_t)cmd->texture.id != current_texture) {
+            current_texture = (uint32_t)cmd->texture.id;
+            vkCmdPushConstants(command_buffer, dev->pipeline_layout,
+                               VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                               sizeof(uint32_t), &current_texture);
+            if (use_texture)
+                use_texture(current_texture);
         }
 
-        if (!cmd->elem_count) continue;
-
         scissor.offset.x
                 = (int32_t)(NK_MAX(cmd->clip_rect.x, 0.f));
         scissor.offset.y
@@ -1627,41 +1003,11 @@ nk_sdl_render(VkQueue graphics_queue, uint32_t buffer_index,
         scissor.extent.height = (uint32_t)(cmd->clip_rect.h);
         vkCmdSetScissor(command_buffer, 0, 1, &scissor);
         vkCmdDrawIndexed(command_buffer, cmd->elem_count, 1,
-                         index_offset, 0, 0);
-        index_offset += cmd->elem_count;
-    }
-    nk_clear(&sdl.ctx);
-
-    vkCmdEndRenderPass(command_buffer);
-    result = vkEndCommandBuffer(command_buffer);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    if (wait_semaphore) {
-        wait_semaphore_count = 1;
-        wait_semaphores = &wait_semaphore;
-    } else {
-        wait_semaphore_count = 0;
-        wait_semaphores = NULL;
+                         element_offset, 0, 0);
+        element_offset += cmd->elem_count;
+        draws++;
     }
-
-    memset(&submit_info, 0, sizeof(VkSubmitInfo));
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer;
-    submit_info.pWaitDstStageMask = &wait_stage;
-    submit_info.waitSemaphoreCount = wait_semaphore_count;
-    submit_info.pWaitSemaphores = wait_semaphores;
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = &dev->render_completed_semaphores[buffer_index];
-
-    result = vkQueueSubmit(graphics_queue, 1, &submit_info, dev->frameStartFences[buffer_index]);
-    NK_ASSERT(result == VK_SUCCESS);
-
-    nk_buffer_clear(&dev->cmds);
-    nk_buffer_clear(&vbuf);
-    nk_buffer_clear(&ebuf);
-
-    return dev->render_completed_semaphores[buffer_index];
+    return draws;
 }
 
 NK_INTERN void
@@ -1691,13 +1037,11 @@ nk_sdl_clipboard_copy(nk_handle usr, const char *text, int len)
 
 NK_API struct nk_context *
 nk_sdl_init(SDL_Window *win, VkDevice logical_device,
-            VkPhysicalDevice physical_device, uint32_t graphics_queue_family_index,
-            VkImageView *image_views, uint32_t image_views_len, VkFormat color_format,
-            enum nk_sdl_init_state init_state, VkDeviceSize max_vertex_buffer,
-            VkDeviceSize max_element_buffer)
+            VkRenderPass render_pass, VkSampleCountFlagBits samples,
+            VkFormat color_format, VkFormat depth_format,
+            uint32_t frames_in_flight, VkDescriptorSetLayout sampler_layout,
+            VkDescriptorSetLayout texture_layout)
 {
-    (void)init_state;
-
     memset(&sdl, 0, sizeof(struct nk_sdl));
     sdl.win = win;
 
@@ -1708,10 +1052,9 @@ nk_sdl_init(SDL_Window *win, VkDevice logical_device,
 
     SDL_GetWindowSize(win, &sdl.width, &sdl.height);
     SDL_GetWindowSizeInPixels(win, &sdl.display_width, &sdl.display_height);
-    nk_sdl_device_create(logical_device, physical_device,
-                         graphics_queue_family_index, image_views, image_views_len,
-                         color_format, max_vertex_buffer, max_element_buffer,
-                         (uint32_t)sdl.display_width, (uint32_t)sdl.display_height);
+    nk_sdl_device_create(logical_device, render_pass, samples, color_format,
+                         depth_format, frames_in_flight, sampler_layout,
+                         texture_layout);
 
     return &sdl.ctx;
-}
\ No newline at end of file
+}
@@ -0,0 +1,355 @@
+#define SDL_MAIN_HANDLED
+#include <SDL3/SDL_vulkan.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "VK2D/VK2D.h"
+#include "VK2D/Validation.h"
+
+/************************ Constants ************************/
+
+const int SCREEN_WIDTH  = 1280;
+const int SCREEN_HEIGHT = 720;
+const int WARMUP_FRAMES = 10;
+const int BENCH_FRAMES  = 200;
+const int MAX_SPRITES   = 65536;
+
+/************************ Results ************************/
+
+typedef struct BenchResult {
+	char name[64];      // Scenario name, used as the key when comparing runs
+	const char *unit;   // What a single unit of work is in this scenario
+	double units;       // Total units of work done
+	double ms;          // Total wall time including waiting for the GPU
+	uint32_t frames;    // Frames measured, 0 for scenarios that aren't frame based
+	VK2DFrameTimeStats cpu;
+	VK2DFrameTimeStats gpu;
+} BenchResult;
+
+static BenchResult gResults[64];
+static int gResultCount = 0;
+
+static double timeMs() {
+	return ((double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency()) * 1000;
+}
+
+/************************ Shared state ************************/
+
+static VK2DDrawCommand *gCommands;
+static VK2DTexture gSprite;
+static vec4 gClear = {0.0, 0.0, 0.0, 1.0};
+
+// A frame of work for a scenario, param is whatever the scenario was registered with
+typedef void (*BenchFrame)(int param);
+
+// Runs a frame-based scenario and records how long it took
+static void runFrames(const char *name, const char *unit, BenchFrame frame, int param, double unitsPerFrame) {
+	if (vk2dStatusFatal())
+		return;
+	for (int i = 0; i < WARMUP_FRAMES; i++) {
+		vk2dRendererStartFrame(gClear);
+		frame(param);
+		vk2dRendererEndFrame();
+	}
+	vk2dRendererWait();
+
+	const double start = timeMs();
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		vk2dRendererStartFrame(gClear);
+		frame(param);
+		vk2dRendererEndFrame();
+	}
+	vk2dRendererWait();
+	const double end = timeMs();
+
+	BenchResult *result = &gResults[gResultCount++];
+	snprintf(result->name, sizeof(result->name), name, param);
+	result->unit = unit;
+	result->units = unitsPerFrame * BENCH_FRAMES;
+	result->ms = end - start;
+	result->frames = BENCH_FRAMES;
+	vk2dRendererGetFrameTimeStats(BENCH_FRAMES, &result->cpu, &result->gpu);
+	fprintf(stderr, "%-32s %10.3f ms/frame\n", result->name, result->ms / BENCH_FRAMES);
+}
+
+// Records a scenario that isn't frame based
+static void addResult(const char *name, const char *unit, double units, double ms) {
+	BenchResult *result = &gResults[gResultCount++];
+	memset(result, 0, sizeof(BenchResult));
+	snprintf(result->name, sizeof(result->name), "%s", name);
+	result->unit = unit;
+	result->units = units;
+	result->ms = ms;
+	fprintf(stderr, "%-32s %10.3f ms\n", result->name, ms);
+}
+
+/************************ Scenarios ************************/
+
+static void frameSprites(int count) {
+	vk2dRendererAddBatch(gCommands, count);
+}
+
+static void frameDrawTexture(int count) {
+	for (int i = 0; i < count; i++)
+		vk2dDrawTexture(gSprite, gCommands[i].pos[0], gCommands[i].pos[1]);
+}
+
+// Flips the blend mode every count sprites, forcing a batch flush each time
+static void frameBlendFlips(int count) {
+	for (int i = 0; i < 8192; i += count) {
+		vk2dRendererSetBlendMode(((i / count) % 2) ? VK2D_BLEND_MODE_ADD : VK2D_BLEND_MODE_BLEND);
+		vk2dRendererAddBatch(gCommands + i, count);
+	}
+	vk2dRendererSetBlendMode(VK2D_BLEND_MODE_BLEND);
+}
+
+static void framePrimitives(int count) {
+	for (int i = 0; i < count; i++) {
+		vk2dRendererSetColourMod(gCommands[i].colour);
+		vk2dDrawRectangle(gCommands[i].pos[0], gCommands[i].pos[1], 8, 8);
+		vk2dDrawCircle(gCommands[i].pos[1], gCommands[i].pos[0], 4);
+		vk2dDrawLine(gCommands[i].pos[0], gCommands[i].pos[1], gCommands[i].pos[1], gCommands[i].pos[0]);
+	}
+	vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
+}
+
+static VK2DShadowEnvironment gShadows;
+static VK2DShadowObject gShadowObjects[1024];
+static int gShadowFrame = 0;
+
+// Moves count objects a little every frame so their models and grid cells get updated before drawing
+static void frameShadows(int count) {
+	vec4 colour = {0, 0, 0, 0.5};
+	vec2 light = {SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2};
+	const float offset = sinf(gShadowFrame++ * 0.1f) * 8;
+	for (int i = 0; i < count; i++)
+		vk2dShadowEnvironmentObjectSetPos(gShadows, gShadowObjects[i], gCommands[i].pos[0] + offset, gCommands[i].pos[1]);
+	vk2dRendererDrawShadows(gShadows, colour, light);
+}
+
+static VK2DTexture gTargets[2];
+static void framePingPong(int count) {
+	for (int i = 0; i < count; i++) {
+		vk2dRendererSetTarget(gTargets[i % 2]);
+		vk2dRendererClear();
+		vk2dDrawTexture(gTargets[(i + 1) % 2], 0, 0);
+		vk2dRendererAddBatch(gCommands, 256);
+	}
+	vk2dRendererSetTarget(VK2D_TARGET_SCREEN);
+	vk2dDrawTexture(gTargets[0], 0, 0);
+}
+
+static VK2DShader gShader;
+static void frameShader(int count) {
+	float data = 0.5;
+	for (int i = 0; i < count; i++)
+		vk2dDrawShader(gShader, &data, gSprite, gCommands[i].pos[0], gCommands[i].pos[1]);
+}
+
+static bool fileExists(const char *filename) {
+	FILE *file = fopen(filename, "rb");
+	if (file != NULL)
+		fclose(file);
+	return file != NULL;
+}
+
+/************************ Output ************************/
+
+static void writeStats(FILE *out, const char *key, VK2DFrameTimeStats *stats) {
+	fprintf(out, ",\"%s\":{\"frames\":%u,\"mean_ms\":%f,\"p50_ms\":%f,\"p95_ms\":%f,\"p99_ms\":%f,\"max_ms\":%f}",
+			key, stats->frames, stats->mean, stats->p50, stats->p95, stats->p99, stats->max);
+}
+
+// Writes str as a JSON string, escaping quotes, backslashes, and control characters
+static void writeString(FILE *out, const char *str) {
+	fputc('"', out);
+	for (const char *c = str; *c != 0; c++) {
+		if (*c == '"' || *c == '\\')
+			fprintf(out, "\\%c", *c);
+		else if (*c == '\n')
+			fprintf(out, "\\n");
+		else if ((unsigned char)*c < 0x20)
+			fprintf(out, "\\u%04x", (unsigned char)*c);
+		else
+			fputc(*c, out);
+	}
+	fputc('"', out);
+}
+
+static void writeResults(FILE *out) {
+	fprintf(out, "{\n\"host\":");
+	writeString(out, vk2dHostInformation());
+	fprintf(out, ",\n\"results\":[\n");
+	for (int i = 0; i < gResultCount; i++) {
+		BenchResult *result = &gResults[i];
+		fprintf(out, "{\"name\":\"%s\",\"unit\":\"%s\",\"units\":%f,\"total_ms\":%f,\"units_per_sec\":%f",
+				result->name, result->unit, result->units, result->ms,
+				result->ms > 0 ? result->units / (result->ms / 1000) : 0);
+		if (result->frames > 0) {
+			fprintf(out, ",\"frames\":%u,\"ms_per_frame\":%f", result->frames, result->ms / result->frames);
+			writeStats(out, "cpu", &result->cpu);
+			writeStats(out, "gpu", &result->gpu);
+		}
+		fprintf(out, "}%s\n", i + 1 < gResultCount ? "," : "");
+	}
+	fprintf(out, "]\n}\n");
+}
+
+int main(int argc, const char *argv[]) {
+	// Usage: vk2d_bench [output.json] [--window]
+	const char *outputFile = NULL;
+	bool windowed = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--window") == 0)
+			windowed = true;
+		else
+			outputFile = argv[i];
+	}
+
+	// Headless unless asked otherwise, so this runs on lavapipe/SwiftShader in CI
+	SDL_Init(windowed ? SDL_INIT_VIDEO : 0);
+	SDL_Window *window = NULL;
+	if (windowed) {
+		window = SDL_CreateWindow("VK2D Bench", SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_VULKAN);
+		if (window == NULL)
+			return -1;
+	}
+	VK2DRendererConfig config = {VK2D_MSAA_1X, VK2D_SCREEN_MODE_IMMEDIATE, VK2D_FILTER_TYPE_NEAREST};
+	VK2DStartupOptions options = {
+			.quitOnError = false,
+			.stdoutLogging = false,
+			.enableGPUProfiler = true,
+			.vramPageSize = sizeof(VK2DDrawInstance) * MAX_SPRITES * 2,
+			.headlessWidth = SCREEN_WIDTH,
+			.headlessHeight = SCREEN_HEIGHT,
+	};
+	if (vk2dRendererInit(window, config, &options) != VK2D_SUCCESS) {
+		fprintf(stderr, "Failed to start renderer: %s\n", vk2dStatusMessage());
+		return -1;
+	}
+
+	// Everything draws the same 16x16 sprite so the bench doesn't depend on the working directory
+	uint8_t *pixels = malloc(1024 * 1024 * 4);
+	memset(pixels, 255, 1024 * 1024 * 4);
+	VK2DImage spriteImage = vk2dImageFromPixels(vk2dRendererGetDevice(), pixels, 16, 16, true);
+	gSprite = vk2dTextureLoadFromImage(spriteImage);
+	gCommands = calloc(MAX_SPRITES, sizeof(VK2DDrawCommand));
+	for (int i = 0; i < MAX_SPRITES; i++) {
+		gCommands[i].pos[0] = vk2dRandom(0, SCREEN_WIDTH);
+		gCommands[i].pos[1] = vk2dRandom(0, SCREEN_HEIGHT);
+		gCommands[i].scale[0] = 1;
+		gCommands[i].scale[1] = 1;
+		gCommands[i].colour[0] = vk2dRandom(0, 1);
+		gCommands[i].colour[1] = vk2dRandom(0, 1);
+		gCommands[i].colour[2] = vk2dRandom(0, 1);
+		gCommands[i].colour[3] = 1;
+		gCommands[i].textureIndex = vk2dTextureGetID(gSprite);
+		gCommands[i].texturePos[2] = 16;
+		gCommands[i].texturePos[3] = 16;
+	}
+
+	// Sprites
+	const int batchSizes[] = {256, 4096, MAX_SPRITES};
+	for (int i = 0; i < 3; i++)
+		runFrames("sprites_batch_%i", "sprite", frameSprites, batchSizes[i], batchSizes[i]);
+	runFrames("sprites_draw_texture_%i", "sprite", frameDrawTexture, 4096, 4096);
+	const int flipIntervals[] = {1024, 64, 8};
+	for (int i = 0; i < 3; i++)
+		runFrames("sprites_blend_flip_every_%i", "sprite", frameBlendFlips, flipIntervals[i], 8192);
+	VK2DCameraIndex cameras[3];
+	for (int i = 0; i < 3; i++) {
+		VK2DCameraSpec spec = vk2dRendererGetCamera();
+		spec.wOnScreen /= 2;
+		spec.hOnScreen /= 2;
+		cameras[i] = vk2dCameraCreate(spec);
+	}
+	runFrames("sprites_4_cameras_%i", "sprite", frameSprites, 4096, 4096);
+	for (int i = 0; i < 3; i++)
+		vk2dCameraSetState(cameras[i], VK2D_CAMERA_STATE_DELETED);
+
+	// Primitives
+	runFrames("primitives_%i", "primitive", framePrimitives, 2000, 2000 * 3);
+
+	// Shadows, split into objects of 16 edges each
+	const int edgeCounts[] = {64, 1024, 16384};
+	for (int i = 0; i < 3; i++) {
+		const int objectCount = edgeCounts[i] / 16;
+		gShadows = vk2dShadowEnvironmentCreate();
+		for (int j = 0; j < objectCount; j++) {
+			gShadowObjects[j] = vk2dShadowEnvironmentAddObject(gShadows);
+			for (int k = 0; k < 16; k++) {
+				const float x = vk2dRandom(-16, 16);
+				const float y = vk2dRandom(-16, 16);
+				vk2dShadowEnvironmentAddEdge(gShadows, x, y, x + vk2dRandom(-16, 16), y + vk2dRandom(-16, 16));
+			}
+		}
+		vk2dShadowEnvironmentFlushVBO(gShadows);
+		gShadowFrame = 0;
+		runFrames("shadows_%i_objects", "edge", frameShadows, objectCount, edgeCounts[i]);
+		vk2dRendererWait();
+		vk2dShadowEnvironmentFree(gShadows);
+	}
+
+	// Render target ping-pong
+	gTargets[0] = vk2dTextureCreate(512, 512);
+	gTargets[1] = vk2dTextureCreate(512, 512);
+	runFrames("target_pingpong_%i", "target switch", framePingPong, 32, 32);
+	vk2dRendererWait();
+	vk2dTextureFree(gTargets[0]);
+	vk2dTextureFree(gTargets[1]);
+
+	// User shaders, these need the compiled example shaders
+	if (fileExists("assets/test.vert.spv") && fileExists("assets/test.frag.spv")) {
+		gShader = vk2dShaderLoad("assets/test.vert.spv", "assets/test.frag.spv", 4);
+		runFrames("shader_draws_%i", "draw", frameShader, 1000, 1000);
+		vk2dRendererWait();
+		vk2dShaderFree(gShader);
+	} else {
+		fprintf(stderr, "Skipping shader bench, assets/test.*.spv not found\n");
+	}
+
+	// Texture uploads
+	const int uploads = 32;
+	double start = timeMs();
+	for (int i = 0; i < uploads; i++)
+		vk2dImageFree(vk2dImageFromPixels(vk2dRendererGetDevice(), pixels, 1024, 1024, true));
+	addResult("texture_upload_1024x1024", "MB", (uploads * 1024.0 * 1024.0 * 4) / (1024 * 1024), timeMs() - start);
+
+	// Model loads
+	if (fileExists("assets/viking_room.obj")) {
+		const int loads = 8;
+		start = timeMs();
+		for (int i = 0; i < loads; i++)
+			vk2dModelFree(vk2dModelLoad("assets/viking_room.obj", gSprite));
+		addResult("model_load_viking_room", "model", loads, timeMs() - start);
+	} else {
+		fprintf(stderr, "Skipping model bench, assets/viking_room.obj not found\n");
+	}
+
+	// Output
+	const bool failed = vk2dStatusFatal();
+	if (failed)
+		fprintf(stderr, "Bench failed: %s\n", vk2dStatusMessage());
+	if (outputFile != NULL) {
+		FILE *out = fopen(outputFile, "w");
+		if (out != NULL) {
+			writeResults(out);
+			fclose(out);
+		}
+	} else {
+		writeResults(stdout);
+	}
+
+	vk2dRendererWait();
+	vk2dTextureFree(gSprite);
+	vk2dImageFree(spriteImage);
+	free(gCommands);
+	free(pixels);
+	vk2dRendererQuit();
+	if (window != NULL)
+		SDL_DestroyWindow(window);
+	SDL_Quit();
+	return failed ? 1 : 0;
+}
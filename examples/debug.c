@@ -35,12 +35,24 @@ void debugRenderOverlay() {
 	float inUse, total;
 	vk2dRendererGetVRAMUsage(&inUse, &total);
 	sprintf(title, "Vulkan2D [%0.2fms] [%0.2ffps] %ix MSAA\nVRAM: %0.2fMiB/%0.2fGiB", vk2dRendererGetAverageFrameTime(), 1000 / vk2dRendererGetAverageFrameTime(), conf.msaa, inUse, total / 1024);
+
+	// GPU timings are only available if the renderer was started with enableGPUProfiler
+	uint32_t timingCount;
+	const VK2DGPUTiming *timings = vk2dRendererGetGPUTimings(&timingCount);
+	char gpu[1000] = "";
+	int lines = 2;
+	for (uint32_t i = 0; i < timingCount && strlen(gpu) < sizeof(gpu) - 100; i++) {
+		sprintf(gpu + strlen(gpu), "\n%*s%s: %0.3fms", timings[i].depth * 2, "", timings[i].name, timings[i].ms);
+		lines++;
+	}
+
 	vk2dRendererSetColourMod(VK2D_BLACK);
 	int w, h;
 	SDL_GetWindowSize(gWindow, &w, &h);
-	vk2dDrawRectangle(0, 0, (float)w, 17*2*2);
+	vk2dDrawRectangle(0, 0, (float)w, 17*2*lines);
 	vk2dRendererSetColourMod(VK2D_DEFAULT_COLOUR_MOD);
 	debugRenderFont(0, 0, title);
+	debugRenderFont(0, 16*2, gpu);
 	vk2dRendererUnlockCameras();
 }
 
@@ -5,8 +5,11 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 viewproj[10];
 } ubo;
 
+layout(set = 3, binding = 3) readonly buffer ModelTransforms {
+    mat4 transforms[];
+} modelTransforms;
+
 layout(push_constant) uniform PushBuffer {
-    mat4 model;
     vec4 colourMod;
     uint textureIndex;
     int cameraIndex;
@@ -22,6 +25,6 @@ out gl_PerVertex {
 };
 
 void main() {
-    gl_Position = ubo.viewproj[pushBuffer.cameraIndex] * pushBuffer.model * vec4(inPosition, 1.0);
+    gl_Position = ubo.viewproj[pushBuffer.cameraIndex] * modelTransforms.transforms[gl_InstanceIndex] * vec4(inPosition, 1.0);
     fragTexCoord = inTexCoord;
 }
\ No newline at end of file
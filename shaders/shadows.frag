@@ -2,9 +2,9 @@
 #extension GL_ARB_separate_shader_objects : enable
 
 layout(push_constant) uniform PushBuffer {
-    mat4 model; // Model for this shadow object
     vec2 lightSource; // Where the light is
-    vec2 _alignment; // ignore
+    float radius; // How far to extrude shadows, 0 to project them to infinity
+    float _alignment; // ignore
     vec4 colour; // Colour of the shadows
     int cameraIndex;
 } pushBuffer;
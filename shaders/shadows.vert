@@ -5,15 +5,25 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 viewproj[10];
 } ubo;
 
-layout(push_constant) uniform PushBuffer {
+struct ShadowObject {
     mat4 model; // Model for this shadow object
+    uint enabled; // Whether or not this object casts shadows
+};
+
+layout(set = 1, binding = 3) readonly buffer ShadowObjects {
+    ShadowObject objects[];
+} shadowObjects;
+
+layout(push_constant) uniform PushBuffer {
     vec2 lightSource; // Where the light is
-    vec2 _alignment; // ignore
+    float radius; // How far to extrude shadows, 0 to project them to infinity
+    float _alignment; // ignore
     vec4 colour; // Colour of the shadows
     int cameraIndex;
 } pushBuffer;
 
-layout(location = 0) in vec3 inPosition;
+layout(location = 0) in vec4 inEdge; // x1, y1, x2, y2 of the edge this instance draws
+layout(location = 1) in uint inObject; // Shadow object this edge belongs to
 
 out gl_PerVertex {
     vec4 gl_Position;
@@ -21,18 +31,35 @@ out gl_PerVertex {
 
 void main() {
     int mod = gl_VertexIndex % 6;
-    vec4 position = pushBuffer.model * vec4(inPosition, 1.0);
-    if (mod == 1 || mod == 4 || mod == 5) {
+
+    // Each instance is one edge, vertices 0, 1, and 5 sit on the end of it and 2, 3, and 4 on the start
+    bool end = mod == 0 || mod == 1 || mod == 5;
+    mat4 model = shadowObjects.objects[inObject].model;
+    vec4 position = model * vec4(end ? inEdge.zw : inEdge.xy, 0.0, 1.0);
+    vec4 vertex;
+    if ((mod == 1 || mod == 4 || mod == 5) && pushBuffer.radius > 0) {
+        // Extruded just past the light's radius, the wider the edge looks from the light the further both
+        // ends have to go so the far side of the quad doesn't cut back into the radius
+        vec2 a = normalize((model * vec4(inEdge.xy, 0.0, 1.0)).xy - pushBuffer.lightSource);
+        vec2 b = normalize((model * vec4(inEdge.zw, 0.0, 1.0)).xy - pushBuffer.lightSource);
+        float cosHalfAngle = sqrt(max(0.5 + (0.5 * dot(a, b)), 0.0));
+        vertex = vec4(position.xy + (normalize(position.xy - pushBuffer.lightSource) * (pushBuffer.radius / max(cosHalfAngle, 0.01))), 0.0, 1.0);
+    } else if (mod == 1 || mod == 4 || mod == 5) {
         // One of the vertices that needs to be projected
-        vec4 vertex = vec4(
+        vertex = vec4(
             (position.x - pushBuffer.lightSource.x) * 1000,
             (position.y - pushBuffer.lightSource.y) * 1000,
             1.0,
             0.0
         );
-        gl_Position = ubo.viewproj[pushBuffer.cameraIndex] * vertex;
     } else {
         // Static vertices
-        gl_Position = ubo.viewproj[pushBuffer.cameraIndex] * position;
+        vertex = position;
     }
+
+    // Disabled objects collapse to a point so they draw nothing
+    if (shadowObjects.objects[inObject].enabled != 0)
+        gl_Position = ubo.viewproj[pushBuffer.cameraIndex] * vertex;
+    else
+        gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+/// \file batching.c
+/// \author Paolo Mazzon
+/// \brief Checks that sprites drawn back to back end up in one batch in every blend mode
+#include "test.h"
+
+static const vec4 CLEAR_COLOUR = {0, 0, 0, 1};
+
+// Checks the only flush last frame was the one at the end of the frame, after count sprites
+static int checkSingleFlush(uint32_t count) {
+	VK2DFrameStats stats = vk2dRendererGetFrameStats();
+	TEST_CHECK(stats.spritesSubmitted == count);
+	TEST_CHECK(stats.spriteFlushes[VK2D_FLUSH_REASON_END_FRAME] == 1);
+	for (int i = 0; i < VK2D_FLUSH_REASON_MAX; i++)
+		if (i != VK2D_FLUSH_REASON_END_FRAME)
+			TEST_CHECK(stats.spriteFlushes[i] == 0);
+	return 0;
+}
+
+int main(int argc, const char *argv[]) {
+	VK2DStartupOptions options = {0};
+	if (!testRendererInit(options))
+		return 1;
+	VK2DTexture tex = vk2dTextureCreate(16, 16);
+	TEST_CHECK(tex != NULL);
+
+	for (int blend = 0; blend < VK2D_BLEND_MODE_MAX; blend++) {
+		vk2dRendererStartFrame(CLEAR_COLOUR);
+		vk2dRendererSetBlendMode((VK2DBlendMode)blend);
+		for (int i = 0; i < 32; i++)
+			vk2dRendererDrawTexture(tex, i, i, 1, 1, 0, 0, 0, 0, 0, 16, 16);
+		vk2dRendererSetBlendMode(VK2D_BLEND_MODE_BLEND);
+		TEST_CHECK(vk2dRendererEndFrame() == VK2D_SUCCESS);
+		if (blend == VK2D_BLEND_MODE_BLEND) {
+			if (checkSingleFlush(32) != 0)
+				return 1;
+		} else {
+			// Switching back to the default blend mode flushes the batch before the frame ends
+			VK2DFrameStats stats = vk2dRendererGetFrameStats();
+			TEST_CHECK(stats.spritesSubmitted == 32);
+			TEST_CHECK(stats.spriteFlushes[VK2D_FLUSH_REASON_BLEND_CHANGE] == 1);
+			TEST_CHECK(stats.spriteFlushes[VK2D_FLUSH_REASON_PIPELINE_CHANGE] == 0);
+		}
+	}
+
+	// A full batch is flushed as an overflow
+	const uint32_t overflow = (uint32_t)vk2dRendererGetLimits().maxInstancedDraws + 1;
+	vk2dRendererStartFrame(CLEAR_COLOUR);
+	for (uint32_t i = 0; i < overflow; i++)
+		vk2dRendererDrawTexture(tex, 0, 0, 1, 1, 0, 0, 0, 0, 0, 16, 16);
+	TEST_CHECK(vk2dRendererEndFrame() == VK2D_SUCCESS);
+	VK2DFrameStats stats = vk2dRendererGetFrameStats();
+	TEST_CHECK(stats.spritesSubmitted == overflow);
+	TEST_CHECK(stats.spriteFlushes[VK2D_FLUSH_REASON_OVERFLOW] == 1);
+	TEST_CHECK(stats.spriteFlushes[VK2D_FLUSH_REASON_PIPELINE_CHANGE] == 0);
+	TEST_CHECK(!vk2dStatusFatal());
+
+	vk2dRendererWait();
+	vk2dTextureFree(tex);
+	testRendererQuit();
+	return 0;
+}
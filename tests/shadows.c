@@ -0,0 +1,102 @@
+/// \file shadows.c
+/// \author Paolo Mazzon
+/// \brief Checks the shadow environment's grid finds the right objects as they move, and that lights only keep nearby edges
+#include "test.h"
+#include "VK2D/Opaque.h"
+#include "VK2D/RendererMeta.h"
+
+static const vec4 CLEAR_COLOUR = {0, 0, 0, 1};
+
+// Adds an object whose edges are the outline of a w by h box at its origin
+static VK2DShadowObject addBox(VK2DShadowEnvironment se, float w, float h) {
+	VK2DShadowObject object = vk2dShadowEnvironmentAddObject(se);
+	vk2dShadowEnvironmentAddEdge(se, 0, 0, w, 0);
+	vk2dShadowEnvironmentAddEdge(se, w, 0, w, h);
+	vk2dShadowEnvironmentAddEdge(se, w, h, 0, h);
+	vk2dShadowEnvironmentAddEdge(se, 0, h, 0, 0);
+	return object;
+}
+
+// Number of times an object is in the last query's results
+static int found(VK2DShadowEnvironment se, int count, VK2DShadowObject object) {
+	int times = 0;
+	for (int i = 0; i < count; i++)
+		if (se->queryResults[i] == object)
+			times++;
+	return times;
+}
+
+int main(int argc, const char *argv[]) {
+	VK2DStartupOptions options = {0};
+	if (!testRendererInit(options))
+		return 1;
+	VK2DShadowEnvironment se = vk2dShadowEnvironmentCreate();
+	TEST_CHECK(se != NULL);
+
+	// Small boxes far apart, one box across a few cells, and one box across more cells than an object may be in
+	VK2DShadowObject boxes[8];
+	for (int i = 0; i < 8; i++) {
+		boxes[i] = addBox(se, 10, 10);
+		vk2dShadowEnvironmentObjectSetPos(se, boxes[i], i * 1000, 0);
+	}
+	TEST_CHECK(boxes[0] == 0);
+	VK2DShadowObject wide = addBox(se, 600, 10);
+	vk2dShadowEnvironmentObjectSetPos(se, wide, 100, 2000);
+	VK2DShadowObject large = addBox(se, 5000, 5000);
+	vk2dShadowEnvironmentObjectSetPos(se, large, -20000, -20000);
+	vk2dShadowEnvironmentFlushVBO(se);
+	TEST_CHECK(!se->objectInfos[wide].large && se->objectInfos[wide].cells[2] > se->objectInfos[wide].cells[0]);
+	TEST_CHECK(se->objectInfos[large].large && se->gridLarge.count == 1);
+
+	// Queries only return objects whose bounds overlap the area
+	int count = _vk2dShadowEnvironmentQuery(se, 2990, -10, 3020, 20);
+	TEST_CHECK(count == 1 && se->queryResults[0] == boxes[3]);
+	TEST_CHECK(_vk2dShadowEnvironmentQuery(se, 20, 20, 900, 900) == 0);
+	count = _vk2dShadowEnvironmentQuery(se, -18000, -18000, -17990, -17990);
+	TEST_CHECK(count == 1 && se->queryResults[0] == large);
+
+	// Objects in several cells are only returned once, whether the query walks the cells or every bucket
+	count = _vk2dShadowEnvironmentQuery(se, 0, 1990, 1000, 2020);
+	TEST_CHECK(count == 1 && se->queryResults[0] == wide);
+	count = _vk2dShadowEnvironmentQuery(se, -1000000, -1000000, 1000000, 1000000);
+	TEST_CHECK(count == 10);
+	for (int i = 0; i < 8; i++)
+		TEST_CHECK(found(se, count, boxes[i]) == 1);
+	TEST_CHECK(found(se, count, wide) == 1 && found(se, count, large) == 1);
+
+	// Moving an object moves it in the grid, disabled objects are skipped
+	vk2dShadowEnvironmentObjectSetPos(se, boxes[3], 500, 500);
+	TEST_CHECK(_vk2dShadowEnvironmentQuery(se, 2990, -10, 3020, 20) == 0);
+	count = _vk2dShadowEnvironmentQuery(se, 20, 20, 900, 900);
+	TEST_CHECK(count == 1 && se->queryResults[0] == boxes[3]);
+	vk2dShadowEnvironmentObjectSetStatus(se, boxes[3], false);
+	TEST_CHECK(_vk2dShadowEnvironmentQuery(se, 20, 20, 900, 900) == 0);
+	vk2dShadowEnvironmentObjectSetStatus(se, boxes[3], true);
+
+	// When the query ID wraps around objects found by an old query with the same ID are still found
+	se->queryId = UINT32_MAX;
+	se->objectInfos[boxes[3]].queryId = 1;
+	count = _vk2dShadowEnvironmentQuery(se, 20, 20, 900, 900);
+	TEST_CHECK(count == 1 && se->queryResults[0] == boxes[3] && se->queryId == 1);
+
+	// Lights only keep the edges within their radius, of the objects the grid puts near them
+	vk2dRendererStartFrame(CLEAR_COLOUR);
+	_vk2dShadowEnvironmentBake(se);
+	TEST_CHECK(se->bakedEdgeCount == 40);
+	count = _vk2dShadowEnvironmentCullLight(se, 505, 505, 100);
+	TEST_CHECK(count == 4);
+	for (int i = 0; i < count; i++)
+		TEST_CHECK(se->lightObjects[i] == (uint32_t)boxes[3]);
+	TEST_CHECK(_vk2dShadowEnvironmentCullLight(se, 505, 515, 6) == 1);
+	TEST_CHECK(_vk2dShadowEnvironmentCullLight(se, 7000, 7000, 100) == 0);
+	vec4 colour = {0, 0, 0, 0.5};
+	vec2 light = {505, 505};
+	vk2dRendererDrawShadows(se, colour, light);
+	TEST_CHECK(vk2dRendererEndFrame() == VK2D_SUCCESS);
+	TEST_CHECK(!vk2dStatusFatal());
+
+	vk2dRendererWait();
+	vk2dShadowEnvironmentFree(se);
+	testRendererQuit();
+	return 0;
+}
@@ -0,0 +1,48 @@
+/// \file smoke.c
+/// \author Paolo Mazzon
+/// \brief Renders a few frames that switch between the screen and a texture target
+///
+/// Usage: vk2d_test_smoke [--dynamic-rendering] [--frame-graph]
+#include "test.h"
+
+int main(int argc, const char *argv[]) {
+	VK2DStartupOptions options = {
+			.enableDynamicRendering = testHasArg(argc, argv, "--dynamic-rendering"),
+			.enableFrameGraph = testHasArg(argc, argv, "--frame-graph"),
+	};
+	if (!testRendererInit(options))
+		return 1;
+	// The null backend supports dynamic rendering, which the limits report whether it's enabled or not
+	TEST_CHECK(vk2dRendererGetLimits().supportsDynamicRendering);
+
+	VK2DTexture target = vk2dTextureCreate(64, 64);
+	TEST_CHECK(target != NULL);
+	vk2dRendererResetVulkanCallCounts();
+	const vec4 clearColour = {0, 0, 0, 1};
+	for (int i = 0; i < 4; i++) {
+		vk2dRendererStartFrame(clearColour);
+		vk2dDrawRectangle(0, 0, 32, 32);
+		vk2dRendererSetTarget(target);
+		vk2dRendererClear();
+		vk2dDrawRectangle(8, 8, 16, 16);
+		vk2dRendererSetTarget(VK2D_TARGET_SCREEN);
+		vk2dRendererDrawTexture(target, 64, 64, 1, 1, 0, 0, 0, 0, 0, 64, 64);
+		vk2dRendererEmpty();
+		TEST_CHECK(vk2dRendererEndFrame() == VK2D_SUCCESS);
+		TEST_CHECK(!vk2dStatusFatal());
+	}
+
+	// Either path has to be used for every pass, never a mix of both
+	if (options.enableDynamicRendering) {
+		TEST_CHECK(vk2dRendererGetVulkanCallCount("vkCmdBeginRenderingKHR") > 0);
+		TEST_CHECK(vk2dRendererGetVulkanCallCount("vkCmdBeginRenderPass") == 0);
+	} else {
+		TEST_CHECK(vk2dRendererGetVulkanCallCount("vkCmdBeginRenderPass") > 0);
+		TEST_CHECK(vk2dRendererGetVulkanCallCount("vkCmdBeginRenderingKHR") == 0);
+	}
+
+	vk2dRendererWait();
+	vk2dTextureFree(target);
+	testRendererQuit();
+	return 0;
+}
@@ -0,0 +1,40 @@
+/// \file test.h
+/// \author Paolo Mazzon
+/// \brief Helpers shared by the tests, which all run on the null backend
+#pragma once
+#define SDL_MAIN_HANDLED
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "VK2D/VK2D.h"
+#include "VK2D/Validation.h"
+
+// Fails the current test with the file, line, and condition if cond is false
+#define TEST_CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%i: check failed: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+// Starts a headless renderer with the given options, quitOnError and stdoutLogging are always off
+static inline bool testRendererInit(VK2DStartupOptions options) {
+	SDL_Init(0);
+	options.quitOnError = false;
+	options.stdoutLogging = false;
+	VK2DRendererConfig config = {VK2D_MSAA_1X, VK2D_SCREEN_MODE_IMMEDIATE, VK2D_FILTER_TYPE_NEAREST};
+	if (vk2dRendererInit(NULL, config, &options) != VK2D_SUCCESS) {
+		fprintf(stderr, "Failed to start renderer: %s\n", vk2dStatusMessage());
+		return false;
+	}
+	return true;
+}
+
+static inline void testRendererQuit() {
+	vk2dRendererQuit();
+	SDL_Quit();
+}
+
+// Whether an argument was passed to the test
+static inline bool testHasArg(int argc, const char *argv[], const char *arg) {
+	for (int i = 1; i < argc; i++)
+		if (strcmp(argv[i], arg) == 0)
+			return true;
+	return false;
+}
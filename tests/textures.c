@@ -0,0 +1,94 @@
+/// \file textures.c
+/// \author Paolo Mazzon
+/// \brief Checks the bookkeeping of evicting textures from VRAM and reloading them once they're drawn again
+#include "test.h"
+#include "VK2D/Opaque.h"
+
+// 2x2 binary PPM so stb_image has something to decode
+static const uint8_t TEST_IMAGE[] = {
+		'P', '6', '\n', '2', ' ', '2', '\n', '2', '5', '5', '\n',
+		255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255
+};
+
+static const vec4 CLEAR_COLOUR = {0, 0, 0, 1};
+
+static void drawFrame(VK2DTexture tex) {
+	vk2dRendererStartFrame(CLEAR_COLOUR);
+	if (tex != NULL)
+		vk2dRendererDrawTexture(tex, 0, 0, 1, 1, 0, 0, 0, 0, 0, 2, 2);
+	vk2dRendererEndFrame();
+}
+
+// Runs frames without drawing tex until it's evicted, returns false if it never is
+static bool evict(VK2DTexture tex) {
+	VK2DRenderer renderer = vk2dRendererGetPointer();
+	for (int i = 0; i < 16; i++) {
+		if (renderer->textureArray[vk2dTextureGetID(tex)].evicted)
+			return true;
+		drawFrame(NULL);
+	}
+	return false;
+}
+
+int main(int argc, const char *argv[]) {
+	// Any VRAM use at all is over this threshold so every texture that isn't being drawn gets evicted
+	VK2DStartupOptions options = {.vramEvictionThreshold = 0.0000001f};
+	if (!testRendererInit(options))
+		return 1;
+	VK2DRenderer renderer = vk2dRendererGetPointer();
+	VK2DTexture tex = vk2dTextureFrom(TEST_IMAGE, sizeof(TEST_IMAGE));
+	VK2DTexture target = vk2dTextureCreate(16, 16);
+	TEST_CHECK(tex != NULL && target != NULL);
+	VK2DTextureDescriptorInfo *info = &renderer->textureArray[vk2dTextureGetID(tex)];
+
+	// Only textures with a source to reload from are evicted, and only once no frame in flight drew them
+	drawFrame(tex);
+	TEST_CHECK(!info->evicted);
+	TEST_CHECK(evict(tex));
+	TEST_CHECK(!renderer->textureArray[vk2dTextureGetID(target)].evicted);
+	TEST_CHECK(tex->img->img == VK_NULL_HANDLE && tex->img->width == 2 && tex->img->height == 2);
+	TEST_CHECK(!info->reloadQueued && renderer->texturesPendingReload == 0);
+
+	// Drawing it queues one reload however many times it is drawn
+	vk2dRendererStartFrame(CLEAR_COLOUR);
+	for (int i = 0; i < 3; i++)
+		vk2dRendererDrawTexture(tex, 0, 0, 1, 1, 0, 0, 0, 0, 0, 2, 2);
+	TEST_CHECK(info->reloadQueued && info->reload == NULL && renderer->texturesPendingReload == 1);
+	vk2dRendererEndFrame();
+
+	// It keeps being drawn as transparent until the reload is swapped in at the start of a later frame
+	bool restored = false;
+	for (int i = 0; i < 1000 && !restored; i++) {
+		vk2dRendererStartFrame(CLEAR_COLOUR);
+		restored = !info->evicted;
+		if (!restored)
+			TEST_CHECK(info->reload != NULL && renderer->textureReloadCount == 1);
+		vk2dRendererDrawTexture(tex, 0, 0, 1, 1, 0, 0, 0, 0, 0, 2, 2);
+		vk2dRendererEndFrame();
+		SDL_Delay(1);
+	}
+	TEST_CHECK(restored);
+	TEST_CHECK(tex->img->img != VK_NULL_HANDLE && tex->img->view != VK_NULL_HANDLE);
+	TEST_CHECK(!info->reloadQueued && info->reload == NULL);
+	TEST_CHECK(renderer->texturesPendingReload == 0 && renderer->textureReloadCount == 0);
+
+	// Freeing a texture while it's being reloaded drops the reload once it finishes
+	TEST_CHECK(evict(tex));
+	drawFrame(tex);
+	vk2dRendererStartFrame(CLEAR_COLOUR);
+	TEST_CHECK(info->reload != NULL || !info->evicted);
+	vk2dTextureFree(tex);
+	TEST_CHECK(renderer->texturesPendingReload == 0);
+	vk2dRendererEndFrame();
+	for (int i = 0; i < 1000 && renderer->textureReloadCount > 0; i++) {
+		drawFrame(NULL);
+		SDL_Delay(1);
+	}
+	TEST_CHECK(renderer->textureReloadCount == 0);
+	TEST_CHECK(!vk2dStatusFatal());
+
+	vk2dRendererWait();
+	vk2dTextureFree(target);
+	testRendererQuit();
+	return 0;
+}